@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "rendering/shader/shader.h"
+#include "rendering/shader/shader_variants.h"
+#include "rendering/uniform_blocks/uniform_blocks.h"
+
+/// @brief micro-benchmarks for measuring the cost of engine hot paths - results are logged
+namespace Benchmark
+{
+    /// @brief compare the cost of setting a uniform by querying its location every call (the old path), by name through the cached location table, and through a UniformHandle
+    /// @param shader the shader to set the uniform on (must be linked)
+    /// @param uniform_name the name of a float uniform in the shader
+    /// @param iterations the number of times to set the uniform for each method
+    void runUniformBenchmark(Shader &shader, const std::string &uniform_name, unsigned int iterations);
+
+    /// @brief compare the cost of frustum culling randomly placed boxes one at a time and 4 at a time with SIMD
+    /// @param object_count the number of boxes to cull
+    /// @param iterations the number of times to cull every box for each method
+    void runFrustumCullingBenchmark(unsigned int object_count, unsigned int iterations);
+
+    /// @brief measure the cost of building and refitting a BVH and the throughput of its frustum, ray and overlap queries
+    /// @param object_counts the numbers of objects to measure with (i.e. 10k to 1M)
+    void runBVHBenchmark(const std::vector<unsigned int> &object_counts);
+
+    /// @brief measure the cost of rasterising occluders into the occlusion buffer and testing objects against it, and how many it hides
+    /// @param occluder_count the number of wall occluders
+    /// @param object_count the number of boxes scattered between and behind them
+    /// @param iterations the number of frames to average over
+    void runOcclusionCullingBenchmark(unsigned int occluder_count, unsigned int object_count, unsigned int iterations);
+
+    /// @brief compare the CPU time to submit many small draws one glDrawElements at a time (RenderQueue::execute) and with multi draw indirect
+    /// @param shader_variants the variants of the shader RenderQueue::execute draws with (i.e. test_phong.vert)
+    /// @param indirect_shader_variants the same shader reading the per draw data of the indirect renderer (i.e. indirect_phong.vert)
+    /// @param per_object_block the uniform block RenderQueue::execute uploads each model matrix to
+    /// @param draw_counts the numbers of draws to measure with (i.e. 1k to 100k)
+    /// @param iterations the number of frames to average over
+    void runIndirectDrawBenchmark(ShaderVariants &shader_variants, ShaderVariants &indirect_shader_variants, UniformBlock<PerObjectBlock> &per_object_block,
+                                  const std::vector<unsigned int> &draw_counts, unsigned int iterations);
+
+    /// @brief measure the cost of binning point lights into clusters, and how many lights each pixel loops over compared to how many reach it
+    /// @param light_counts the numbers of lights to measure with (i.e. 256 to 16k)
+    /// @param iterations the number of builds to average over
+    void runClusteredLightingBenchmark(const std::vector<unsigned int> &light_counts, unsigned int iterations);
+}
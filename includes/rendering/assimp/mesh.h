@@ -2,12 +2,18 @@
 #include "glm/glm.hpp"
 #include <string>
 #include <vector>
+#include <cstdint>
 #include "rendering/shader/shader.h"
+#include "rendering/shader/shader_variants.h"
 #include "rendering/VAO/vao.h"
 #include "rendering/buffer/vbo/vbo.h"
 #include "rendering/buffer/ebo/ebo.h"
 #include "rendering/texture/texture.h"
 #include "rendering/texture/texture_manager.h"
+#include "rendering/culling/occlusion_culler.h"
+
+/// @brief the closest distance used when estimating texture detail (avoids requesting infinite detail when the camera is inside a mesh)
+const float MIN_TEXTURE_DETAIL_DISTANCE = 0.1f;
 
 class Mesh
 {
@@ -43,10 +49,79 @@ public:
     /// @param shader the shader to render this mesh with
     void draw(Shader &shader);
 
+    /// @brief set the material uniforms of this mesh (sampler units and shininess) in a shader - the shader must be in use
+    /// @param shader the shader this mesh is drawn with
+    void setMaterialUniforms(Shader &shader);
+
+    /// @brief bind this mesh's textures to their texture units
+    void bindTextures();
+
+    /// @brief issue the draw call for this mesh - the shader, VAO, material and textures must already be bound
+    void drawElements() const;
+
+    /// @brief get the VAO holding this mesh's vertex data
+    /// @return the VAO
+    const VAO &getVAO() const;
+
+    /// @brief get the vertices of this mesh
+    /// @return the vertices
+    const std::vector<Vertex> &getVertices() const;
+
+    /// @brief get the indices of this mesh (3 per triangle)
+    /// @return the indices
+    const std::vector<unsigned int> &getIndices() const;
+
+    /// @brief get the textures of this mesh's material
+    /// @return the textures
+    const std::vector<TextureInfo> &getTextures() const;
+
+    /// @brief get a key identifying this mesh's material (equal for meshes with the same textures and shininess)
+    /// @return the material key
+    uint64_t getMaterialKey() const;
+
+    /// @brief get the minimum corner of this mesh's bounding box in model space
+    /// @return the minimum corner
+    glm::vec3 getBoundsMin() const;
+
+    /// @brief get the maximum corner of this mesh's bounding box in model space
+    /// @return the maximum corner
+    glm::vec3 getBoundsMax() const;
+
+    /// @brief make an occluder from this mesh's triangles (for meshes that are solid enough to hide what is behind them)
+    /// @return the occluder, in model space
+    OccluderMesh createOccluder() const;
+
+    /// @brief draw this mesh with the cheapest variant of a shader for its material
+    /// @param shader_variants the variants of the shader to render this mesh with
+    void draw(ShaderVariants &shader_variants);
+
+    /// @brief get the shader features this mesh's material needs (i.e. a specular map)
+    /// @return the shader permutation of this mesh
+    const ShaderPermutation &getShaderPermutation() const;
+
+    /// @brief estimate the mip level of each streamed texture needed to draw this mesh and request it from the texture
+    /// @param model the model matrix this mesh will be drawn with
+    /// @param camera_position the position of the camera in world space
+    /// @param projection_scale the number of pixels covered by 1 world unit at a distance of 1 (projection[1][1] * viewport height / 2)
+    void requestTextureDetail(const glm::mat4 &model, const glm::vec3 &camera_position, float projection_scale);
+
 private:
     /// @brief create VAO, VBO, and EBO for this mesh in OpenGL
     void setupMesh();
 
+    /// @brief calculate the bounds of this mesh and how densely its texture coordinates are spread over its surface
+    void calculateBounds();
+
+    /// @brief look up and store the handles of the uniforms this mesh sets in a shader
+    /// @param shader the shader this mesh is drawn with
+    void cacheUniformHandles(const Shader &shader);
+
+    /// @brief work out the shader features needed by this mesh's textures
+    void calculateShaderPermutation();
+
+    /// @brief work out the key identifying this mesh's material
+    void calculateMaterialKey();
+
     /// @brief the vertices associated with this mesh
     std::vector<Vertex> vertices;
 
@@ -61,4 +136,28 @@ private:
 
     /// @brief this mesh's VAO (containing the VBO and EBO)
     VAO vao;
+
+    /// @brief the minimum corner of this mesh's bounding box in model space
+    glm::vec3 boundsMin;
+
+    /// @brief the maximum corner of this mesh's bounding box in model space
+    glm::vec3 boundsMax;
+
+    /// @brief the average number of texture coordinate units per model space unit across this mesh's surface
+    float uvDensity;
+
+    /// @brief the sampler uniform handle for each texture in textures (i.e. material.texture_diffuse0)
+    std::vector<UniformHandle> textureUniformHandles;
+
+    /// @brief the handle of the material shininess uniform
+    UniformHandle shininessHandle;
+
+    /// @brief the revision of the shader the uniform handles were fetched from (0 if none have been fetched)
+    unsigned int handlesShaderRevision;
+
+    /// @brief the shader features this mesh's material needs
+    ShaderPermutation shaderPermutation;
+
+    /// @brief the key identifying this mesh's material
+    uint64_t materialKey;
 };
\ No newline at end of file
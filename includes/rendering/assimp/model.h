@@ -7,6 +7,15 @@
 #include <assimp/postprocess.h>
 #include "rendering/texture/texture.h"
 #include "rendering/texture/texture_manager.h"
+#include "rendering/culling/frustum.h"
+#include "rendering/culling/occlusion_culler.h"
+#include "rendering/culling/bvh.h"
+#include "utils/thread_pool/thread_pool.h"
+
+class RenderQueue;
+
+/// @brief the number of meshes of a model rasterised as occluders by default - the meshes with the largest bounds, which hide the most
+const size_t MODEL_OCCLUDER_COUNT = 16;
 
 class Model
 {
@@ -40,6 +49,51 @@ public:
     /// @param shader
     void draw(Shader &shader);
 
+    /// @brief draw every mesh with the cheapest variant of a shader for its material
+    /// @param shader_variants the variants of the shader to render this model with
+    void draw(ShaderVariants &shader_variants);
+
+    /// @brief add every mesh inside the camera's frustum to a render queue, drawn with the cheapest variant of a shader for its material
+    /// @param render_queue the queue to add the meshes to
+    /// @param shader_variants the variants of the shader to render this model with
+    /// @param model the model matrix this model will be drawn with
+    /// @param view the camera's view matrix (used to sort the meshes by depth)
+    /// @param frustum the camera's frustum in world space (meshes outside it are skipped)
+    /// @param occlusion_culler the occlusion culler to test meshes inside the frustum against, once it has rasterised this frame's occluders (or nullptr)
+    /// @return the number of meshes tested, submitted and hidden by occluders
+    CullingStats submit(RenderQueue &render_queue, ShaderVariants &shader_variants, const glm::mat4 &model, const glm::mat4 &view, const Frustum &frustum,
+                        const OcclusionCuller *occlusion_culler = nullptr);
+
+    /// @brief as submit(), but the meshes are split into batches that are culled and encoded across a thread pool, each batch into its own
+    /// command buffer of the render queue, which are merged into the queue in order once every batch is done
+    /// @param thread_pool the pool the batches run on (the calling thread runs batches too)
+    /// @param render_queue the queue to add the meshes to
+    /// @param shader_variants the variants of the shader to render this model with
+    /// @param model the model matrix this model will be drawn with
+    /// @param view the camera's view matrix (used to sort the meshes by depth)
+    /// @param frustum the camera's frustum in world space (meshes outside it are skipped)
+    /// @param occlusion_culler the occlusion culler to test meshes inside the frustum against, once it has rasterised this frame's occluders (or nullptr)
+    /// @return the number of meshes tested, submitted and hidden by occluders
+    CullingStats submitParallel(ThreadPool &thread_pool, RenderQueue &render_queue, ShaderVariants &shader_variants, const glm::mat4 &model,
+                                const glm::mat4 &view, const Frustum &frustum, const OcclusionCuller *occlusion_culler = nullptr);
+
+    /// @brief add the meshes of this model with the largest bounds to an occlusion culler as occluders for this frame
+    /// @param occlusion_culler the occlusion culler
+    /// @param model the model matrix this model will be drawn with
+    /// @param max_occluders the most meshes to add
+    void addOccluders(OcclusionCuller &occlusion_culler, const glm::mat4 &model, size_t max_occluders = MODEL_OCCLUDER_COUNT);
+
+    /// @brief get the distinct shader permutations needed to draw this model (i.e. to precompile them)
+    /// @return the shader permutations
+    std::vector<ShaderPermutation> getShaderPermutations() const;
+
+    /// @brief request the mip levels each mesh needs from its streamed textures for this frame
+    /// @param model the model matrix this model will be drawn with
+    /// @param camera_position the position of the camera in world space
+    /// @param projection the camera's projection matrix
+    /// @param viewport_height the height of the viewport in pixels
+    void requestTextureDetail(const glm::mat4 &model, const glm::vec3 &camera_position, const glm::mat4 &projection, float viewport_height);
+
 private:
     /// @brief
     /// @param path
@@ -69,4 +123,33 @@ private:
 
     /// @brief
     std::string directory;
+
+    /// @brief find the meshes inside a frustum with meshTree (building it the first time)
+    /// @param model the model matrix this model will be drawn with
+    /// @param frustum the camera's frustum in world space
+    /// @return the number of meshes found (their indices are in visibleMeshes, in mesh order)
+    size_t findVisibleMeshes(const glm::mat4 &model, const Frustum &frustum);
+
+    /// @brief a tree over the model space bounds of the meshes - meshes never move within their model, so it is built once and queried
+    /// with the frustum in model space, instead of testing every mesh each submit
+    BVH meshTree;
+
+    /// @brief the indices of the meshes inside the frustum (reused each submit to avoid allocating)
+    std::vector<uint32_t> visibleMeshes;
+
+    /// @brief the shader variant of each mesh for the shader variants last submitted with in parallel - looked up on the calling thread, since
+    /// getting a variant may build it
+    std::vector<Shader *> meshShaders;
+
+    /// @brief the shader variants meshShaders was looked up from
+    ShaderVariants *meshShadersSource = nullptr;
+
+    /// @brief the culling stats of each batch of a parallel submit (reused to avoid allocating)
+    std::vector<CullingStats> batchStats;
+
+    /// @brief the indices of the meshes, largest bounds (by surface area) first
+    std::vector<size_t> occluderOrder;
+
+    /// @brief the occluders of the meshes in occluderOrder (each made the first time it is added to an occlusion culler)
+    std::vector<OccluderMesh> meshOccluders;
 };
\ No newline at end of file
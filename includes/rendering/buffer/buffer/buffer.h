@@ -32,6 +32,14 @@ public:
 
     void assignData(const Vertex *data, GLsizeiptr dataSize, GLenum usage);
 
+    void assignData(const void *data, GLsizeiptr dataSize, GLenum usage);
+
+    /// @brief update part of the buffer's existing data store (without reallocating it)
+    /// @param data the new data
+    /// @param offset the offset into the buffer in bytes
+    /// @param dataSize the size of the new data in bytes
+    void assignSubData(const void *data, GLintptr offset, GLsizeiptr dataSize);
+
     /// @brief binds this buffer to OpenGL
     void bind() const;
 
@@ -40,13 +48,17 @@ public:
 
     /// @brief get the id of this buffer
     /// @return the id
-    unsigned int getID();
+    unsigned int getID() const;
 
 private:
     /// @brief take over data of old buffer
     /// @param old the buffer to take control of data from (i.e. the buffer pointed to)
     void assumeData(Buffer &&old);
 
+    /// @brief get the target this buffer is bound to while its data is uploaded
+    /// @return the target
+    GLenum getUploadTarget() const;
+
     /// @brief the id of this buffer in OpenGL
     unsigned int ID;
 
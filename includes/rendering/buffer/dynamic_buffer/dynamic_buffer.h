@@ -0,0 +1,133 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+#include "rendering/buffer/buffer/buffer.h"
+
+/// @brief the number of frames a dynamic buffer holds data for - the CPU writes one while the GPU may still be reading the others
+const unsigned int DYNAMIC_BUFFER_FRAME_COUNT = 3;
+
+/// @brief the alignment of each frame's region of a dynamic buffer (at least any offset alignment OpenGL asks for)
+const GLsizeiptr DYNAMIC_BUFFER_FRAME_ALIGNMENT = 256;
+
+/// @brief a sub-range of a dynamic buffer handed out for this frame
+struct DynamicAllocation
+{
+    /// @brief where to write the data (nullptr if the allocation failed)
+    void *data;
+    /// @brief the offset of the range in the buffer in bytes (i.e. for glBindBufferRange or as a vertex offset)
+    GLintptr offset;
+    /// @brief the size of the range in bytes
+    GLsizeiptr size;
+};
+
+/// @brief how often a dynamic buffer has had to wait for the GPU
+struct DynamicBufferStats
+{
+    /// @brief the number of frames that waited for the GPU to finish with their region
+    unsigned int fenceWaits;
+    /// @brief the total time spent waiting
+    float waitMilliseconds;
+    /// @brief the number of allocations that did not fit in their frame's region
+    unsigned int failedAllocations;
+};
+
+/// @brief a buffer for data rewritten every frame (i.e. per object uniforms or instance transforms). The buffer is split into one region per
+/// frame in flight and mapped once for its whole life (glBufferStorage with persistent, coherent mapping), so writing is a plain memcpy with no
+/// OpenGL calls. A fence is placed after each frame's draws, and a region is only reused once the GPU has passed its fence. Each frame, sub-ranges
+/// are handed out from the region in order, aligned as requested. Without buffer storage (before OpenGL 4.4), writes go to a CPU copy and are
+/// uploaded with glBufferSubData by flush()
+class DynamicBuffer
+{
+public:
+    /// @brief constructor - allocates and maps the buffer
+    /// @param target the target the buffer is used with (i.e. GL_UNIFORM_BUFFER)
+    /// @param frame_size the most bytes allocated in one frame
+    /// @param frame_count the number of frames in the ring
+    DynamicBuffer(GLenum target, GLsizeiptr frame_size, unsigned int frame_count = DYNAMIC_BUFFER_FRAME_COUNT);
+
+    /// @brief destructor - deletes the fences (the buffer is unmapped when it is deleted)
+    ~DynamicBuffer();
+
+    // delete copy constructor
+    DynamicBuffer(DynamicBuffer const &) = delete;
+    // delete copy assignment
+    void operator=(DynamicBuffer const &) = delete;
+
+    /// @brief check if persistent mapping is supported (OpenGL 4.4 or ARB_buffer_storage) - otherwise the glBufferSubData fallback is used
+    /// @return true if supported
+    static bool isSupported();
+
+    /// @brief start a new frame - waits until the GPU has finished with the region being reused, then hands out sub-ranges from its start
+    void beginFrame();
+
+    /// @brief hand out a sub-range of this frame's region
+    /// @param size the size of the range in bytes
+    /// @param alignment the alignment of the range's offset in the buffer (i.e. GLCapabilities::getUniformBufferOffsetAlignment())
+    /// @return the range (data is nullptr if the region is full)
+    DynamicAllocation allocate(GLsizeiptr size, GLsizeiptr alignment);
+
+    /// @brief allocate a sub-range and copy data into it
+    /// @param data the data
+    /// @param size the size of the data in bytes
+    /// @param alignment the alignment of the range's offset in the buffer
+    /// @return the range (data is nullptr if the region is full)
+    DynamicAllocation write(const void *data, GLsizeiptr size, GLsizeiptr alignment);
+
+    /// @brief make the data written to a range visible to OpenGL - a no-op when persistently mapped (the mapping is coherent)
+    /// @param allocation the range
+    void flush(const DynamicAllocation &allocation);
+
+    /// @brief flush a range and bind it to an indexed binding point (glBindBufferRange)
+    /// @param allocation the range
+    /// @param binding_point the binding point index
+    void bindRange(const DynamicAllocation &allocation, GLuint binding_point);
+
+    /// @brief end the frame - fences the region so it is not overwritten until the GPU has finished this frame's draws
+    void endFrame();
+
+    /// @brief get the id of the buffer
+    /// @return the id
+    unsigned int getID() const;
+
+    /// @brief get the number of bytes allocated this frame (including alignment padding)
+    /// @return the number of bytes
+    GLsizeiptr getUsedBytes() const;
+
+    /// @brief get the waits since the buffer was created
+    /// @return the stats
+    DynamicBufferStats getStats() const;
+
+private:
+    /// @brief the buffer
+    Buffer buffer;
+
+    /// @brief the target the buffer is used with
+    GLenum target;
+
+    /// @brief the size of each frame's region (rounded up to DYNAMIC_BUFFER_FRAME_ALIGNMENT)
+    GLsizeiptr frameSize;
+
+    /// @brief the number of frames in the ring
+    unsigned int frameCount;
+
+    /// @brief the index of the region being written this frame
+    unsigned int currentFrame;
+
+    /// @brief the number of bytes allocated from the current region
+    GLsizeiptr usedBytes;
+
+    /// @brief whether the buffer is persistently mapped (otherwise writes go to staging)
+    bool persistent;
+
+    /// @brief the persistent mapping of the whole buffer, or the start of staging
+    char *mapped;
+
+    /// @brief the CPU copy written to when the buffer cannot be persistently mapped
+    std::vector<char> staging;
+
+    /// @brief the fence placed after the last frame that used each region (nullptr if none)
+    std::vector<GLsync> fences;
+
+    /// @brief the waits since the buffer was created
+    DynamicBufferStats stats;
+};
@@ -0,0 +1,18 @@
+#pragma once
+#include "rendering/buffer/buffer/buffer.h"
+#include <glad/glad.h>
+
+/// @brief the Shader Storage Buffer Object stores arrays of data (i.e. per draw transforms) that shaders index freely - requires OpenGL 4.3
+class SSBO : public Buffer
+{
+public:
+    SSBO();
+
+    SSBO(SSBO &&other);
+
+    SSBO &operator=(SSBO &&other) noexcept;
+
+    /// @brief bind this buffer to an indexed shader storage block binding point, making it visible to every shader block bound to that point
+    /// @param binding_point the binding point index
+    void bindToBindingPoint(unsigned int binding_point) const;
+};
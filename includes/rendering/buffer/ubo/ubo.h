@@ -0,0 +1,18 @@
+#pragma once
+#include "rendering/buffer/buffer/buffer.h"
+#include <glad/glad.h>
+
+/// @brief the Uniform Buffer Object stores uniform block data that can be shared between shader programs
+class UBO : public Buffer
+{
+public:
+    UBO();
+
+    UBO(UBO &&other);
+
+    UBO &operator=(UBO &&other) noexcept;
+
+    /// @brief bind this buffer to an indexed uniform block binding point, making it visible to every shader block bound to that point
+    /// @param binding_point the binding point index
+    void bindToBindingPoint(unsigned int binding_point) const;
+};
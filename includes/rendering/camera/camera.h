@@ -73,6 +73,13 @@ public:
     /// @return the view matrix
     glm::mat4 getViewMatrix();
 
+    /// @brief get the perspective projection matrix for this camera's zoom (field of view)
+    /// @param aspect_ratio the width / height of the viewport
+    /// @param near_plane the distance to the near clipping plane
+    /// @param far_plane the distance to the far clipping plane
+    /// @return the projection matrix
+    glm::mat4 getProjectionMatrix(float aspect_ratio, float near_plane, float far_plane) const;
+
     void processKeyboard(Movement direction, float deltaTime);
 
     void processMouseMovement(float xoffset, float yoffset, GLboolean constrainPitch = true);
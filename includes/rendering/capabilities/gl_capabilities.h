@@ -0,0 +1,54 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+#include <unordered_set>
+
+/// @brief queries (and caches) what the current OpenGL context supports - requires a current context on first use
+class GLCapabilities
+{
+public:
+    /// @brief check if the context supports an extension
+    /// @param extension_name the name of the extension (i.e. GL_EXT_texture_filter_anisotropic)
+    /// @return true if the extension is supported
+    static bool hasExtension(const std::string &extension_name);
+
+    /// @brief check if the context version is at least the given version
+    /// @param major the major version (i.e. 4 for OpenGL 4.3)
+    /// @param minor the minor version (i.e. 3 for OpenGL 4.3)
+    /// @return true if the context is at least this version
+    static bool isVersionAtLeast(int major, int minor);
+
+    /// @brief get the maximum anisotropic filtering level supported
+    /// @return the max anisotropy, or 1 if anisotropic filtering is not supported
+    static float getMaxAnisotropy();
+
+    /// @brief get the alignment the offset of a uniform buffer range must have (GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT)
+    /// @return the alignment in bytes
+    static GLint getUniformBufferOffsetAlignment();
+
+    // delete copy constructor
+    GLCapabilities(GLCapabilities const &) = delete;
+    // delete copy assignment
+    void operator=(GLCapabilities const &) = delete;
+
+private:
+    /// @brief constructor (private because singleton) - queries the current context
+    GLCapabilities();
+
+    static GLCapabilities &getInstance();
+
+    /// @brief the major version of the context
+    int majorVersion;
+
+    /// @brief the minor version of the context
+    int minorVersion;
+
+    /// @brief the names of all extensions supported by the context
+    std::unordered_set<std::string> extensions;
+
+    /// @brief the maximum anisotropy supported (1 if unsupported)
+    float maxAnisotropy;
+
+    /// @brief the alignment of uniform buffer range offsets
+    GLint uniformBufferOffsetAlignment;
+};
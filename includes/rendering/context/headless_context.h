@@ -0,0 +1,66 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+
+/// @brief an OpenGL context with no window, for running the engine on display-less servers (i.e. benchmarks and regression tests in CI).
+/// The context is made through EGL - surfaceless where the driver supports it (i.e. Mesa's llvmpipe), otherwise on a pbuffer - and every frame
+/// is drawn into an offscreen framebuffer. Only available when built with THREEDIMSIM_EGL (the CMake option of the same name)
+class HeadlessContext
+{
+public:
+    /// @brief constructor - creates the context, makes it current, loads OpenGL through glad and binds the offscreen framebuffer
+    /// @param width the width of the framebuffer in pixels
+    /// @param height the height of the framebuffer in pixels
+    HeadlessContext(int width, int height);
+
+    /// @brief destructor - deletes the framebuffer and destroys the context
+    ~HeadlessContext();
+
+    // delete copy constructor
+    HeadlessContext(HeadlessContext const &) = delete;
+    // delete copy assignment
+    void operator=(HeadlessContext const &) = delete;
+
+    /// @brief check if the engine was built with headless support
+    /// @return true if built with EGL
+    static bool isAvailable();
+
+    /// @brief check if the context was created and OpenGL loaded
+    /// @return true if the context is usable
+    bool isValid() const;
+
+    /// @brief make the context current on the calling thread (i.e. on the render thread)
+    void makeCurrent();
+
+    /// @brief release the context from the calling thread, so another thread can make it current
+    void releaseCurrent();
+
+    /// @brief end a frame in place of swapping buffers - waits for the GPU to finish it, so frame times include the GPU's work
+    void endFrame();
+
+    /// @brief read the framebuffer back and write it to a binary PPM image (i.e. to compare against a reference render)
+    /// @param path the path of the image
+    /// @return true if the image was written
+    bool saveImage(const std::string &path) const;
+
+    /// @brief get the width
+    /// @return the width in pixels
+    int getWidth() const;
+
+    /// @brief get the height
+    /// @return the height in pixels
+    int getHeight() const;
+
+private:
+    /// @brief the EGL display, context and surface (EGL's handles are opaque pointers, kept as void * so EGL stays out of this header)
+    void *display, *context, *surface;
+
+    /// @brief the offscreen framebuffer and its colour and depth renderbuffers
+    GLuint framebuffer_ID, colourRenderbuffer_ID, depthRenderbuffer_ID;
+
+    /// @brief the size of the framebuffer in pixels
+    int width, height;
+
+    /// @brief whether the context was created and OpenGL loaded
+    bool valid;
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstddef>
+
+/// @brief an axis aligned bounding box
+struct AABB
+{
+    /// @brief the minimum corner
+    glm::vec3 min;
+    /// @brief the maximum corner
+    glm::vec3 max;
+
+    /// @brief get the centre of the box
+    /// @return the centre
+    glm::vec3 getCentre() const;
+
+    /// @brief get the half size of the box along each axis
+    /// @return the extents
+    glm::vec3 getExtents() const;
+
+    /// @brief get the surface area of the box
+    /// @return the surface area (0 for an empty box)
+    float getSurfaceArea() const;
+
+    /// @brief grow this box to contain another box
+    /// @param other the other box
+    void expand(const AABB &other);
+
+    /// @brief check if this box overlaps another box
+    /// @param other the other box
+    /// @return true if the boxes overlap (or touch)
+    bool overlaps(const AABB &other) const;
+
+    /// @brief get a box containing nothing, which any box can be expanded into
+    /// @return the empty box
+    static AABB empty();
+
+    /// @brief get the box bounding this box after it has been transformed
+    /// @param transform the transform (i.e. a model matrix)
+    /// @return the transformed box
+    AABB transformed(const glm::mat4 &transform) const;
+};
+
+/// @brief the number of boxes tested together by the SIMD culling path
+const size_t CULLING_BATCH_SIZE = 4;
+
+/// @brief a list of boxes stored as centres and extents in separate arrays (structure of arrays), so they can be tested several at a time
+/// with SIMD - the arrays are padded to a multiple of CULLING_BATCH_SIZE with empty boxes
+class CullingBounds
+{
+public:
+    /// @brief add a box to the end of the list
+    /// @param bounds the box
+    void add(const AABB &bounds);
+
+    /// @brief remove every box
+    void clear();
+
+    /// @brief get the number of boxes added
+    /// @return the number of boxes
+    size_t size() const;
+
+    /// @brief the centres and extents of the boxes, one array per component
+    std::vector<float> centreX, centreY, centreZ;
+    std::vector<float> extentX, extentY, extentZ;
+
+private:
+    /// @brief the number of boxes added (the arrays may be longer due to padding)
+    size_t count = 0;
+};
+
@@ -0,0 +1,191 @@
+#pragma once
+#include <cstdint>
+#include <future>
+#include <vector>
+#include <glm/glm.hpp>
+#include "rendering/culling/bounds.h"
+#include "rendering/culling/frustum.h"
+#include "utils/thread_pool/thread_pool.h"
+
+/// @brief the most objects a BVH leaf holds
+const unsigned int BVH_MAX_LEAF_SIZE = 4;
+
+/// @brief the number of bins candidate SAH splits are placed between
+const unsigned int BVH_SAH_BIN_COUNT = 16;
+
+/// @brief the number of object moves (as a fraction of the object count) after which the tree is rebuilt, as refitting loosens it
+const float BVH_REBUILD_MOVED_FRACTION = 0.5f;
+
+/// @brief the number of objects added since the last build (as a fraction of the object count) after which the tree is rebuilt
+const float BVH_REBUILD_PENDING_FRACTION = 0.05f;
+
+/// @brief marks an object that is not in the tree (yet)
+const uint32_t BVH_NO_NODE = 0xFFFFFFFF;
+
+/// @brief a node of a BVH - children are stored next to each other, after their parent
+struct BVHNode
+{
+    /// @brief the box bounding everything below this node
+    AABB bounds;
+    /// @brief the index of the left child (the right child follows it), or of the first object in BVH::leafObjects for a leaf
+    uint32_t firstChildOrObject;
+    /// @brief the number of objects in this leaf (0 for an internal node)
+    uint32_t objectCount;
+    /// @brief the index of the parent node (BVH_NO_NODE for the root)
+    uint32_t parent;
+};
+
+/// @brief the closest object hit by a ray
+struct BVHRayHit
+{
+    /// @brief the id of the object hit
+    uint32_t object;
+    /// @brief the distance along the ray to the object's bounds
+    float distance;
+};
+
+/// @brief a bounding volume hierarchy over the bounds of scene objects, for culling and spatial queries in less than linear time. Moved
+/// objects are refitted into the existing tree, which is rebuilt with the surface area heuristic (SAH) on a worker thread once it has
+/// loosened. Objects added since the last build are tested one by one until the next build includes them.
+class BVH
+{
+public:
+    /// @brief constructor - an empty tree
+    BVH();
+
+    /// @brief destructor - waits for any build in progress
+    ~BVH();
+
+    // delete copy constructor
+    BVH(BVH const &) = delete;
+    // delete copy assignment
+    void operator=(BVH const &) = delete;
+
+    /// @brief add an object
+    /// @param bounds the object's bounds
+    /// @return the id of the object
+    uint32_t insert(const AABB &bounds);
+
+    /// @brief remove an object (its id may be given to a later object)
+    /// @param object the id of the object
+    void remove(uint32_t object);
+
+    /// @brief move an object - the tree is updated by the next refit()
+    /// @param object the id of the object
+    /// @param bounds the object's new bounds
+    void update(uint32_t object, const AABB &bounds);
+
+    /// @brief grow or shrink the nodes above every object moved since the last refit
+    void refit();
+
+    /// @brief rebuild the whole tree on this thread
+    void rebuild();
+
+    /// @brief call once per frame - swaps in a finished background build, refits, and starts a background build if the tree has loosened
+    /// @param thread_pool the pool to build on
+    /// @return true if a new tree was swapped in
+    bool maintain(ThreadPool &thread_pool);
+
+    /// @brief find every object that may be inside a frustum
+    /// @param frustum the frustum
+    /// @param objects filled with the ids of the objects
+    void queryFrustum(const Frustum &frustum, std::vector<uint32_t> &objects) const;
+
+    /// @brief find every object whose bounds overlap a box
+    /// @param bounds the box
+    /// @param objects filled with the ids of the objects
+    void queryOverlap(const AABB &bounds, std::vector<uint32_t> &objects) const;
+
+    /// @brief find the closest object whose bounds are hit by a ray
+    /// @param origin the start of the ray
+    /// @param direction the direction of the ray (need not be normalised - distances are in multiples of it)
+    /// @param max_distance the furthest distance to look
+    /// @param hit set to the closest hit, if there is one
+    /// @return true if an object was hit
+    bool raycast(const glm::vec3 &origin, const glm::vec3 &direction, float max_distance, BVHRayHit &hit) const;
+
+    /// @brief get the number of objects
+    /// @return the number of objects
+    size_t getObjectCount() const;
+
+    /// @brief get the number of nodes in the tree
+    /// @return the number of nodes
+    size_t getNodeCount() const;
+
+    /// @brief check if a background build is in progress
+    /// @return true if building
+    bool isRebuilding() const;
+
+private:
+    /// @brief a tree built from a snapshot of the objects
+    struct BuildResult
+    {
+        std::vector<BVHNode> nodes;
+        std::vector<uint32_t> leafObjects;
+    };
+
+    /// @brief build a tree with binned SAH splits (touches no BVH state, so it can run on any thread)
+    /// @param bounds the bounds of every object
+    /// @param alive whether each object exists
+    /// @return the tree
+    static BuildResult build(std::vector<AABB> bounds, std::vector<uint8_t> alive);
+
+    /// @brief replace the tree with a new one, refitting it to the current object bounds
+    /// @param result the new tree
+    void applyBuild(BuildResult &&result);
+
+    /// @brief check if the tree has loosened or missed enough new objects to be worth rebuilding
+    /// @return true if it should be rebuilt
+    bool needsRebuild() const;
+
+    /// @brief recalculate the bounds of a leaf from the objects in it
+    /// @param node_index the index of the leaf
+    void refitLeaf(uint32_t node_index);
+
+    /// @brief add every live object in and below a node to a list
+    /// @param node_index the index of the node
+    /// @param objects the list
+    void collectObjects(uint32_t node_index, std::vector<uint32_t> &objects) const;
+
+    /// @brief the bounds of each object
+    std::vector<AABB> objectBounds;
+
+    /// @brief whether each object id is in use
+    std::vector<uint8_t> objectAlive;
+
+    /// @brief the leaf each object is in (BVH_NO_NODE if it is not in the tree)
+    std::vector<uint32_t> objectLeaves;
+
+    /// @brief the objects not in the tree yet
+    std::vector<uint32_t> pendingObjects;
+
+    /// @brief ids that are free to give to new objects
+    std::vector<uint32_t> freeObjects;
+
+    /// @brief ids removed since the last build started - these may still be in the tree being built, so are only freed once it is applied
+    std::vector<uint32_t> removedObjects;
+
+    /// @brief the nodes of the tree (the root is node 0)
+    std::vector<BVHNode> nodes;
+
+    /// @brief the objects in the leaves, each leaf owning a contiguous range
+    std::vector<uint32_t> leafObjects;
+
+    /// @brief the leaves containing objects moved since the last refit
+    std::vector<uint32_t> dirtyLeaves;
+
+    /// @brief whether each node is in dirtyLeaves
+    std::vector<uint8_t> nodeDirty;
+
+    /// @brief the number of object moves since the last build started
+    size_t movedSinceBuild;
+
+    /// @brief the number of live objects
+    size_t objectCount;
+
+    /// @brief the build in progress on a worker thread (if any)
+    std::future<BuildResult> pendingBuild;
+
+    /// @brief the ids removed before the build in progress started, freed once it is applied
+    std::vector<uint32_t> pendingBuildRemovedObjects;
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "rendering/culling/bounds.h"
+
+/// @brief the six planes bounding a camera's view
+enum class FRUSTUM_PLANE
+{
+    LEFT = 0,
+    RIGHT = 1,
+    BOTTOM = 2,
+    TOP = 3,
+    NEAR_CLIP = 4, // (NEAR and FAR are macros on Windows)
+    FAR_CLIP = 5
+};
+
+/// @brief the number of visible and total objects tested in a frame
+struct CullingStats
+{
+    /// @brief the number of objects tested
+    unsigned int total;
+    /// @brief the number of objects that passed
+    unsigned int visible;
+    /// @brief the number of objects inside the frustum but hidden behind occluders
+    unsigned int occluded;
+};
+
+/// @brief the volume a camera can see, as six inward facing planes - used to skip objects that are off screen
+class Frustum
+{
+public:
+    /// @brief extract the planes of a camera's frustum
+    /// @param view_projection the camera's projection matrix multiplied by its view matrix (in world space) - or by model too, to get the planes in model space
+    Frustum(const glm::mat4 &view_projection);
+
+    /// @brief check if a box is at least partly inside the frustum (conservative - boxes near corners may pass when just outside)
+    /// @param bounds the box
+    /// @return true if the box may be visible
+    bool isVisible(const AABB &bounds) const;
+
+    /// @brief check if a box is entirely inside the frustum (so everything inside the box is too)
+    /// @param bounds the box
+    /// @return true if no part of the box is outside the frustum
+    bool contains(const AABB &bounds) const;
+
+    /// @brief test many boxes against the frustum, 4 at a time with SIMD where available
+    /// @param bounds the boxes
+    /// @param visible filled with 1 for each box that may be visible and 0 for each that is not
+    /// @return the number of boxes that may be visible
+    size_t cull(const CullingBounds &bounds, std::vector<uint8_t> &visible) const;
+
+    /// @brief test many boxes against the frustum one at a time (the fallback for cull() without SIMD)
+    /// @param bounds the boxes
+    /// @param visible filled with 1 for each box that may be visible and 0 for each that is not
+    /// @return the number of boxes that may be visible
+    size_t cullScalar(const CullingBounds &bounds, std::vector<uint8_t> &visible) const;
+
+    /// @brief get this frustum in the space a transform maps into this frustum's space (i.e. pass a model matrix to get it in model space)
+    /// @param transform the transform
+    /// @return the transformed frustum
+    Frustum transformed(const glm::mat4 &transform) const;
+
+    /// @brief get one of the planes
+    /// @param plane which plane
+    /// @return the plane, as a normal pointing into the frustum (xyz) and distance (w)
+    const glm::vec4 &getPlane(FRUSTUM_PLANE plane) const;
+
+private:
+    /// @brief the planes, indexed by FRUSTUM_PLANE
+    glm::vec4 planes[6];
+};
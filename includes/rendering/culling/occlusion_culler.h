@@ -0,0 +1,160 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "rendering/culling/bounds.h"
+#include "utils/thread_pool/thread_pool.h"
+
+/// @brief the default width of the occlusion depth buffer in pixels (a multiple of OCCLUSION_TILE_WIDTH)
+const unsigned int OCCLUSION_BUFFER_WIDTH = 256;
+
+/// @brief the default height of the occlusion depth buffer in pixels (a multiple of OCCLUSION_TILE_HEIGHT)
+const unsigned int OCCLUSION_BUFFER_HEIGHT = 128;
+
+/// @brief the width of the tiles the depth buffer is split into - each tile is rasterised by one thread (a multiple of 4 for SIMD)
+const unsigned int OCCLUSION_TILE_WIDTH = 64;
+
+/// @brief the height of the tiles the depth buffer is split into
+const unsigned int OCCLUSION_TILE_HEIGHT = 32;
+
+/// @brief how much nearer (in depth buffer units) an occluder must be than an object to hide it - allows for rounding when an object is
+/// its own occluder
+const float OCCLUSION_DEPTH_BIAS = 1e-5f;
+
+/// @brief triangles drawn into the occlusion buffer - the geometry must not cover anything the real geometry does not (i.e. a box inside a wall)
+struct OccluderMesh
+{
+    /// @brief the positions of the vertices in model space
+    std::vector<glm::vec3> positions;
+    /// @brief 3 indices into positions per triangle
+    std::vector<unsigned int> indices;
+
+    /// @brief make a simple occluder from a box
+    /// @param bounds the box (which must be inside the geometry it stands in for)
+    /// @return the 12 triangles of the box
+    static OccluderMesh fromBox(const AABB &bounds);
+};
+
+/// @brief what the occlusion culler did in a frame
+struct OcclusionStats
+{
+    /// @brief the number of occluders drawn into the depth buffer
+    unsigned int occludersDrawn;
+    /// @brief the number of triangles drawn into the depth buffer (after clipping)
+    unsigned int trianglesDrawn;
+    /// @brief the number of objects tested against the depth buffer
+    unsigned int objectsTested;
+    /// @brief the number of objects found to be hidden
+    unsigned int objectsRejected;
+    /// @brief the time spent drawing the occluders
+    float rasterMilliseconds;
+    /// @brief the time spent testing objects in cull()
+    float testMilliseconds;
+};
+
+/// @brief culls objects hidden behind occluders by drawing the occluders into a small depth buffer on the CPU, then testing the screen
+/// rectangle and nearest depth of each object's bounds against it. The buffer is split into tiles rasterised in parallel, 4 pixels at a
+/// time with SIMD where available
+class OcclusionCuller
+{
+public:
+    /// @brief constructor
+    /// @param thread_pool the pool the occluders are drawn and objects are tested on
+    /// @param width the width of the depth buffer (rounded up to a whole number of tiles)
+    /// @param height the height of the depth buffer (rounded up to a whole number of tiles)
+    OcclusionCuller(ThreadPool &thread_pool, unsigned int width = OCCLUSION_BUFFER_WIDTH, unsigned int height = OCCLUSION_BUFFER_HEIGHT);
+
+    /// @brief start a new frame - forgets the last frame's occluders
+    /// @param view_projection the camera's projection matrix multiplied by its view matrix
+    void beginFrame(const glm::mat4 &view_projection);
+
+    /// @brief add an occluder to draw this frame (it must live until rasterize() returns)
+    /// @param occluder the occluder
+    /// @param model the model matrix it is drawn with
+    void addOccluder(const OccluderMesh &occluder, const glm::mat4 &model);
+
+    /// @brief draw every occluder added this frame into the depth buffer
+    void rasterize();
+
+    /// @brief check if a box may be visible past the occluders (safe to call from several threads once rasterize() has returned)
+    /// @param bounds the box in world space
+    /// @return false if the box is entirely hidden
+    bool isVisible(const AABB &bounds) const;
+
+    /// @brief test many boxes against the depth buffer across the thread pool
+    /// @param bounds the boxes in world space
+    /// @param visible filled with 1 for each box that may be visible and 0 for each that is hidden
+    /// @return the number of boxes that may be visible
+    size_t cull(const std::vector<AABB> &bounds, std::vector<uint8_t> &visible);
+
+    /// @brief get the stats of the current frame
+    /// @return the stats
+    OcclusionStats getStats() const;
+
+    /// @brief get the depth buffer (row by row, bottom row first, 0 = near to 1 = far)
+    /// @return the depth of each pixel
+    const std::vector<float> &getDepthBuffer() const;
+
+private:
+    /// @brief a triangle in screen space, ready to rasterise
+    struct ScreenTriangle
+    {
+        /// @brief the pixel coordinates and depth of each vertex
+        glm::vec3 vertices[3];
+    };
+
+    /// @brief transform an occluder to clip space, clip it against the near plane, and add its triangles to a list
+    /// @param occluder_index the index of the occluder in occluders
+    /// @param triangles the list
+    void setupTriangles(size_t occluder_index, std::vector<ScreenTriangle> &triangles) const;
+
+    /// @brief draw every triangle binned to a tile into the tile
+    /// @param tile_index the index of the tile
+    void rasterizeTile(size_t tile_index);
+
+    /// @brief convert a clip space position to pixel coordinates and depth
+    /// @param clip the clip space position (w must be positive)
+    /// @return the pixel coordinates (xy) and depth in [0, 1] (z)
+    glm::vec3 toScreen(const glm::vec4 &clip) const;
+
+    /// @brief an occluder added this frame
+    struct OccluderInstance
+    {
+        const OccluderMesh *mesh;
+        glm::mat4 modelViewProjection;
+    };
+
+    /// @brief the pool the work is split across
+    ThreadPool &threadPool;
+
+    /// @brief the size of the depth buffer in pixels
+    unsigned int width, height;
+
+    /// @brief the number of tiles across and up the depth buffer
+    unsigned int tilesX, tilesY;
+
+    /// @brief the depth of each pixel
+    std::vector<float> depthBuffer;
+
+    /// @brief the camera's view projection matrix this frame
+    glm::mat4 viewProjection;
+
+    /// @brief the occluders added this frame
+    std::vector<OccluderInstance> occluders;
+
+    /// @brief the screen space triangles of each occluder
+    std::vector<std::vector<ScreenTriangle>> occluderTriangles;
+
+    /// @brief the triangles overlapping each tile, as (occluder, triangle) index pairs
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> tileBins;
+
+    /// @brief the stats of the current frame
+    OcclusionStats stats;
+
+    /// @brief the number of objects tested this frame (counted from several threads)
+    mutable std::atomic<unsigned int> objectsTested;
+
+    /// @brief the number of objects found to be hidden this frame (counted from several threads)
+    mutable std::atomic<unsigned int> objectsRejected;
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <memory>
+#include <set>
+#include <string>
+#include <glm/glm.hpp>
+#include "rendering/deferred/gbuffer.h"
+#include "rendering/shader/shader_variants.h"
+#include "rendering/vao/vao.h"
+
+/// @brief shades the scene after it is drawn, an alternative to the forward path of test_phong.frag. The geometry pass draws each visible
+/// surface's material into the G-buffer (with gbuffer.frag), then the lighting pass shades every pixel once with a fullscreen triangle, so
+/// overdrawn fragments are never lit. The lighting pass loops over either the point lights of the Lights block, or (where shader storage buffers
+/// are supported) only the lights in each pixel's cluster of the LightManager - the tiled path for many lights
+class DeferredRenderer
+{
+public:
+    /// @brief constructor - creates the G-buffer and the lighting shaders
+    /// @param width the width of the G-buffer in pixels
+    /// @param height the height of the G-buffer in pixels
+    /// @param clustered_lights whether to build the lighting pass that reads the LightManager's clusters (requires LightManager::isSupported())
+    DeferredRenderer(int width, int height, bool clustered_lights);
+
+    // delete copy constructor
+    DeferredRenderer(DeferredRenderer const &) = delete;
+    // delete copy assignment
+    void operator=(DeferredRenderer const &) = delete;
+
+    /// @brief start the geometry pass - binds and clears the G-buffer (resizing it to match the framebuffer)
+    /// @param width the width of the framebuffer in pixels
+    /// @param height the height of the framebuffer in pixels
+    void beginGeometryPass(int width, int height);
+
+    /// @brief end the geometry pass - goes back to drawing into the framebuffer bound when it began
+    void endGeometryPass();
+
+    /// @brief shade every pixel of the G-buffer into that framebuffer, then copy the depth across
+    /// @param view the view matrix the geometry pass was drawn with
+    /// @param projection the projection matrix the geometry pass was drawn with
+    /// @param clustered_lights whether to light with the LightManager's clusters (uploaded this frame) rather than the Lights block
+    void executeLightingPass(const glm::mat4 &view, const glm::mat4 &projection, bool clustered_lights);
+
+    /// @brief rebuild the lighting shaders if they use an edited file
+    /// @param affected_files the edited files
+    void reload(const std::set<std::string> &affected_files);
+
+    /// @brief get the G-buffer
+    /// @return the G-buffer
+    const GBuffer &getGBuffer() const;
+
+private:
+    /// @brief the surfaces drawn by the geometry pass
+    GBuffer gBuffer;
+
+    /// @brief the lighting pass shader using the Lights block
+    ShaderVariants lightingShaders;
+
+    /// @brief the lighting pass shader using the LightManager's clusters (nullptr if not built)
+    std::unique_ptr<ShaderVariants> clusteredLightingShaders;
+
+    /// @brief an empty VAO for the fullscreen triangle (its vertices are made from gl_VertexID, but the core profile needs a VAO bound to draw)
+    VAO fullscreenVAO;
+};
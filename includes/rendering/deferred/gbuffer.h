@@ -0,0 +1,82 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+
+/// @brief the attachments of the G-buffer (and the texture units the lighting pass reads them from)
+enum class GBUFFER_ATTACHMENT
+{
+    /// @brief albedo in rgb, specular intensity in a (GL_RGBA8)
+    ALBEDO_SPECULAR = 0,
+    /// @brief octahedral encoded normal in rg, log encoded shininess in b (GL_RGB10_A2)
+    NORMAL_SHININESS = 1,
+    /// @brief the depth buffer, which world positions are rebuilt from (GL_DEPTH24_STENCIL8)
+    DEPTH = 2
+};
+
+/// @brief the number of G-buffer attachments
+const unsigned int GBUFFER_ATTACHMENT_COUNT = 3;
+
+/// @brief a framebuffer holding each pixel's surface for deferred shading. It is packed into 12 bytes per pixel: positions are not stored
+/// (they are rebuilt from depth), normals are octahedral encoded into two 10 bit channels, and specular is reduced to one intensity
+class GBuffer
+{
+public:
+    /// @brief constructor - creates the framebuffer and its attachments
+    /// @param width the width in pixels
+    /// @param height the height in pixels
+    GBuffer(int width, int height);
+
+    /// @brief destructor - deletes the framebuffer and its attachments
+    ~GBuffer();
+
+    // delete copy constructor
+    GBuffer(GBuffer const &) = delete;
+    // delete copy assignment
+    void operator=(GBuffer const &) = delete;
+
+    /// @brief reallocate the attachments if the size has changed
+    /// @param width the width in pixels
+    /// @param height the height in pixels
+    void resize(int width, int height);
+
+    /// @brief draw into the G-buffer (binds the framebuffer and sets the viewport to cover it) - the framebuffer bound before is the output
+    void bind();
+
+    /// @brief go back to drawing into the output framebuffer
+    void unbind() const;
+
+    /// @brief bind each attachment to the texture unit of the same index, from first_unit on
+    /// @param first_unit the unit of the first attachment (i.e. GL_TEXTURE0)
+    void bindTextures(GLenum first_unit) const;
+
+    /// @brief copy the depth buffer into the output framebuffer, so forward drawing after the lighting pass is depth tested against the scene
+    void copyDepthToOutput() const;
+
+    /// @brief get the width
+    /// @return the width in pixels
+    int getWidth() const;
+
+    /// @brief get the height
+    /// @return the height in pixels
+    int getHeight() const;
+
+    /// @brief get the memory used by the attachments
+    /// @return the size in bytes
+    size_t getMemorySize() const;
+
+private:
+    /// @brief (re)allocate the attachments at the current size
+    void allocate();
+
+    /// @brief the framebuffer
+    GLuint framebuffer_ID;
+
+    /// @brief the framebuffer bound when the G-buffer was (i.e. the default framebuffer, or the offscreen one of a HeadlessContext)
+    GLuint outputFramebuffer_ID;
+
+    /// @brief the texture of each attachment
+    GLuint textures[GBUFFER_ATTACHMENT_COUNT];
+
+    /// @brief the size of the attachments in pixels
+    int width, height;
+};
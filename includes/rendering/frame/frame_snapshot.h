@@ -0,0 +1,112 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+#include "imgui.h"
+#include "rendering/buffer/dynamic_buffer/dynamic_buffer.h"
+#include "rendering/culling/frustum.h"
+#include "rendering/culling/occlusion_culler.h"
+#include "rendering/lighting/light_manager.h"
+#include "rendering/profiler/gpu_profiler.h"
+#include "rendering/render_queue/indirect_renderer.h"
+#include "rendering/render_queue/render_queue.h"
+#include "rendering/shader/shader.h"
+#include "rendering/state_cache/gl_state_cache.h"
+#include "rendering/texture/texture_manager.h"
+
+/// @brief a copy of ImGui's draw data that outlives the ImGui frame it was built in, so the render thread can draw it while the main
+/// thread builds the next one. The copied draw lists are kept between frames, so capturing only reallocates when the UI grows
+class ImGuiDrawSnapshot
+{
+public:
+    /// @brief constructor - the snapshot starts empty
+    ImGuiDrawSnapshot();
+
+    /// @brief destructor - deletes the copied draw lists
+    ~ImGuiDrawSnapshot();
+
+    // delete copy constructor
+    ImGuiDrawSnapshot(ImGuiDrawSnapshot const &) = delete;
+    // delete copy assignment
+    void operator=(ImGuiDrawSnapshot const &) = delete;
+
+    /// @brief copy the draw data of the frame ImGui just rendered (call on the thread that owns the ImGui context, after ImGui::Render)
+    /// @param draw_data the draw data (i.e. ImGui::GetDrawData())
+    void capture(const ImDrawData *draw_data);
+
+    /// @brief get the copied draw data
+    /// @return the draw data (i.e. for ImGui_ImplOpenGL3_RenderDrawData)
+    ImDrawData *getDrawData();
+
+private:
+    /// @brief the copied draw data, pointing at drawLists
+    ImDrawData drawData;
+
+    /// @brief the copied draw lists (more may be kept than the last frame used)
+    std::vector<ImDrawList *> drawLists;
+};
+
+/// @brief the renderer options picked in the UI
+struct FrameSettings
+{
+    bool deferredShading;
+    bool occlusionCulling;
+    /// @brief whether culling and encoding draws is spread over the thread pool
+    bool parallelBuild;
+    bool indirectDrawing;
+    bool clusteredLighting;
+    int clusteredLightCount;
+    float anisotropy;
+    bool trilinearFiltering;
+};
+
+/// @brief everything the render thread needs to draw one frame, written by the main thread
+struct FrameSnapshot
+{
+    /// @brief the index of the frame
+    unsigned int frameIndex;
+    /// @brief the simulation time of the frame in seconds
+    double time;
+    /// @brief the size of the framebuffer to draw into in pixels
+    int framebufferWidth, framebufferHeight;
+    /// @brief the camera
+    glm::mat4 view, projection;
+    glm::vec3 viewPosition;
+    /// @brief the model's transform
+    glm::mat4 model;
+    /// @brief the position of each clustered point light (empty unless clustered lighting is on)
+    std::vector<glm::vec3> lightPositions;
+    /// @brief the renderer options
+    FrameSettings settings;
+    /// @brief the UI
+    ImGuiDrawSnapshot imGui;
+};
+
+/// @brief what the render thread did in the last frame it drew, shown by the main thread's UI
+struct RenderThreadStats
+{
+    /// @brief the time the render thread spent on the frame
+    float frameMilliseconds;
+    /// @brief the time spent culling, encoding, merging and sorting the frame's draws
+    float buildMilliseconds;
+    TextureMemoryStats textures;
+    size_t samplerCount;
+    size_t shaderVariantCount;
+    CullingStats culling;
+    OcclusionStats occlusion;
+    RenderQueueStats queue;
+    IndirectRendererStats indirect;
+    LightClusterStats clusters;
+    /// @brief the per object ring (ringUsedBytes is 0 without one)
+    DynamicBufferStats ring;
+    GLsizeiptr ringUsedBytes;
+    UniformUploadStats uploads;
+    GLStateStats binds;
+    /// @brief the size of the G-buffer
+    int gBufferWidth, gBufferHeight;
+    size_t gBufferMemory;
+    /// @brief the GPU time of the whole frame and of each profiled scope (from a frame a few frames back, as results arrive late)
+    GPUScopeStats gpuFrame;
+    std::vector<GPUScopeStats> gpuScopes;
+    unsigned int gpuDroppedFrames;
+};
@@ -0,0 +1,205 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "rendering/uniform_blocks/uniform_blocks.h"
+#include "utils/thread_pool/thread_pool.h"
+
+class SSBO;
+
+/// @brief the number of clusters across the screen
+const unsigned int LIGHT_CLUSTERS_X = 16;
+
+/// @brief the number of clusters up the screen
+const unsigned int LIGHT_CLUSTERS_Y = 9;
+
+/// @brief the number of depth slices of clusters (spaced exponentially between the near and far planes)
+const unsigned int LIGHT_CLUSTERS_Z = 24;
+
+/// @brief the light intensity below which a point light is treated as having no effect (sets each light's radius)
+const float LIGHT_CUTOFF_INTENSITY = 1.0f / 256.0f;
+
+/// @brief the shader storage binding points of the clustered lighting buffers (must match binding = ... in clustered_lights.glsl)
+const unsigned int CLUSTERED_LIGHTS_BINDING = 1;
+const unsigned int LIGHT_CLUSTERS_BINDING = 2;
+const unsigned int LIGHT_INDICES_BINDING = 3;
+
+/// @brief a point light as laid out in the ClusteredLights SSBO (std430)
+struct ClusteredPointLight
+{
+    /// @brief the world space position of the light
+    glm::vec3 position;
+    /// @brief the distance past which the light is below LIGHT_CUTOFF_INTENSITY
+    float radius;
+    glm::vec3 ambient;
+    /// @brief the constant factor in attenuation
+    float constant;
+    glm::vec3 diffuse;
+    /// @brief the linear factor in attenuation
+    float linear;
+    glm::vec3 specular;
+    /// @brief the quadratic factor in attenuation
+    float quadratic;
+};
+static_assert(sizeof(ClusteredPointLight) == 64, "ClusteredPointLight must match its std430 layout");
+
+/// @brief the range of a cluster's lights in the light index list
+struct LightCluster
+{
+    uint32_t offset;
+    uint32_t count;
+};
+
+/// @brief how the lights were binned in the last build
+struct LightClusterStats
+{
+    /// @brief the number of lights
+    unsigned int lightCount;
+    /// @brief the number of lights within the depth range of the view frustum
+    unsigned int visibleLights;
+    /// @brief the number of entries in the light index list
+    unsigned int lightIndexCount;
+    /// @brief the number of clusters holding at least one light
+    unsigned int occupiedClusters;
+    /// @brief the most lights in one cluster
+    unsigned int maxLightsPerCluster;
+    /// @brief the time spent binning the lights
+    float buildMilliseconds;
+};
+
+/// @brief stores point lights in an SSBO and bins them into a grid of clusters over the view frustum (tiles across the screen, exponential slices
+/// in depth) so the fragment shader only loops over the lights in its own cluster. The lights are binned on the CPU each frame, one depth slice
+/// per batch across the thread pool. Requires OpenGL 4.3 for upload() - binning works without a context
+class LightManager
+{
+public:
+    /// @brief constructor
+    /// @param thread_pool the pool the lights are binned on
+    LightManager(ThreadPool &thread_pool);
+
+    /// @brief destructor
+    ~LightManager();
+
+    // delete copy constructor
+    LightManager(LightManager const &) = delete;
+    // delete copy assignment
+    void operator=(LightManager const &) = delete;
+
+    /// @brief check if the current context supports clustered lighting (OpenGL 4.3) - otherwise use the point lights of the Lights block
+    /// @return true if supported
+    static bool isSupported();
+
+    /// @brief add a point light
+    /// @param light the light (as set in the Lights block)
+    /// @return the index of the light
+    size_t addLight(const PointLightData &light);
+
+    /// @brief move a point light
+    /// @param index the index of the light
+    /// @param position the new world space position
+    void setLightPosition(size_t index, const glm::vec3 &position);
+
+    /// @brief get a point light
+    /// @param index the index of the light
+    /// @return the light
+    const ClusteredPointLight &getLight(size_t index) const;
+
+    /// @brief remove every light
+    void clearLights();
+
+    /// @brief get the number of lights
+    /// @return the number of lights
+    size_t getLightCount() const;
+
+    /// @brief bin the lights into the clusters of a camera's view
+    /// @param view the camera's view matrix
+    /// @param projection the camera's (perspective) projection matrix
+    /// @param near_plane the distance to the near plane
+    /// @param far_plane the distance to the far plane
+    /// @param viewport_width the width of the viewport in pixels
+    /// @param viewport_height the height of the viewport in pixels
+    void buildClusters(const glm::mat4 &view, const glm::mat4 &projection, float near_plane, float far_plane, float viewport_width, float viewport_height);
+
+    /// @brief upload the lights and the clusters from the last build, and bind them to their binding points
+    void upload();
+
+    /// @brief find the cluster a world space position falls in (the lookup the fragment shader does)
+    /// @param position the world space position
+    /// @return the cluster (empty if the position is outside the view frustum)
+    LightCluster getCluster(const glm::vec3 &position) const;
+
+    /// @brief get the light index list of the last build (each cluster's lights are a range of it)
+    /// @return the light indices
+    const std::vector<uint32_t> &getLightIndices() const;
+
+    /// @brief get the stats of the last build
+    /// @return the stats
+    LightClusterStats getStats() const;
+
+private:
+    /// @brief the header of the LightClusters SSBO, before the array of clusters
+    struct ClusterGridHeader
+    {
+        /// @brief the number of clusters along x, y and z (w is padding)
+        uint32_t gridSize[4];
+        /// @brief multiplied by log(view depth) to get the depth slice
+        float depthScale;
+        /// @brief added to depthScale * log(view depth) to get the depth slice
+        float depthBias;
+        float viewportWidth;
+        float viewportHeight;
+    };
+
+    /// @brief a light in view space and the depth slices it overlaps
+    struct LightBounds
+    {
+        glm::vec3 viewCentre;
+        float radius;
+        /// @brief the first depth slice (-1 if the light is outside the frustum)
+        int firstSlice;
+        int lastSlice;
+    };
+
+    /// @brief bin every light overlapping a depth slice into that slice's clusters
+    /// @param slice the depth slice
+    void buildSlice(unsigned int slice);
+
+    /// @brief get the depth slice of a view depth
+    /// @param view_depth the distance in front of the camera
+    /// @return the slice (clamped to the grid)
+    int getSlice(float view_depth) const;
+
+    /// @brief the pool the lights are binned on
+    ThreadPool &threadPool;
+
+    /// @brief the lights
+    std::vector<ClusteredPointLight> lights;
+
+    /// @brief the view space bounds of each light this build
+    std::vector<LightBounds> lightBounds;
+
+    /// @brief the camera this build
+    glm::mat4 view, projection;
+
+    /// @brief the distances to the near and far planes this build
+    float nearPlane, farPlane;
+
+    /// @brief the header uploaded before the clusters
+    ClusterGridHeader header;
+
+    /// @brief the light range of each cluster, x fastest then y then z
+    std::vector<LightCluster> clusters;
+
+    /// @brief the lights binned into each depth slice (offsets relative to the slice) before they are merged
+    std::vector<std::vector<uint32_t>> sliceLightIndices;
+
+    /// @brief the lights of every cluster, back to back
+    std::vector<uint32_t> lightIndices;
+
+    /// @brief the SSBOs holding the lights, the cluster grid and the light index list
+    std::unique_ptr<SSBO> lightBuffer, clusterBuffer, lightIndexBuffer;
+
+    /// @brief the stats of the last build
+    LightClusterStats stats;
+};
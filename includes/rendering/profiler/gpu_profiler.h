@@ -0,0 +1,185 @@
+#pragma once
+#include <glad/glad.h>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// @brief the number of frames of queries in flight - results are read this many frames after they were issued, by which point the GPU
+/// has almost always finished them
+const unsigned int GPU_PROFILER_FRAME_COUNT = 4;
+
+/// @brief the number of frames each scope's rolling stats are taken over
+const unsigned int GPU_PROFILER_HISTORY = 240;
+
+/// @brief the GPU time of one scope in one frame
+struct GPUScopeTiming
+{
+    /// @brief the path of the scope, its name after the names of the scopes it is nested in (i.e. "Scene/Model draw")
+    std::string path;
+    /// @brief the name of the scope
+    std::string name;
+    /// @brief the number of scopes it is nested in
+    unsigned int depth;
+    /// @brief the time the GPU spent between the start and end of the scope
+    float milliseconds;
+};
+
+/// @brief the GPU times of one frame
+struct GPUFrameTimings
+{
+    /// @brief the index of the frame (counting from the profiler's first frame)
+    unsigned int frameIndex;
+    /// @brief the time the GPU spent on the whole frame
+    float frameMilliseconds;
+    /// @brief each scope, in the order they were opened
+    std::vector<GPUScopeTiming> scopes;
+};
+
+/// @brief the rolling stats of a scope over the last GPU_PROFILER_HISTORY frames it was seen in
+struct GPUScopeStats
+{
+    std::string path;
+    std::string name;
+    unsigned int depth;
+    float lastMilliseconds;
+    float averageMilliseconds;
+    float medianMilliseconds;
+    float p95Milliseconds;
+    float p99Milliseconds;
+    float maxMilliseconds;
+};
+
+/// @brief measures the GPU time of a frame and of named, nestable scopes within it. The frame and each scope are timed with a GL_TIMESTAMP
+/// query at their start and end - unlike GL_TIME_ELAPSED queries, which cannot be nested or overlap, so could not time a scope inside another.
+/// Queries are kept in a ring GPU_PROFILER_FRAME_COUNT frames deep, and a frame's results are only read once they are available, so reading
+/// them never waits for the GPU - a frame the GPU has still not finished when its queries come round again is dropped instead. Call every
+/// function on the thread that owns the context
+class GPUProfiler
+{
+public:
+    /// @brief constructor - queries are created the first time a frame needs them
+    /// @param frame_count the number of frames in the query ring
+    GPUProfiler(unsigned int frame_count = GPU_PROFILER_FRAME_COUNT);
+
+    /// @brief destructor - deletes the queries and closes the dump file
+    ~GPUProfiler();
+
+    // delete copy constructor
+    GPUProfiler(GPUProfiler const &) = delete;
+    // delete copy assignment
+    void operator=(GPUProfiler const &) = delete;
+
+    /// @brief write every resolved frame's timings to a CSV file (frame, scope path, depth, milliseconds - the whole frame is scope "Frame")
+    /// @param path the file to write (overwritten)
+    /// @return true if the file was opened
+    bool openDump(const std::string &path);
+
+    /// @brief start a frame - reads the results of the frame whose queries are reused, if the GPU has finished it
+    void beginFrame();
+
+    /// @brief end the frame (every scope opened in it must have been closed)
+    void endFrame();
+
+    /// @brief open a scope, nested in the scope currently open (if any)
+    /// @param name the name of the scope
+    void beginScope(const std::string &name);
+
+    /// @brief close the scope opened last
+    void endScope();
+
+    /// @brief get the timings of the last frame whose results were read
+    /// @return the timings (frameIndex is 0 and there are no scopes until a frame has been read)
+    const GPUFrameTimings &getLastFrame() const;
+
+    /// @brief get the rolling stats of the whole frame (its path and name are "Frame")
+    /// @return the stats
+    GPUScopeStats getFrameStats() const;
+
+    /// @brief get the rolling stats of each scope of the last frame read, in the order they were opened
+    /// @return the stats
+    std::vector<GPUScopeStats> getScopeStats() const;
+
+    /// @brief get the number of frames dropped because their results were not ready when their queries were reused
+    /// @return the number of frames
+    unsigned int getDroppedFrames() const;
+
+private:
+    /// @brief a scope recorded in a frame, waiting for its results
+    struct PendingScope
+    {
+        std::string path;
+        std::string name;
+        unsigned int depth;
+        /// @brief the indices of its start and end timestamp queries in the frame's queries
+        size_t beginQuery, endQuery;
+    };
+
+    /// @brief the queries of one frame in the ring
+    struct FrameQueries
+    {
+        unsigned int frameIndex;
+        /// @brief whether the frame was recorded and its results not yet read
+        bool pending;
+        /// @brief the timestamp queries, starting with the start of the frame (grown as needed, kept between frames)
+        std::vector<GLuint> timestampQuery_IDs;
+        size_t usedTimestamps;
+        /// @brief the index of the timestamp at the end of the frame
+        size_t endQuery;
+        std::vector<PendingScope> scopes;
+    };
+
+    /// @brief the last GPU_PROFILER_HISTORY samples of a scope
+    struct ScopeHistory
+    {
+        std::vector<float> samples;
+        /// @brief where the next sample goes once samples is full
+        size_t next;
+    };
+
+    /// @brief issue a timestamp query in the current frame
+    /// @return the index of the query in the frame's queries
+    size_t writeTimestamp();
+
+    /// @brief read a recorded frame's results if they are available
+    /// @param frame the frame
+    /// @return true if they were read (false if the GPU has not finished the frame)
+    bool resolve(FrameQueries &frame);
+
+    /// @brief add a sample to a scope's history
+    /// @param path the path of the scope
+    /// @param milliseconds the sample
+    void addSample(const std::string &path, float milliseconds);
+
+    /// @brief work out a scope's rolling stats from its history
+    /// @param path the path of the scope
+    /// @param name the name of the scope
+    /// @param depth the depth of the scope
+    /// @param last_milliseconds the scope's time in the last frame read
+    /// @return the stats
+    GPUScopeStats makeStats(const std::string &path, const std::string &name, unsigned int depth, float last_milliseconds) const;
+
+    /// @brief the ring of frames
+    std::vector<FrameQueries> frames;
+
+    /// @brief the index of the frame being recorded in the ring
+    unsigned int currentFrame;
+
+    /// @brief the number of frames begun
+    unsigned int frameCount;
+
+    /// @brief the indices of the open scopes in the current frame's scopes, outermost first
+    std::vector<size_t> openScopes;
+
+    /// @brief the timings of the last frame read
+    GPUFrameTimings lastFrame;
+
+    /// @brief the history of the whole frame and of each scope, by path
+    std::unordered_map<std::string, ScopeHistory> histories;
+
+    /// @brief the number of frames dropped
+    unsigned int droppedFrames;
+
+    /// @brief the CSV file every resolved frame is written to (if open)
+    std::ofstream dump;
+};
@@ -0,0 +1,136 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "rendering/assimp/mesh.h"
+#include "rendering/buffer/buffer/buffer.h"
+#include "rendering/buffer/ssbo/ssbo.h"
+#include "rendering/render_queue/render_queue.h"
+#include "rendering/uniform_blocks/uniform_blocks.h"
+#include "rendering/vao/vao.h"
+
+/// @brief the shader storage binding point of the per draw data read by indirect shaders (must match binding = ... in the shaders)
+const unsigned int INDIRECT_PER_DRAW_BINDING = 0;
+
+/// @brief the arguments of one draw in a GL_DRAW_INDIRECT_BUFFER, laid out as glMultiDrawElementsIndirect reads them
+struct DrawElementsIndirectCommand
+{
+    /// @brief the number of indices to draw
+    GLuint count;
+    /// @brief the number of instances to draw
+    GLuint instanceCount;
+    /// @brief the first index in the shared index buffer
+    GLuint firstIndex;
+    /// @brief added to each index to find the vertex in the shared vertex buffer
+    GLint baseVertex;
+    /// @brief the first instance (offsets instanced attributes)
+    GLuint baseInstance;
+};
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "DrawElementsIndirectCommand must be tightly packed");
+
+/// @brief where a mesh's vertices and indices are in the shared buffers
+struct SharedMeshRange
+{
+    /// @brief the first index of the mesh in the shared index buffer
+    GLuint firstIndex;
+    /// @brief the number of indices of the mesh
+    GLuint indexCount;
+    /// @brief the first vertex of the mesh in the shared vertex buffer
+    GLint baseVertex;
+};
+
+/// @brief how a frame was submitted by the indirect renderer
+struct IndirectRendererStats
+{
+    /// @brief the number of meshes drawn
+    unsigned int draws;
+    /// @brief the number of glMultiDrawElementsIndirect calls (one per shader and material)
+    unsigned int multiDrawCalls;
+    /// @brief the CPU time spent building, uploading and submitting the draws
+    float submitMilliseconds;
+};
+
+/// @brief draws a sorted render queue with one glMultiDrawElementsIndirect call per shader and material. Every mesh's vertices and indices are
+/// copied into one shared vertex and index buffer, so consecutive draws need no VAO switch. Each draw becomes a DrawElementsIndirectCommand, and
+/// its transforms go into an SSBO that the vertex shader indexes with the draw's position in the frame (drawOffset + gl_DrawIDARB).
+/// Requires OpenGL 4.3 and ARB_shader_draw_parameters
+class IndirectRenderer
+{
+public:
+    /// @brief constructor - requires a current context that isSupported()
+    IndirectRenderer();
+
+    // delete copy constructor
+    IndirectRenderer(IndirectRenderer const &) = delete;
+    // delete copy assignment
+    void operator=(IndirectRenderer const &) = delete;
+
+    /// @brief check if the current context supports indirect rendering (OpenGL 4.3 and ARB_shader_draw_parameters) - otherwise use RenderQueue::execute
+    /// @return true if supported
+    static bool isSupported();
+
+    /// @brief copy a mesh into the shared buffers (meshes are added on first draw otherwise, which re-uploads the shared buffers)
+    /// @param mesh the mesh - it must not move or be destroyed while this renderer exists
+    void addMesh(const Mesh &mesh);
+
+    /// @brief draw the sorted commands of a render queue - their shaders must read the per draw data (i.e. indirect_phong.vert)
+    /// @param render_queue the render queue (after sort())
+    void execute(const RenderQueue &render_queue);
+
+    /// @brief get the stats of the last execute
+    /// @return the stats
+    IndirectRendererStats getStats() const;
+
+private:
+    /// @brief a run of draws sharing a shader and material, submitted with one call
+    struct DrawGroup
+    {
+        Shader *shader;
+        Mesh *mesh;
+        size_t firstCommand;
+        size_t commandCount;
+    };
+
+    /// @brief get where a mesh is in the shared buffers, adding it if it is not there yet
+    /// @param mesh the mesh
+    /// @return the mesh's range
+    const SharedMeshRange &getRange(const Mesh &mesh);
+
+    /// @brief recreate the shared VAO from the CPU copies of every mesh added
+    void uploadGeometry();
+
+    /// @brief the VAO over the shared vertex and index buffers
+    std::unique_ptr<VAO> sharedVAO;
+
+    /// @brief the vertices of every mesh added, back to back
+    std::vector<Vertex> sharedVertices;
+
+    /// @brief the indices of every mesh added, back to back (relative to each mesh's base vertex)
+    std::vector<unsigned int> sharedIndices;
+
+    /// @brief where each mesh added is in the shared buffers
+    std::unordered_map<const Mesh *, SharedMeshRange> meshRanges;
+
+    /// @brief whether meshes have been added since the shared buffers were last uploaded
+    bool geometryDirty;
+
+    /// @brief the draw arguments of this frame
+    std::vector<DrawElementsIndirectCommand> commands;
+
+    /// @brief the transforms of each draw this frame (laid out the same in std430 as in std140)
+    std::vector<PerObjectBlock> drawData;
+
+    /// @brief the runs of draws sharing a shader and material this frame
+    std::vector<DrawGroup> groups;
+
+    /// @brief the GL_DRAW_INDIRECT_BUFFER the commands are uploaded to
+    Buffer indirectBuffer;
+
+    /// @brief the SSBO the per draw data is uploaded to
+    SSBO drawDataBuffer;
+
+    /// @brief the stats of the last execute
+    IndirectRendererStats stats;
+};
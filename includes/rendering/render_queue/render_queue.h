@@ -0,0 +1,166 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "rendering/assimp/mesh.h"
+#include "rendering/shader/shader.h"
+#include "rendering/uniform_blocks/uniform_blocks.h"
+#include "rendering/buffer/dynamic_buffer/dynamic_buffer.h"
+
+/// @brief the passes a frame is drawn in - lower passes are drawn first
+enum class RENDER_PASS
+{
+    OPAQUE = 0,
+    TRANSPARENT = 1
+};
+
+// the bit layout of a sort key, from most to least significant: pass | shader | material | VAO | depth
+const unsigned int SORT_KEY_DEPTH_BITS = 24;
+const unsigned int SORT_KEY_VAO_BITS = 12;
+const unsigned int SORT_KEY_MATERIAL_BITS = 14;
+const unsigned int SORT_KEY_SHADER_BITS = 12;
+const unsigned int SORT_KEY_PASS_BITS = 2;
+
+/// @brief one mesh to draw, with everything needed to draw it - kept small so sorting moves little memory
+struct RenderCommand
+{
+    /// @brief the key the command is sorted by
+    uint64_t sortKey;
+    /// @brief the mesh to draw
+    Mesh *mesh;
+    /// @brief the shader to draw it with
+    Shader *shader;
+    /// @brief the index of the draw's per object data (model and normal matrices, packed when submitted) in its queue
+    uint32_t objectIndex;
+};
+
+/// @brief how many draws and state changes the queue issued in a frame
+struct RenderQueueStats
+{
+    unsigned int draws;
+    unsigned int programSwitches;
+    unsigned int vaoSwitches;
+    unsigned int materialSwitches;
+    unsigned int textureSwitches;
+};
+
+/// @brief the commands recorded by one thread in a parallel build, merged into their queue once every thread is done
+class RenderCommandBuffer
+{
+public:
+    /// @brief constructor
+    /// @param max_depth the furthest view depth of the queue the buffer is merged into
+    RenderCommandBuffer(float max_depth);
+
+    /// @brief add a mesh to draw this frame (as RenderQueue::submit)
+    /// @param mesh the mesh
+    /// @param shader the shader to draw it with
+    /// @param model the model matrix to draw it with
+    /// @param pass the pass to draw it in
+    /// @param view_depth the distance of the mesh in front of the camera
+    void submit(Mesh &mesh, Shader &shader, const glm::mat4 &model, RENDER_PASS pass, float view_depth);
+
+    /// @brief remove every recorded command
+    void clear();
+
+    /// @brief get the number of commands recorded
+    /// @return the number of commands
+    size_t getCommandCount() const;
+
+private:
+    friend class RenderQueue;
+
+    /// @brief the furthest view depth
+    float maxDepth;
+
+    /// @brief the commands recorded (their sort keys lack the material id, which is given out when they are merged)
+    std::vector<RenderCommand> commands;
+
+    /// @brief the per object data of the commands (indexed from 0 until they are merged)
+    std::vector<PerObjectBlock> objectData;
+};
+
+/// @brief collects the meshes to draw in a frame, sorts them by a packed 64 bit key so that draws sharing state are adjacent, then draws
+/// them changing only the state that differs from the previous draw. Each draw's uniform data is packed when it is submitted, which can be
+/// spread over several threads through command buffers, so drawing only copies it
+class RenderQueue
+{
+public:
+    /// @brief constructor
+    /// @param max_depth the furthest view depth (i.e. the far plane) - depths are quantised over [0, max_depth]
+    RenderQueue(float max_depth);
+
+    /// @brief add a mesh to draw this frame
+    /// @param mesh the mesh
+    /// @param shader the shader to draw it with
+    /// @param model the model matrix to draw it with
+    /// @param pass the pass to draw it in
+    /// @param view_depth the distance of the mesh in front of the camera (opaque draws are sorted front to back, transparent back to front)
+    void submit(Mesh &mesh, Shader &shader, const glm::mat4 &model, RENDER_PASS pass, float view_depth);
+
+    /// @brief get command buffers to fill from several threads at once - each thread records into its own buffer, then
+    /// mergeCommandBuffers() appends them to the queue in order (so the result does not depend on which thread finished first)
+    /// @param count the number of buffers
+    /// @return the buffers, emptied
+    std::vector<RenderCommandBuffer> &getCommandBuffers(size_t count);
+
+    /// @brief append the commands of every command buffer to the queue, in buffer order
+    void mergeCommandBuffers();
+
+    /// @brief sort the submitted commands by their keys (radix sort)
+    void sort();
+
+    /// @brief draw the sorted commands with the minimum state changes
+    /// @param per_object_block the uniform block each command's model matrix is uploaded to
+    /// @param per_object_ring a ring each command's block is written to instead, between its beginFrame() and endFrame() (or nullptr) - the
+    /// uniform block is only used once the ring is full
+    void execute(UniformBlock<PerObjectBlock> &per_object_block, DynamicBuffer *per_object_ring = nullptr);
+
+    /// @brief remove every submitted command - call at the start of each frame
+    void clear();
+
+    /// @brief get the stats of the last execute
+    /// @return the stats
+    RenderQueueStats getStats() const;
+
+    /// @brief get the number of commands submitted
+    /// @return the number of commands
+    size_t getCommandCount() const;
+
+    /// @brief get the submitted commands (in key order after sort())
+    /// @return the commands
+    const std::vector<RenderCommand> &getCommands() const;
+
+    /// @brief get the per object data of the submitted commands (indexed by RenderCommand::objectIndex)
+    /// @return the per object data
+    const std::vector<PerObjectBlock> &getObjectData() const;
+
+private:
+
+    /// @brief turn a 64 bit material key into a small id that fits in the sort key (ids are stable for the lifetime of the queue)
+    /// @param material_key the material key of a mesh
+    /// @return the material id
+    uint32_t getMaterialID(uint64_t material_key);
+
+    /// @brief the furthest view depth
+    float maxDepth;
+
+    /// @brief the commands submitted this frame
+    std::vector<RenderCommand> commands;
+
+    /// @brief the per object data of the commands submitted this frame
+    std::vector<PerObjectBlock> objectData;
+
+    /// @brief the buffers of the last parallel build (kept so their allocations are reused)
+    std::vector<RenderCommandBuffer> commandBuffers;
+
+    /// @brief scratch space for the radix sort
+    std::vector<RenderCommand> sortBuffer;
+
+    /// @brief the small id of each material key seen
+    std::unordered_map<uint64_t, uint32_t> materialIDs;
+
+    /// @brief the stats of the last execute
+    RenderQueueStats stats;
+};
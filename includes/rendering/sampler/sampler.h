@@ -0,0 +1,112 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include "rendering/texture/texture.h"
+
+/// @brief encapsulates an OpenGL sampler object: the filtering/wrapping state used when sampling a texture
+class Sampler
+{
+public:
+    /// @brief constructor - creates the sampler object in OpenGL
+    /// @param params the sampler parameters (i.e. GL_TEXTURE_WRAP_S = GL_REPEAT)
+    Sampler(const std::vector<TextureParam> &params);
+
+    /// @brief the move constructor for sampler (e.g. Sampler(std::move(oldSampler)))
+    /// @param other the old sampler to be moved into this one
+    Sampler(Sampler &&other);
+
+    /// @brief the move assignment for sampler (e.g. sampler1 = std::move(sampler2))
+    /// @param other the old sampler
+    Sampler &operator=(Sampler &&other) noexcept;
+
+    /// @brief prevents copy constructor from lvalues
+    Sampler(const Sampler &) = delete;
+
+    /// @brief prevents copy assignment from lvalues
+    Sampler &operator=(const Sampler &) = delete;
+
+    /// @brief destructor - deletes the sampler object from OpenGL
+    ~Sampler();
+
+    /// @brief bind this sampler to a texture unit
+    /// @param texture_unit the texture unit index (i.e. 0 for GL_TEXTURE0)
+    void bind(unsigned int texture_unit) const;
+
+    /// @brief (re)apply the sampler parameters, with the global quality settings applied on top
+    /// @param anisotropy the anisotropic filtering level (1 disables anisotropic filtering)
+    /// @param trilinear if false, mipmapped minification filters blend within a single mip level rather than between two
+    void applyParams(float anisotropy, bool trilinear);
+
+    /// @brief get the parameters this sampler was created with
+    /// @return the sampler parameters
+    const std::vector<TextureParam> &getParams() const;
+
+    /// @brief get the id of this sampler
+    /// @return the id of the sampler object in OpenGL
+    unsigned int getID() const;
+
+private:
+    /// @brief the id of the sampler object in OpenGL
+    unsigned int sampler_ID;
+
+    /// @brief the parameters this sampler was created with
+    std::vector<TextureParam> params;
+};
+
+/// @brief shares one sampler object between all textures that use the same parameters, and applies global filtering quality settings
+class SamplerCache
+{
+public:
+    /// @brief get the shared sampler for a set of parameters, creating it if needed
+    /// @param params the sampler parameters
+    /// @return the shared sampler
+    static std::shared_ptr<Sampler> getSampler(const std::vector<TextureParam> &params);
+
+    /// @brief set the anisotropic filtering level of every sampler (clamped to what the hardware supports)
+    /// @param anisotropy the anisotropy level (1 disables anisotropic filtering)
+    static void setAnisotropy(float anisotropy);
+
+    /// @brief get the anisotropic filtering level applied to samplers
+    /// @return the anisotropy level
+    static float getAnisotropy();
+
+    /// @brief enable or disable trilinear filtering (blending between mip levels) on every sampler
+    /// @param trilinear if trilinear filtering should be used
+    static void setTrilinearFiltering(bool trilinear);
+
+    /// @brief check if trilinear filtering is applied to samplers
+    /// @return true if trilinear filtering is used
+    static bool getTrilinearFiltering();
+
+    /// @brief get the number of distinct sampler objects
+    /// @return the number of samplers
+    static size_t getSamplerCount();
+
+    // delete copy constructor
+    SamplerCache(SamplerCache const &) = delete;
+    // delete copy assignment
+    void operator=(SamplerCache const &) = delete;
+
+private:
+    /// @brief constructor (private because singleton)
+    SamplerCache();
+
+    static SamplerCache &getInstance();
+
+    /// @brief hash a set of sampler parameters (order independent)
+    /// @param params the parameters to hash
+    /// @return the hash of the parameters
+    static uint64_t hashParams(const std::vector<TextureParam> &params);
+
+    /// @brief a map of parameter hash to the samplers with those parameters
+    std::unordered_map<uint64_t, std::vector<std::shared_ptr<Sampler>>> paramsToSampler;
+
+    /// @brief the anisotropy applied to all samplers
+    float anisotropy;
+
+    /// @brief if trilinear filtering is applied to all samplers
+    bool trilinear;
+};
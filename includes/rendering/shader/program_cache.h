@@ -0,0 +1,93 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+
+/// @brief the default directory linked program binaries are cached in
+const std::string DEFAULT_PROGRAM_CACHE_DIRECTORY = "shader_cache";
+
+/// @brief how long it took to get shader programs ready at startup
+struct ShaderStartupStats
+{
+    /// @brief the number of programs compiled and linked from source
+    unsigned int programsCompiled;
+    /// @brief the number of programs loaded from a cached binary
+    unsigned int programsLoadedFromCache;
+    /// @brief the number of cached binaries the driver rejected (i.e. after a driver update)
+    unsigned int binariesRejected;
+    /// @brief the total time the calling thread spent compiling and linking programs from source (time the driver spent
+    /// building in the background while the caller did other work is not counted)
+    double compileMilliseconds;
+    /// @brief the total time spent loading programs from cached binaries
+    double cacheLoadMilliseconds;
+};
+
+/// @brief an on-disk cache of linked shader program binaries (glGetProgramBinary/glProgramBinary) so programs need not be compiled on every launch
+class ProgramCache
+{
+public:
+    /// @brief check if the context can save and load program binaries (OpenGL 4.1 or ARB_get_program_binary, with at least one binary format)
+    /// @return true if programs can be cached
+    static bool isSupported();
+
+    /// @brief build the cache key of a program - binaries are only valid for the exact same sources on the exact same driver
+    /// @param vertex_source the vertex shader source code
+    /// @param fragment_source the fragment shader source code
+    /// @param defines any defines injected into the sources
+    /// @return the key of the program
+    static uint64_t makeKey(const std::string &vertex_source, const std::string &fragment_source, const std::string &defines);
+
+    /// @brief try to create a program from its cached binary
+    /// @param key the key of the program
+    /// @return the id of the linked program, or 0 if there is no cached binary or the driver rejected it
+    static unsigned int loadProgram(uint64_t key);
+
+    /// @brief save the binary of a linked program to the cache (the program must be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT)
+    /// @param key the key of the program
+    /// @param program_id the id of the linked program
+    static void storeProgram(uint64_t key, unsigned int program_id);
+
+    /// @brief record how long a program took to compile and link from source
+    /// @param milliseconds the time taken
+    static void recordCompile(double milliseconds);
+
+    /// @brief record how long a program took to load from the cache
+    /// @param milliseconds the time taken
+    static void recordCacheHit(double milliseconds);
+
+    /// @brief set the directory binaries are cached in
+    /// @param directory the cache directory
+    static void setCacheDirectory(const std::string &directory);
+
+    /// @brief get how long shader programs have taken to get ready
+    /// @return the startup stats
+    static ShaderStartupStats getStartupStats();
+
+    // delete copy constructor
+    ProgramCache(ProgramCache const &) = delete;
+    // delete copy assignment
+    void operator=(ProgramCache const &) = delete;
+
+private:
+    /// @brief constructor (private because singleton) - requires a current context to identify the driver
+    ProgramCache();
+
+    static ProgramCache &getInstance();
+
+    /// @brief get the path of the cached binary for a key
+    /// @param key the key of the program
+    /// @return the path of the binary file
+    static std::string getBinaryPath(uint64_t key);
+
+    /// @brief the hash of the driver vendor, renderer and version strings
+    uint64_t driverHash;
+
+    /// @brief if the context supports program binaries
+    bool supported;
+
+    /// @brief the directory binaries are cached in
+    std::string cacheDirectory;
+
+    /// @brief the stats recorded so far
+    ShaderStartupStats stats;
+};
@@ -3,10 +3,66 @@
 #include <glad/glad.h>
 
 #include <string>
+#include <cstdint>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
 #include "glm/glm.hpp"
+#include "rendering/shader/shader_permutation.h"
+#include "rendering/vertex/vertex_description.h"
+#include <vector>
+
+/// @brief a precomputed reference to a uniform in a shader program - setting a uniform through a handle needs no string hashing or GL queries
+struct UniformHandle
+{
+    /// @brief the location of the uniform in the shader program (-1 if the uniform does not exist)
+    GLint location = -1;
+
+    /// @brief check if the handle refers to an active uniform
+    /// @return true if the uniform exists in the shader program
+    bool isValid() const { return location != -1; }
+};
+
+/// @brief an active vertex attribute of a linked shader program, as reported by glGetActiveAttrib
+struct ShaderAttribute
+{
+    /// @brief the name of the attribute (i.e. aPos)
+    std::string name;
+    /// @brief the location of the attribute
+    GLint location;
+    /// @brief the GLSL type of the attribute (i.e. GL_FLOAT_VEC3)
+    GLenum type;
+    /// @brief the array size of the attribute (1 if it is not an array)
+    GLint size;
+};
+
+/// @brief the number of uniform uploads issued to OpenGL vs skipped because the value had not changed
+struct UniformUploadStats
+{
+    /// @brief the number of glUniform* calls made
+    unsigned int issued;
+    /// @brief the number of glUniform* calls skipped as redundant
+    unsigned int skipped;
+};
+
+/// @brief the last value uploaded to a uniform (large enough for a mat4)
+struct UniformShadow
+{
+    /// @brief the raw bytes of the value
+    unsigned char data[sizeof(glm::mat4)];
+    /// @brief the size of the value in bytes (0 if nothing has been uploaded)
+    unsigned char size = 0;
+};
+
+/// @brief when a shader program's build is finished
+enum class SHADER_BUILD
+{
+    /// @brief wait for the compile and link in the constructor
+    IMMEDIATE,
+    /// @brief only submit the compile and link - the build is finished by finishBuild() or the first use()
+    DEFERRED
+};
 
 class Shader
 {
@@ -18,6 +74,20 @@ public:
     // constructer that reads shader code and builds the shader program
     Shader(const char *vertex_shader_path, const char *fragment_shader_path);
 
+    /// @brief constructor that reads shader code, injects the permutation's defines after #version and builds the shader program
+    /// @param vertex_shader_path the location of the vertex shader file
+    /// @param fragment_shader_path the location of the fragment shader file
+    /// @param permutation the features and defines of this variant
+    Shader(const char *vertex_shader_path, const char *fragment_shader_path, const ShaderPermutation &permutation);
+
+    /// @brief constructor that reads shader code, injects the permutation's defines and submits the build - a deferred build lets the driver
+    /// compile many programs in parallel (GL_KHR_parallel_shader_compile) while the caller keeps working
+    /// @param vertex_shader_path the location of the vertex shader file
+    /// @param fragment_shader_path the location of the fragment shader file
+    /// @param permutation the features and defines of this variant
+    /// @param build when the build is finished
+    Shader(const char *vertex_shader_path, const char *fragment_shader_path, const ShaderPermutation &permutation, SHADER_BUILD build);
+
     /// @brief the move constructor for shader - used when we want to transfer ownership of the shader data between variables (copy constructor for rvalues) (e.g. shader(std::move(oldShader)))
     /// @param other the old shader to be moved into this one
     Shader(Shader &&other);
@@ -35,9 +105,20 @@ public:
     // destructor that destroys shader program in OpenGL
     ~Shader();
 
-    /// @brief tell OpenGL to use this shader
+    /// @brief tell OpenGL to use this shader (finishing its build first if it is still pending)
     void use();
 
+    /// @brief check if the build of this shader program can be finished without waiting (always true without GL_KHR_parallel_shader_compile)
+    /// @return true if the build is complete
+    bool isBuildComplete() const;
+
+    /// @brief check if the shader program built successfully
+    /// @return true if the build is finished and the program linked
+    bool isLinked() const;
+
+    /// @brief wait for a deferred build to finish, then check it for errors and prepare the program for use
+    void finishBuild();
+
     /// @brief set the value of a uniform in the shader program
     /// @param uniform_name
     /// @param value
@@ -70,19 +151,156 @@ public:
     /// @param value
     void setUniform(const std::string &uniform_name, const glm::vec3 value) const;
 
+    /// @brief get a number that uniquely identifies this build of the shader program (never reused, unlike program ids)
+    /// @return the revision - cached uniform handles are only valid for the revision they were fetched with
+    unsigned int getRevision() const;
+
+    /// @brief get a handle to a uniform that can be used to set it without any lookups
+    /// @param uniform_name the name of the uniform (i.e. material.shininess or pointLights[0].position)
+    /// @return the handle - invalid if the program has no active uniform with this name
+    UniformHandle getUniformHandle(const std::string &uniform_name) const;
+
+    /// @brief set the value of a uniform in the shader program
+    /// @param handle the handle of the uniform
+    /// @param value
+    void setUniform(UniformHandle handle, bool value) const;
+
+    /// @brief set the value of a uniform in the shader program
+    /// @param handle the handle of the uniform
+    /// @param value
+    void setUniform(UniformHandle handle, int value) const;
+
+    /// @brief set the value of a uniform in the shader program
+    /// @param handle the handle of the uniform
+    /// @param value
+    void setUniform(UniformHandle handle, float value) const;
+
+    /// @brief set the value of a uniform in the shader program
+    /// @param handle the handle of the uniform
+    /// @param value
+    void setUniform(UniformHandle handle, unsigned int count, bool transpose, const glm::mat4 &value) const;
+
+    /// @brief set the value of a uniform in the shader program
+    /// @param handle the handle of the uniform
+    /// @param value
+    void setUniform(UniformHandle handle, unsigned int count, bool transpose, const glm::mat3 &value) const;
+
+    /// @brief set the value of a uniform in the shader program
+    /// @param handle the handle of the uniform
+    /// @param value
+    void setUniform(UniformHandle handle, const glm::vec3 &value) const;
+
+    /// @brief get the active vertex attributes of the linked shader program
+    /// @return the active attributes
+    const std::vector<ShaderAttribute> &getAttributes() const;
+
+    /// @brief check that a vertex struct provides every attribute the shader reads, at the right location and with a compatible type - mismatches are logged
+    /// (the result for the last description checked is remembered, so calling this for every draw is cheap)
+    /// @param description the description of the vertex struct
+    /// @return true if the vertex struct matches the shader
+    bool validateVertexLayout(const VertexDescription &description) const;
+
+    /// @brief get the number of uniform uploads issued and skipped (across all shaders) since the last reset
+    /// @return the upload stats
+    static UniformUploadStats getUploadStats();
+
+    /// @brief reset the uniform upload counters - call once per frame
+    static void resetUploadStats();
+
 private:
-    /// @brief load a shader file and return its source code
+    /// @brief uniquely identifies this build of the shader program
+    unsigned int revision;
+
+    /// @brief the next revision to hand out to a newly built shader program
+    static unsigned int nextRevision;
+
+    /// @brief a map of uniform name to its location in the shader program, built once after linking
+    std::unordered_map<std::string, GLint> uniformLocations;
+
+    /// @brief if the program was submitted to the driver but its build has not been finished yet
+    bool buildPending;
+
+    /// @brief the id of the vertex shader object while the build is pending (0 otherwise)
+    unsigned int pendingVertexShader_ID;
+
+    /// @brief the id of the fragment shader object while the build is pending (0 otherwise)
+    unsigned int pendingFragmentShader_ID;
+
+    /// @brief the key of this program in the program binary cache
+    uint64_t cacheKey;
+
+    /// @brief the time spent on the calling thread building this program (excludes time spent building in the background)
+    double buildMilliseconds;
+
+    /// @brief the active vertex attributes of the shader program, read once after linking
+    std::vector<ShaderAttribute> attributes;
+
+    /// @brief the vertex description last checked by validateVertexLayout (nullptr if none)
+    mutable const VertexDescription *validatedDescription;
+
+    /// @brief if the vertex description last checked matched the shader
+    mutable bool validatedResult;
+
+    /// @brief the last value uploaded to each uniform location, so unchanged values are not uploaded again
+    mutable std::unordered_map<GLint, UniformShadow> uniformShadows;
+
+    /// @brief the uniform uploads issued and skipped since the last reset
+    static UniformUploadStats uploadStats;
+
+    /// @brief compare a value with the last value uploaded to a uniform and record it if it changed
+    /// @param location the location of the uniform
+    /// @param value the new value
+    /// @param size the size of the value in bytes (at most sizeof(glm::mat4))
+    /// @return true if the value changed and must be uploaded
+    bool updateShadow(GLint location, const void *value, size_t size) const;
+
+    /// @brief forget the last value of a uniform (for uploads the shadow cannot hold)
+    /// @param location the location of the uniform
+    void forgetShadow(GLint location) const;
+
+    /// @brief query the active uniforms of the linked shader program and store their locations
+    void introspectUniforms();
+
+    /// @brief query the active vertex attributes of the linked shader program and store them
+    void introspectAttributes();
+
+    /// @brief bind every engine uniform block used by the linked shader program to its fixed binding point
+    void bindUniformBlocks();
+
+    /// @brief look up the location of a uniform in the cached uniform locations
+    /// @param uniform_name the name of the uniform
+    /// @return the location of the uniform, or -1 if it is not an active uniform
+    GLint getUniformLocation(const std::string &uniform_name) const;
+
+    /// @brief load a shader file and return its source code with every #include expanded
     /// @param shader_path the location of the shader file
     /// @return the source code of the shader file
     static std::string loadShaderFile(const char *shader_path);
 
-    /// @brief compiles shader source code and creates a shader object in OpenGL
+    /// @brief check if the shaders compiled and the program linked, logging any errors - waits for a pending build
+    /// @param shaderProgram_id the id of the shader program in OpenGL
+    /// @param vertexShader_id the id of the vertex shader in OpenGL
+    /// @param fragmentShader_id the id of the fragment shader in OpenGL
+    /// @return true if the program linked
+    static bool checkBuildStatus(unsigned int shaderProgram_id, unsigned int vertexShader_id, unsigned int fragmentShader_id);
+
+    /// @brief check if the driver can build programs in the background (GL_KHR_parallel_shader_compile), enabling it on first use
+    /// @return true if parallel compilation is supported
+    static bool hasParallelCompile();
+
+    /// @brief submits shader source code to be compiled into a new shader object in OpenGL (the compile status is not checked)
     /// @param shader_code the shader source code to be compiled
     /// @param shader_type the type of shader: i.e. GL_VERTEX_SHADER
     /// @return the identifier of the shader object in OpenGL
     static unsigned int compileShader(const char *shader_code, GLenum shader_type);
 
-    /// @brief create a shader program in OpenGL, using the vertex and fragment shader objects
+    /// @brief insert a block of defines into shader source code directly after its #version line
+    /// @param shader_code the shader source code
+    /// @param define_block the #define lines to insert
+    /// @return the shader source code with the defines
+    static std::string injectDefines(const std::string &shader_code, const std::string &define_block);
+
+    /// @brief create a shader program in OpenGL and submit it to be linked, using the vertex and fragment shader objects (the link status is not checked)
     /// @param vertexShader_id the id of the vertex shader in OpenGL
     /// @param fragmentShader_id the id of the fragment shader in OpenGL
     /// @return the id of the shader object in OpenGL
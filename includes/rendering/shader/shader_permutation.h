@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <set>
+#include <map>
+
+/// @brief the feature key for sampling a diffuse map (material.texture_diffuse0)
+const std::string SHADER_FEATURE_DIFFUSE_MAP = "DIFFUSE_MAP";
+
+/// @brief the feature key for sampling a specular map (material.texture_specular0)
+const std::string SHADER_FEATURE_SPECULAR_MAP = "SPECULAR_MAP";
+
+/// @brief a set of feature keys and defines selecting one variant of a shader - each feature becomes a #define injected after #version
+class ShaderPermutation
+{
+public:
+    /// @brief constructor - the permutation with no features or defines
+    ShaderPermutation();
+
+    /// @brief enable a feature (i.e. SHADER_FEATURE_SPECULAR_MAP)
+    /// @param feature the feature key, defined without a value in the shader source
+    /// @return this, for chaining
+    ShaderPermutation &addFeature(const std::string &feature);
+
+    /// @brief set a define with a value (i.e. NR_POINT_LIGHTS 8)
+    /// @param name the name of the define
+    /// @param value the value of the define
+    /// @return this, for chaining
+    ShaderPermutation &setDefine(const std::string &name, const std::string &value);
+
+    /// @brief check if a feature is enabled
+    /// @param feature the feature key
+    /// @return true if the feature is enabled
+    bool hasFeature(const std::string &feature) const;
+
+    /// @brief combine this permutation with another - the other's defines take priority
+    /// @param other the permutation to combine with
+    /// @return the combined permutation
+    ShaderPermutation combine(const ShaderPermutation &other) const;
+
+    /// @brief get the #define lines to inject into the shader source (in a stable order)
+    /// @return the define block
+    std::string getDefineBlock() const;
+
+    /// @brief get the key identifying this permutation (equal permutations have equal keys)
+    /// @return the key
+    uint64_t getKey() const;
+
+    bool operator==(const ShaderPermutation &other) const;
+
+private:
+    /// @brief the enabled feature keys
+    std::set<std::string> features;
+
+    /// @brief the defines with values, by name
+    std::map<std::string, std::string> defines;
+};
@@ -0,0 +1,90 @@
+#pragma once
+#include <filesystem>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// @brief a piece of a parsed shader file - either plain source text or an #include directive
+struct ShaderSourceChunk
+{
+    /// @brief the source text (empty for an include)
+    std::string text;
+
+    /// @brief the normalised path of the included file (empty for plain text)
+    std::string includePath;
+
+    /// @brief the line number in the including file directly after the #include
+    unsigned int lineAfterInclude;
+};
+
+/// @brief a shader file split into text and #include chunks
+struct ParsedShaderSource
+{
+    /// @brief the chunks of the file in order
+    std::vector<ShaderSourceChunk> chunks;
+
+    /// @brief the time the file was last written when it was parsed
+    std::filesystem::file_time_type writeTime;
+};
+
+/// @brief reads and parses each shader file once per process, expands #include "file" directives (each file is included at most once per
+/// shader stage) and tracks which files include which, so an edited file can be traced to exactly the shaders that need rebuilding
+class ShaderSourceCache
+{
+public:
+    /// @brief get the source of a shader file with every #include expanded
+    /// @param shader_path the location of the shader file
+    /// @return the expanded source code
+    static std::string getSource(const std::string &shader_path);
+
+    /// @brief re-parse every cached file that changed on disk since it was parsed
+    /// @return the normalised paths of the changed files and of every file that (directly or indirectly) includes them
+    static std::set<std::string> pollChanges();
+
+    /// @brief get every file that directly or indirectly includes a file
+    /// @param shader_path the location of the included file
+    /// @return the normalised paths of the including files
+    static std::set<std::string> getDependents(const std::string &shader_path);
+
+    /// @brief normalise a shader path so the same file always has the same key
+    /// @param shader_path the location of a shader file
+    /// @return the normalised path
+    static std::string normalisePath(const std::string &shader_path);
+
+    /// @brief get the number of files parsed and cached
+    /// @return the number of files
+    static size_t getParsedFileCount();
+
+    // delete copy constructor
+    ShaderSourceCache(ShaderSourceCache const &) = delete;
+    // delete copy assignment
+    void operator=(ShaderSourceCache const &) = delete;
+
+private:
+    /// @brief constructor (private because singleton)
+    ShaderSourceCache();
+
+    static ShaderSourceCache &getInstance();
+
+    /// @brief get the parsed form of a file, parsing it if it has not been parsed yet
+    /// @param path the normalised path of the file
+    /// @return the parsed file
+    const ParsedShaderSource &getParsed(const std::string &path);
+
+    /// @brief read and parse a file and record its includes in the dependency graph
+    /// @param path the normalised path of the file
+    void parseFile(const std::string &path);
+
+    /// @brief append the expanded source of a file
+    /// @param path the normalised path of the file
+    /// @param included the files already expanded into this source, in order (each is only expanded once)
+    /// @param output the source to append to
+    void expand(const std::string &path, std::vector<std::string> &included, std::string &output);
+
+    /// @brief the parsed files, by normalised path
+    std::unordered_map<std::string, ParsedShaderSource> pathToSource;
+
+    /// @brief the dependency graph - for each file, the files that directly include it
+    std::unordered_map<std::string, std::set<std::string>> includedBy;
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "rendering/shader/shader.h"
+#include "rendering/shader/shader_permutation.h"
+
+/// @brief every variant of one vertex/fragment shader pair, built on first use (or up front) and cached by permutation key
+class ShaderVariants
+{
+public:
+    /// @brief constructor - no variants are built until they are requested
+    /// @param vertex_shader_path the location of the vertex shader file
+    /// @param fragment_shader_path the location of the fragment shader file
+    /// @param base_permutation the features and defines shared by every variant (i.e. NR_POINT_LIGHTS)
+    ShaderVariants(const std::string &vertex_shader_path, const std::string &fragment_shader_path, const ShaderPermutation &base_permutation = ShaderPermutation());
+
+    /// @brief delete the copy constructor
+    ShaderVariants(const ShaderVariants &) = delete;
+
+    /// @brief delete the copy assignment operator
+    ShaderVariants &operator=(const ShaderVariants &) = delete;
+
+    /// @brief get the variant for a permutation, building it if it has not been built yet (or finishing its build if it was submitted)
+    /// @param permutation the features and defines of the variant (combined with the base permutation)
+    /// @return the variant
+    Shader &getVariant(const ShaderPermutation &permutation);
+
+    /// @brief submit the builds of the variants for a set of permutations without waiting for them - every compile and link is
+    /// issued before any status is queried so the driver can build them in parallel while the caller keeps loading
+    /// @param permutations the permutations to build
+    void submit(const std::vector<ShaderPermutation> &permutations);
+
+    /// @brief check if every submitted build can be finished without waiting
+    /// @return true if all builds are complete
+    bool isBuildComplete() const;
+
+    /// @brief wait for every submitted build to finish
+    void finishBuilds();
+
+    /// @brief build the variants for a set of permutations now (as one parallel batch), so they do not stall a later frame
+    /// @param permutations the permutations to build
+    void precompile(const std::vector<ShaderPermutation> &permutations);
+
+    /// @brief rebuild every variant if its vertex or fragment shader is affected by changed files (i.e. from ShaderSourceCache::pollChanges) -
+    /// a variant that fails to build keeps its previous program, so a typo while editing does not break rendering
+    /// @param affected_files the normalised paths of every changed file and every file including them
+    /// @return the number of variants rebuilt
+    unsigned int reload(const std::set<std::string> &affected_files);
+
+    /// @brief get the number of variants built
+    /// @return the number of variants
+    size_t getVariantCount() const;
+
+private:
+    /// @brief create the variant for a full permutation and store it
+    /// @param full_permutation the base permutation combined with the variant's permutation
+    /// @param build when the variant's build is finished
+    /// @return the variant
+    Shader &createVariant(const ShaderPermutation &full_permutation, SHADER_BUILD build);
+
+    /// @brief the location of the vertex shader file
+    std::string vertexShaderPath;
+
+    /// @brief the location of the fragment shader file
+    std::string fragmentShaderPath;
+
+    /// @brief the features and defines shared by every variant
+    ShaderPermutation basePermutation;
+
+    /// @brief the built variants, by the key of their full permutation
+    std::unordered_map<uint64_t, std::unique_ptr<Shader>> variants;
+
+    /// @brief the full permutation of each variant, by key (needed to rebuild it)
+    std::unordered_map<uint64_t, ShaderPermutation> permutations;
+};
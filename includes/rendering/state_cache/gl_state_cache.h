@@ -0,0 +1,130 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <unordered_map>
+
+/// @brief the number of binding calls passed on to OpenGL vs dropped because they would not have changed anything
+struct GLStateStats
+{
+    /// @brief the number of binding calls made
+    unsigned int issued;
+    /// @brief the number of binding calls skipped as redundant
+    unsigned int skipped;
+};
+
+/// @brief shadows the OpenGL binding state so binds that would change nothing are never sent to the driver - every wrapper binds through
+/// this rather than calling OpenGL directly
+class GLStateCache
+{
+public:
+    /// @brief make a program current (glUseProgram)
+    /// @param program_id the program
+    static void useProgram(GLuint program_id);
+
+    /// @brief bind a vertex array object (glBindVertexArray)
+    /// @param vao_id the VAO
+    static void bindVertexArray(GLuint vao_id);
+
+    /// @brief bind a buffer to a target (glBindBuffer) - element array buffers are tracked per VAO, as OpenGL stores them in the VAO
+    /// @param target the target (i.e. GL_ARRAY_BUFFER)
+    /// @param buffer_id the buffer
+    static void bindBuffer(GLenum target, GLuint buffer_id);
+
+    /// @brief bind a buffer to an indexed binding point (glBindBufferBase) - this also binds it to the generic target
+    /// @param target the target (i.e. GL_UNIFORM_BUFFER)
+    /// @param index the binding point
+    /// @param buffer_id the buffer
+    static void bindBufferBase(GLenum target, GLuint index, GLuint buffer_id);
+
+    /// @brief bind part of a buffer to an indexed binding point (glBindBufferRange) - always issued, as ranges usually change every call
+    /// @param target the target (i.e. GL_UNIFORM_BUFFER)
+    /// @param index the binding point
+    /// @param buffer_id the buffer
+    /// @param offset the start of the range in bytes
+    /// @param size the size of the range in bytes
+    static void bindBufferRange(GLenum target, GLuint index, GLuint buffer_id, GLintptr offset, GLsizeiptr size);
+
+    /// @brief make a texture unit active (glActiveTexture) - only needed before editing a bound texture, bindTexture() activates units itself
+    /// @param unit the texture unit (i.e. GL_TEXTURE0)
+    static void activeTexture(GLenum unit);
+
+    /// @brief bind a texture to a texture unit (glActiveTexture + glBindTexture) - the unit is only made active if the binding changes
+    /// @param unit the texture unit (i.e. GL_TEXTURE0)
+    /// @param target the texture target (i.e. GL_TEXTURE_2D)
+    /// @param texture_id the texture
+    static void bindTexture(GLenum unit, GLenum target, GLuint texture_id);
+
+    /// @brief bind a sampler to a texture unit (glBindSampler)
+    /// @param unit the index of the texture unit (i.e. 0 for GL_TEXTURE0)
+    /// @param sampler_id the sampler
+    static void bindSampler(GLuint unit, GLuint sampler_id);
+
+    /// @brief forget a program that is about to be deleted (OpenGL may hand its id out again)
+    static void forgetProgram(GLuint program_id);
+
+    /// @brief forget a VAO that is about to be deleted
+    static void forgetVertexArray(GLuint vao_id);
+
+    /// @brief forget a buffer that is about to be deleted
+    static void forgetBuffer(GLuint buffer_id);
+
+    /// @brief forget a texture that is about to be deleted
+    static void forgetTexture(GLuint texture_id);
+
+    /// @brief forget a sampler that is about to be deleted
+    static void forgetSampler(GLuint sampler_id);
+
+    /// @brief forget everything we know about the bound state - call after code that binds OpenGL state directly (i.e. ImGui's renderer)
+    static void invalidate();
+
+    /// @brief get the number of binding calls issued and skipped since the last reset
+    /// @return the state stats
+    static GLStateStats getStats();
+
+    /// @brief reset the binding counters - call once per frame
+    static void resetStats();
+
+    // delete copy constructor
+    GLStateCache(GLStateCache const &) = delete;
+    // delete copy assignment
+    void operator=(GLStateCache const &) = delete;
+
+private:
+    /// @brief constructor (private because singleton) - the bound state starts unknown
+    GLStateCache();
+
+    static GLStateCache &getInstance();
+
+    /// @brief count a binding call and check if it needs to be issued, updating the cached value if so
+    /// @param cached the cached value of the binding
+    /// @param value the value being bound
+    /// @return true if the call must be issued
+    bool update(GLuint &cached, GLuint value);
+
+    /// @brief the current program
+    GLuint program;
+
+    /// @brief the current VAO
+    GLuint vertexArray;
+
+    /// @brief the active texture unit
+    GLuint activeTextureUnit;
+
+    /// @brief the buffer bound to each target (except element array buffers)
+    std::unordered_map<GLenum, GLuint> buffers;
+
+    /// @brief the element array buffer stored in each VAO
+    std::unordered_map<GLuint, GLuint> elementBuffers;
+
+    /// @brief the buffer bound to each indexed binding point, keyed by (target << 32 | index)
+    std::unordered_map<uint64_t, GLuint> indexedBuffers;
+
+    /// @brief the texture bound to each texture unit and target, keyed by (unit << 32 | target)
+    std::unordered_map<uint64_t, GLuint> textures;
+
+    /// @brief the sampler bound to each texture unit
+    std::unordered_map<GLuint, GLuint> samplers;
+
+    /// @brief the binding calls issued and skipped since the last reset
+    GLStateStats stats;
+};
@@ -7,6 +7,27 @@
 #include <glm/vec2.hpp>
 #include <iostream>
 #include <stb/stb_image.h>
+#include <memory>
+#include <future>
+
+class Sampler;
+class ThreadPool;
+
+/// @brief streamed textures initially only load mip levels no larger than this (the coarse "mip tail")
+const int MIP_TAIL_SIZE = 64;
+
+/// @brief the finer mip levels of a streamed texture, decoded from its image file and waiting to be uploaded
+struct DecodedMipLevels
+{
+    /// @brief the finest level decoded
+    int firstLevel;
+    /// @brief the level after the last one decoded (the finest level that was resident when the decode started)
+    int endLevel;
+    /// @brief the size of each level from firstLevel on
+    std::vector<int> widths, heights;
+    /// @brief the texels of each level from firstLevel on (empty if the image file failed to load)
+    std::vector<std::vector<unsigned char>> levels;
+};
 
 struct TextureParam
 {
@@ -40,15 +61,27 @@ public:
 
     /// @brief constructor - creates the texture object in OpenGL
     /// @param textureTargetType \copydoc textureTargetType
-    /// @param params a vector of OpenGL texture options to apply to this texture object
+    /// @param params a vector of OpenGL sampler options (filtering/wrapping) - textures with the same options share a Sampler
     /// @param texture_path the path to the image file from which the texture data will be loaded
     /// @param usecase what this texture is expected to be used for (specular/diffuse maps etc.)
     /// @param texture_unit the OpenGL texture unit that this texture will be assigned to and accessed via a Sampler in a shader etc.
-    Texture(GLenum texture_target_type, const std::vector<TextureParam> &params, const std::string &texture_path, TEXTURE_USECASE usecase, GLenum texture_unit);
+    /// @param stream_mips if true, only the coarse mip tail is loaded and finer mip levels are streamed in with streamInMipLevels()
+    Texture(GLenum texture_target_type, const std::vector<TextureParam> &params, const std::string &texture_path, TEXTURE_USECASE usecase, GLenum texture_unit, bool stream_mips = false);
+
+    /// @brief constructor - creates the texture object in OpenGL from an image file that has already been read (so it is not read again)
+    /// @param textureTargetType \copydoc textureTargetType
+    /// @param params a vector of OpenGL sampler options (filtering/wrapping) - textures with the same options share a Sampler
+    /// @param texture_path the path to the image file the data was read from (read again if the texture is evicted and reloaded)
+    /// @param usecase what this texture is expected to be used for (specular/diffuse maps etc.)
+    /// @param texture_unit the OpenGL texture unit that this texture will be assigned to and accessed via a Sampler in a shader etc.
+    /// @param stream_mips if true, only the coarse mip tail is loaded and finer mip levels are streamed in with streamInMipLevels()
+    /// @param file_data the contents of the image file (if empty, the file is read from texture_path)
+    Texture(GLenum texture_target_type, const std::vector<TextureParam> &params, const std::string &texture_path, TEXTURE_USECASE usecase, GLenum texture_unit, bool stream_mips,
+            const std::vector<unsigned char> &file_data);
 
     /// @brief constructor - creates the texture object in OpenGL
     /// @param textureTargetType \copydoc textureTargetType
-    /// @param params a vector of OpenGL texture options to apply to this texture object
+    /// @param params a vector of OpenGL sampler options (filtering/wrapping) - textures with the same options share a Sampler
     /// @param texture_path the path to the image file from which the texture data will be loaded
     Texture(GLenum texture_target_type, const std::vector<TextureParam> &params, const std::string &texture_path);
 
@@ -69,7 +102,7 @@ public:
     /// @brief destructor - deletes texture from OpenGL
     ~Texture();
 
-    /// @brief bind the texture to active state in OpenGL
+    /// @brief bind the texture (and its sampler) to its texture unit in OpenGL
     void bind();
 
     /// @brief unbind the texture from active state in OpenGL
@@ -83,6 +116,94 @@ public:
     /// @return the int corresponding to the texture unit (i.e. 0 for GL_TEXTURE0)
     unsigned int getTextureUnit() const;
 
+    /// @brief get the shared sampler used when sampling this texture
+    /// @return the sampler
+    std::shared_ptr<Sampler> getSampler() const;
+
+    /// @brief get the path of the image file this texture was loaded from
+    /// @return the image file path
+    const std::string &getPath() const;
+
+    /// @brief check if this texture currently has its image data in OpenGL (i.e. it has not been evicted)
+    /// @return true if the texture object exists in OpenGL
+    bool isResident() const;
+
+    /// @brief delete the texture object from OpenGL to free video memory - the texture can be restored with reload()
+    void evict();
+
+    /// @brief recreate the texture object in OpenGL from the original image file (if it has been evicted)
+    void reload();
+
+    /// @brief get the estimated video memory used by this texture (including mip maps)
+    /// @return the size in bytes, or 0 if the texture is not resident
+    size_t getMemorySize() const;
+
+    /// @brief get when this texture was last bound, used to find the least recently used textures
+    /// @return a tick value that increases with every texture bind (0 if never bound)
+    unsigned long long getLastBoundTick() const;
+
+    /// @brief get the height/width of the texture
+    /// @return the dimensions of mip level 0
+    glm::vec2 getDimensions() const;
+
+    /// @brief check if this texture streams its mip levels on demand
+    /// @return true if mip levels are streamed
+    bool isStreamed() const;
+
+    /// @brief get the number of mip levels in the full mip chain
+    /// @return the mip level count
+    int getMipLevelCount() const;
+
+    /// @brief get the finest mip level that is currently loaded (the GL_TEXTURE_BASE_LEVEL)
+    /// @return the finest resident mip level
+    int getResidentMipLevel() const;
+
+    /// @brief get the first level of the coarse mip tail that is always kept loaded
+    /// @return the mip tail level
+    int getMipTailLevel() const;
+
+    /// @brief start decoding the mip levels between the resident ones and the given level from the image file (only for streamed textures).
+    /// Nothing is uploaded until uploadStreamedMipLevels() is called once the decode has finished, so the caller's frame is not held up
+    /// @param level the new finest mip level, clamped between 0 and the mip tail
+    /// @param thread_pool the pool to decode on (or nullptr to decode now, on the calling thread)
+    void streamInMipLevels(int level, ThreadPool *thread_pool);
+
+    /// @brief check if mip levels are being decoded for this texture (and have not been uploaded yet)
+    /// @return true if a decode is in flight or waiting to be uploaded
+    bool isStreamingMipLevels() const;
+
+    /// @brief check if the mip levels being decoded are ready to upload
+    /// @return true if the decode has finished
+    bool areStreamedMipLevelsReady() const;
+
+    /// @brief get the finest mip level being decoded
+    /// @return the level (the resident level if nothing is being decoded)
+    int getStreamingMipLevel() const;
+
+    /// @brief upload the decoded mip levels and start sampling from them - only the new levels are uploaded (waits if the decode has not finished)
+    /// @return the number of levels uploaded (0 if the texture was evicted or changed while they were decoded, so they were thrown away)
+    int uploadStreamedMipLevels();
+
+    /// @brief drop the finest mip levels so that the given level is the finest loaded level (only for streamed textures)
+    /// @param level the new finest mip level, clamped between the resident level and the mip tail
+    void dropMipLevels(int level);
+
+    /// @brief calculate the estimated video memory used by the mip chain starting at the given level
+    /// @param first_level the finest mip level to include
+    /// @return the size in bytes
+    size_t calculateMemorySize(int first_level) const;
+
+    /// @brief request that a mip level be loaded this frame - the finest level requested is kept
+    /// @param level the mip level needed
+    void requestMipLevel(int level);
+
+    /// @brief get the finest mip level requested since the last call to clearMipLevelRequest()
+    /// @return the requested level (the mip tail if nothing was requested)
+    int getRequestedMipLevel() const;
+
+    /// @brief reset the requested mip level back to the mip tail
+    void clearMipLevelRequest();
+
 private:
     /// @brief the id of the texture object in OpenGL
     unsigned int texture_ID;
@@ -99,7 +220,73 @@ private:
     /// @brief the height/width of the texture
     glm::vec2 dimensions;
 
+    /// @brief the path of the image file this texture was loaded from (kept so the texture can be reloaded)
+    std::string texturePath;
+
+    /// @brief the shared sampler object bound alongside this texture
+    std::shared_ptr<Sampler> sampler;
+
+    /// @brief the estimated video memory used by the texture data in bytes (including mip maps)
+    size_t memorySize;
+
+    /// @brief the bind tick at which this texture was last bound
+    unsigned long long lastBoundTick;
+
+    /// @brief a counter incremented on every texture bind - used to order textures by how recently they were used
+    static unsigned long long bindTick;
+
+    /// @brief the format of the texture data (i.e. GL_RGB)
+    GLenum format;
+
+    /// @brief the number of channels in the texture data
+    int channels;
+
+    /// @brief if mip levels are streamed on demand rather than all loaded upfront
+    bool streamed;
+
+    /// @brief the number of levels in the full mip chain
+    int mipLevelCount;
+
+    /// @brief the first level of the coarse mip tail
+    int mipTailLevel;
+
+    /// @brief the finest mip level loaded in OpenGL
+    int residentMipLevel;
+
+    /// @brief the finest mip level requested this frame
+    int requestedMipLevel;
+
+    /// @brief the mip levels being decoded (invalid if none are)
+    std::future<DecodedMipLevels> streamedMipLevels;
+
+    /// @brief the finest mip level being decoded
+    int streamingMipLevel;
+
+    /// @brief load an image file and downsample it into a range of its mip levels (touches no OpenGL state, so can run on any thread)
+    /// @param texture_path the path of the image file
+    /// @param channels the number of channels to load
+    /// @param first_level the finest level to keep
+    /// @param end_level the level after the last one to keep
+    /// @return the decoded levels
+    static DecodedMipLevels decodeMipLevels(const std::string &texture_path, int channels, int first_level, int end_level);
+
+    /// @brief halve the resolution of image data by averaging each 2x2 block of texels
+    /// @param data the image data
+    /// @param width the width of the image (updated to the new width)
+    /// @param height the height of the image (updated to the new height)
+    /// @param channels the number of channels per texel
+    /// @return the downsampled image data
+    static std::vector<unsigned char> downsample(const std::vector<unsigned char> &data, int &width, int &height, int channels);
+
+    /// @brief generate the texture object in OpenGL and load the image file into it
+    /// @param file_data the contents of the image file if they have already been read (if empty, the file is read from the texture path)
+    void create(const std::vector<unsigned char> &file_data = {});
+
+    /// @brief bind this texture to its unit and make the unit active, so OpenGL texture calls edit this texture
+    void bindForEditing();
+
     /// @brief load and apply an image file as the texture data for this texture (only accepts png and jpg)
     /// @param texture_path the path to the file containing texture data
-    void assignTexture(const std::string &texture_path);
+    /// @param file_data the contents of the file if they have already been read (if empty, the file is read from texture_path)
+    void assignTexture(const std::string &texture_path, const std::vector<unsigned char> &file_data = {});
 };
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "utils/signal/signal/signal.h"
 #include <vector>
 #include <optional>
+#include <cstdint>
 
 struct TextureInfo
 {
@@ -15,10 +16,47 @@ public:
     std::weak_ptr<Texture> texture;
 };
 
+/// @brief the default amount of video memory textures may use before the least recently used ones are evicted (512 MiB)
+const size_t DEFAULT_TEXTURE_MEMORY_BUDGET = 512 * 1024 * 1024;
+
+/// @brief the default amount of texture data that may be streamed into video memory per frame (16 MiB)
+const size_t DEFAULT_TEXTURE_STREAMING_BUDGET = 16 * 1024 * 1024;
+
+/// @brief streamed textures only drop mip levels once they need this many levels less detail than is loaded (avoids thrashing)
+const int MIP_DROP_HYSTERESIS = 1;
+
+/// @brief statistics describing the video memory used by managed textures
+struct TextureMemoryStats
+{
+    /// @brief the estimated video memory used by resident textures in bytes
+    size_t residentBytes;
+
+    /// @brief the video memory budget in bytes
+    size_t budgetBytes;
+
+    /// @brief the number of textures evicted since startup
+    unsigned int evictions;
+
+    /// @brief the number of evicted textures that were reloaded on demand
+    unsigned int reloads;
+
+    /// @brief the number of mip levels streamed in since startup
+    unsigned int mipLevelsStreamedIn;
+
+    /// @brief the number of mip levels dropped since startup
+    unsigned int mipLevelsDropped;
+
+    /// @brief the number of loaded paths that shared an existing texture with identical content
+    unsigned int duplicateTextures;
+
+    /// @brief the video memory (at full detail) saved by sharing textures with identical content
+    size_t duplicateBytesSaved;
+};
+
 class TextureManager
 {
 public:
-    /// @brief load and manage a new texture
+    /// @brief load and manage a new texture - if a texture with identical file content is already loaded it is shared instead
     /// @param file_path the file location of the new texture
     /// @param texture_unit the GL texture unit in shaders to associate this texture with
     /// @return information for the loaded texture
@@ -37,6 +75,38 @@ public:
 
     static Signal<const TextureInfo> getOnTextureLoadedSignal();
 
+    /// @brief bind a managed texture, reloading it first if it has been evicted
+    /// @param texture the texture to bind
+    static void bindTexture(Texture &texture);
+
+    /// @brief record that a mesh uses a texture - textures used by a live mesh are never evicted
+    /// @param texture_info the info of the texture used by the mesh
+    static void addMeshReference(const TextureInfo &texture_info);
+
+    /// @brief record that a mesh no longer uses a texture
+    /// @param texture_info the info of the texture previously used by the mesh
+    static void removeMeshReference(const TextureInfo &texture_info);
+
+    /// @brief set the video memory budget for managed textures, evicting textures if it is exceeded
+    /// @param budget_bytes the new budget in bytes
+    static void setMemoryBudget(size_t budget_bytes);
+
+    /// @brief set the maximum amount of texture data streamed into video memory per frame
+    /// @param budget_bytes the new per frame budget in bytes
+    static void setStreamingBudget(size_t budget_bytes);
+
+    /// @brief set the thread pool streamed mip levels are decoded on
+    /// @param thread_pool the pool (or nullptr to decode on the calling thread - the levels are still only uploaded on the next update)
+    static void setThreadPool(ThreadPool *thread_pool);
+
+    /// @brief upload the mip levels decoded since the last update, then start decoding or drop mip levels of streamed textures based on
+    /// the mip levels requested this frame (call once per frame)
+    static void updateStreaming();
+
+    /// @brief get statistics on the video memory used by managed textures
+    /// @return the texture memory stats
+    static TextureMemoryStats getMemoryStats();
+
     // delete copy constructor
     TextureManager(TextureManager const &) = delete;
     // delete copy assignment
@@ -48,9 +118,58 @@ private:
 
     static TextureManager &getInstance();
 
+    /// @brief get the estimated video memory used by all resident managed textures
+    /// @return the size in bytes
+    size_t calculateResidentBytes() const;
+
+    /// @brief evict the least recently bound textures that are not used by any live mesh until we are within budget
+    /// @param keep a texture that must not be evicted (i.e. the texture we are about to bind)
+    /// @param additional_bytes extra memory we want to make room for (i.e. mip levels about to be streamed in)
+    /// @return true if the resident textures (plus the additional bytes) fit in the budget
+    bool enforceBudget(const Texture *keep, size_t additional_bytes = 0);
+
+    /// @brief check that a file's contents really match another file's, after their hashes matched
+    /// @param file_data the contents of the file being loaded
+    /// @param file_path the path of the file whose texture would be shared
+    /// @return true if the other file could be read and its contents are byte for byte the same
+    static bool haveSameContent(const std::vector<unsigned char> &file_data, const std::string &file_path);
+
     /// @brief a signal that emits a pointer to a texture upon it loading
     Signal<const TextureInfo> onTextureLoaded;
 
     /// @brief a map of file path to texture loaded from filepath
     std::unordered_map<std::string, std::shared_ptr<Texture>> locationToTexture;
+
+    /// @brief a map of file path to the number of live meshes using the texture loaded from that path
+    std::unordered_map<std::string, unsigned int> meshReferences;
+
+    /// @brief the video memory budget for managed textures in bytes
+    size_t memoryBudget;
+
+    /// @brief the number of textures evicted since startup
+    unsigned int evictions;
+
+    /// @brief the number of evicted textures reloaded since startup
+    unsigned int reloads;
+
+    /// @brief the amount of texture data that may be streamed in per frame in bytes
+    size_t streamingBudget;
+
+    /// @brief the thread pool streamed mip levels are decoded on (if any)
+    ThreadPool *threadPool;
+
+    /// @brief the number of mip levels streamed in since startup
+    unsigned int mipLevelsStreamedIn;
+
+    /// @brief the number of mip levels dropped since startup
+    unsigned int mipLevelsDropped;
+
+    /// @brief a map of image content hash (combined with texture unit) to the texture loaded with that content
+    std::unordered_map<uint64_t, std::weak_ptr<Texture>> contentToTexture;
+
+    /// @brief the number of loaded paths that shared an existing texture with identical content
+    unsigned int duplicateTextures;
+
+    /// @brief the video memory (at full detail) saved by sharing textures with identical content
+    size_t duplicateBytesSaved;
 };
\ No newline at end of file
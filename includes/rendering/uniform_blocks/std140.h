@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <glm/glm.hpp>
+
+/// @brief C++ types that match the std140 layout rules of GLSL uniform blocks where the natural C++ layout differs
+/// (vec3, vec4 and mat4 members only need alignas(16) - a scalar may then pack into the last 4 bytes of a vec3)
+namespace Std140
+{
+    /// @brief a mat3 member - std140 stores each column as a vec4
+    struct alignas(16) Mat3
+    {
+        /// @brief the columns of the matrix (w is padding)
+        glm::vec4 columns[3];
+
+        /// @brief assign from a glm::mat3
+        /// @param matrix the matrix to store
+        /// @return this
+        Mat3 &operator=(const glm::mat3 &matrix)
+        {
+            for (int i = 0; i < 3; i++)
+                columns[i] = glm::vec4(matrix[i], 0.0f);
+            return *this;
+        }
+    };
+
+    /// @brief an element of an array of scalars - std140 rounds the stride of every array element up to 16 bytes
+    template <typename T>
+    struct alignas(16) ArrayElement
+    {
+        T value;
+    };
+}
+
+/// @brief check at compile time that a block member is at the offset std140 expects (i.e. the offset reported by glGetActiveUniformsiv)
+#define STD140_CHECK_OFFSET(block, member, offset) \
+    static_assert(offsetof(block, member) == (offset), #block "::" #member " does not match its std140 offset")
+
+/// @brief check at compile time that a block (or a struct used in a block) has the size std140 expects
+#define STD140_CHECK_SIZE(block, size) \
+    static_assert(sizeof(block) == (size), #block " does not match its std140 size")
@@ -0,0 +1,144 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <type_traits>
+#include "rendering/uniform_blocks/std140.h"
+#include "rendering/buffer/ubo/ubo.h"
+
+/// @brief the maximum number of point lights in the Lights block (must match NR_POINT_LIGHTS in the shaders)
+const unsigned int MAX_POINT_LIGHTS = 8;
+
+/// @brief the fixed binding points of the engine's uniform blocks - every shader binds its blocks to these after linking
+enum class UniformBlockBinding : unsigned int
+{
+    PER_FRAME = 0,
+    LIGHTS = 1,
+    PER_OBJECT = 2
+};
+
+/// @brief the name of a uniform block in GLSL and the binding point it is bound to
+struct UniformBlockDescription
+{
+    const char *blockName;
+    UniformBlockBinding binding;
+};
+
+/// @brief every engine uniform block
+const UniformBlockDescription UNIFORM_BLOCKS[] = {
+    {"PerFrame", UniformBlockBinding::PER_FRAME},
+    {"Lights", UniformBlockBinding::LIGHTS},
+    {"PerObject", UniformBlockBinding::PER_OBJECT}};
+
+/// @brief data that changes once per frame (the camera)
+struct PerFrameBlock
+{
+    /// @brief the view matrix
+    alignas(16) glm::mat4 view;
+    /// @brief the projection matrix
+    alignas(16) glm::mat4 projection;
+    /// @brief the world space position of the camera
+    alignas(16) glm::vec3 viewPos;
+    /// @brief the time since startup in seconds
+    float time;
+};
+STD140_CHECK_OFFSET(PerFrameBlock, view, 0);
+STD140_CHECK_OFFSET(PerFrameBlock, projection, 64);
+STD140_CHECK_OFFSET(PerFrameBlock, viewPos, 128);
+STD140_CHECK_OFFSET(PerFrameBlock, time, 140);
+STD140_CHECK_SIZE(PerFrameBlock, 144);
+
+/// @brief a directional light (e.g. the sun) as laid out in the Lights block
+struct DirectionalLightData
+{
+    alignas(16) glm::vec3 direction;
+    alignas(16) glm::vec3 ambient;
+    alignas(16) glm::vec3 diffuse;
+    alignas(16) glm::vec3 specular;
+};
+STD140_CHECK_OFFSET(DirectionalLightData, ambient, 16);
+STD140_CHECK_OFFSET(DirectionalLightData, specular, 48);
+STD140_CHECK_SIZE(DirectionalLightData, 64);
+
+/// @brief a point light (e.g. a light bulb) as laid out in the Lights block
+struct PointLightData
+{
+    alignas(16) glm::vec3 position;
+    /// @brief the constant factor in attenuation (packed into the padding after position)
+    float constant;
+    /// @brief the linear factor in attenuation
+    float linear;
+    /// @brief the quadratic factor in attenuation
+    float quadratic;
+    alignas(16) glm::vec3 ambient;
+    alignas(16) glm::vec3 diffuse;
+    alignas(16) glm::vec3 specular;
+};
+STD140_CHECK_OFFSET(PointLightData, constant, 12);
+STD140_CHECK_OFFSET(PointLightData, linear, 16);
+STD140_CHECK_OFFSET(PointLightData, quadratic, 20);
+STD140_CHECK_OFFSET(PointLightData, ambient, 32);
+STD140_CHECK_OFFSET(PointLightData, diffuse, 48);
+STD140_CHECK_OFFSET(PointLightData, specular, 64);
+STD140_CHECK_SIZE(PointLightData, 80);
+
+/// @brief the lights in the scene
+struct LightsBlock
+{
+    alignas(16) DirectionalLightData dirLight;
+    alignas(16) PointLightData pointLights[MAX_POINT_LIGHTS];
+    /// @brief the number of point lights in use
+    int pointLightCount;
+};
+STD140_CHECK_OFFSET(LightsBlock, pointLights, 64);
+STD140_CHECK_OFFSET(LightsBlock, pointLightCount, 64 + 80 * MAX_POINT_LIGHTS);
+
+/// @brief data that changes per drawn object
+struct PerObjectBlock
+{
+    /// @brief the model matrix
+    alignas(16) glm::mat4 model;
+    /// @brief the normal model matrix (transformation matrix for normals into world space)
+    Std140::Mat3 normalModel;
+};
+STD140_CHECK_OFFSET(PerObjectBlock, normalModel, 64);
+STD140_CHECK_SIZE(PerObjectBlock, 112);
+
+/// @brief a CPU copy of a uniform block's data and the UBO it is uploaded to, bound once to the block's fixed binding point
+/// @tparam T the block struct (its layout must match std140 - check it with STD140_CHECK_OFFSET)
+template <typename T>
+class UniformBlock
+{
+    static_assert(std::is_standard_layout<T>::value, "uniform block structs must be standard layout to match std140");
+
+public:
+    /// @brief constructor - allocates the UBO and binds it to its binding point
+    /// @param binding the binding point of this block
+    UniformBlock(UniformBlockBinding binding)
+        : data(), ubo(), binding(binding)
+    {
+        ubo.assignData(static_cast<const void *>(nullptr), sizeof(T), GL_DYNAMIC_DRAW);
+        ubo.bindToBindingPoint(static_cast<unsigned int>(binding));
+    }
+
+    /// @brief the CPU copy of the block data - call upload() after changing it
+    T data;
+
+    /// @brief upload the CPU copy of the block data to the UBO
+    void upload()
+    {
+        ubo.assignSubData(&data, 0, sizeof(T));
+    }
+
+    /// @brief bind the UBO to the block's binding point again (i.e. after a DynamicBuffer range was bound there)
+    void bind() const
+    {
+        ubo.bindToBindingPoint(static_cast<unsigned int>(binding));
+    }
+
+private:
+    /// @brief the buffer holding the block data in OpenGL
+    UBO ubo;
+
+    /// @brief the binding point the block is bound to
+    UniformBlockBinding binding;
+};
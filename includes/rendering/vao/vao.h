@@ -6,6 +6,8 @@
 #include <iostream>
 #include <optional>
 #include "rendering/buffer/ebo/ebo.h"
+#include "rendering/vertex/vertex_description.h"
+#include <cstdint>
 
 class VertexBufferElement
 {
@@ -17,6 +19,14 @@ public:
     /// @param normalised if these are normalised
     VertexBufferElement(GLenum type, unsigned int count, unsigned int totalSize, GLboolean normalised);
 
+    /// @brief constructor
+    /// @param type the type of the element
+    /// @param count the number of these types
+    /// @param totalSize size in bytes of this element
+    /// @param normalised if these are normalised
+    /// @param offset the offset of this element in the vertex in bytes
+    VertexBufferElement(GLenum type, unsigned int count, unsigned int totalSize, GLboolean normalised, unsigned int offset);
+
     /// @brief default constructor
     VertexBufferElement();
 
@@ -31,6 +41,9 @@ public:
 
     /// @brief if this type is a normalised type
     GLboolean normalised;
+
+    /// @brief the offset of this element in the vertex in bytes
+    unsigned int offset;
 };
 
 class VertexBufferLayout
@@ -39,12 +52,27 @@ class VertexBufferLayout
 public:
     VertexBufferLayout();
 
+    /// @brief build the layout of a C++ vertex struct from its description (offsets and stride follow the struct, including padding)
+    /// @param description the description of the vertex struct
+    VertexBufferLayout(const VertexDescription &description);
 
+    /// @brief add an attribute packed directly after the previous one
     void addAttribute(unsigned int index, GLenum type, unsigned int count, unsigned int totalSize, GLboolean normalised);
 
-
+    /// @brief add an attribute packed directly after the previous one, at the next attribute index
     void addAttribute(GLenum type, unsigned int count, unsigned int totalSize, GLboolean normalised);
 
+    /// @brief add an attribute at an explicit offset in the vertex (the stride must be set with setStride if it is not the packed size)
+    void addAttribute(unsigned int index, GLenum type, unsigned int count, unsigned int totalSize, GLboolean normalised, unsigned int offset);
+
+    /// @brief set the stride of the layout explicitly (i.e. the sizeof the vertex struct)
+    /// @param stride the stride in bytes
+    void setStride(unsigned int stride);
+
+    /// @brief get a key identifying this layout - layouts with equal attributes and stride have equal keys
+    /// @return the key
+    uint64_t getKey() const;
+
     /// @brief get the elements in the layout
     /// @return the VertexBufferElements represented in this layout
     const std::vector<VertexBufferElement> getElements() const;
@@ -63,6 +91,57 @@ private:
 
     /// @brief returns the total stride of this layout
     unsigned int stride;
+
+    /// @brief the key of this layout (computed on first use, 0 when it must be recomputed)
+    mutable uint64_t key;
+};
+
+/// @brief the format of one vertex attribute, ready to pass to glVertexAttribPointer
+struct VertexAttributeFormat
+{
+    unsigned int location;
+    unsigned int count;
+    GLenum type;
+    GLboolean normalised;
+    unsigned int offset;
+};
+
+/// @brief the flattened attribute formats of a VertexBufferLayout
+struct VertexFormat
+{
+    /// @brief the stride of the layout in bytes
+    unsigned int stride;
+
+    /// @brief the attribute formats in location order
+    std::vector<VertexAttributeFormat> attributes;
+};
+
+/// @brief caches the flattened attribute formats of each distinct layout, so VAOs with a known layout are set up without walking it again
+class VertexFormatCache
+{
+public:
+    /// @brief get the attribute formats of a layout, flattening the layout on first use
+    /// @param layout the layout
+    /// @return the attribute formats
+    static const VertexFormat &getFormat(const VertexBufferLayout &layout);
+
+    /// @brief get the number of distinct layouts cached
+    /// @return the number of formats
+    static size_t getFormatCount();
+
+    // delete copy constructor
+    VertexFormatCache(VertexFormatCache const &) = delete;
+    // delete copy assignment
+    void operator=(VertexFormatCache const &) = delete;
+
+private:
+    /// @brief constructor (private because singleton)
+    VertexFormatCache();
+
+    static VertexFormatCache &getInstance();
+
+    /// @brief the attribute formats of each layout, by layout key
+    std::map<uint64_t, VertexFormat> keyToFormat;
 };
 
 class VAO
@@ -104,6 +183,10 @@ public:
     /// @brief unbind this VAO frrom OpenGL
     void unbind() const;
 
+    /// @brief get the id of this VAO
+    /// @return the id
+    unsigned int getID() const;
+
 private:
     /// @brief add a vertex attribute to this VAO
     /// @param attrib_ID 
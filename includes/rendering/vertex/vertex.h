@@ -1,5 +1,6 @@
 #pragma once
 #include "glm/glm.hpp"
+#include "rendering/vertex/vertex_description.h"
 
 
 /// @brief used to store vertex data for meshes
@@ -11,4 +12,8 @@ struct Vertex
     glm::vec3 normal;
     /// @brief the coords of the texture corresponding to this vertex
     glm::vec2 texture_coords;
-};
\ No newline at end of file
+
+    /// @brief describe how this struct is laid out and which shader attributes its members feed
+    /// @return the vertex description
+    static const VertexDescription &describe();
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/// @brief describes one member of a C++ vertex struct and the shader attribute it feeds
+struct VertexAttributeDescription
+{
+    /// @brief the name of the attribute in the vertex shader (i.e. aPos)
+    std::string name;
+
+    /// @brief the attribute location (must match layout (location = ...) in the vertex shader)
+    unsigned int location;
+
+    /// @brief the OpenGL type of each component (i.e. GL_FLOAT)
+    GLenum type;
+
+    /// @brief the number of components (i.e. 3 for a glm::vec3)
+    unsigned int count;
+
+    /// @brief the size of the member in bytes
+    unsigned int size;
+
+    /// @brief the offset of the member in the struct in bytes
+    unsigned int offset;
+
+    /// @brief if integer components are normalised to [0, 1] / [-1, 1]
+    GLboolean normalised;
+};
+
+/// @brief describes the memory layout of a C++ vertex struct - the single source of truth for building VertexBufferLayouts and validating shaders
+struct VertexDescription
+{
+    /// @brief the size of the vertex struct in bytes
+    unsigned int stride;
+
+    /// @brief the members of the vertex struct that feed shader attributes
+    std::vector<VertexAttributeDescription> attributes;
+};
+
+/// @brief describe a float member of a vertex struct (i.e. VERTEX_FLOAT_ATTRIBUTE(Vertex, position, "aPos", 0, 3))
+#define VERTEX_FLOAT_ATTRIBUTE(vertex_type, member, attribute_name, attribute_location, component_count) \
+    VertexAttributeDescription{attribute_name, attribute_location, GL_FLOAT, component_count,            \
+                               (unsigned int)sizeof(vertex_type::member), (unsigned int)offsetof(vertex_type, member), GL_FALSE}
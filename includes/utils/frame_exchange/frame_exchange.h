@@ -0,0 +1,88 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+
+/// @brief hands frames from a producer thread to a consumer thread through three slots: one being written, one ready, and one being read.
+/// The producer and consumer never touch the same slot, so building the next frame overlaps with consuming the last one. The producer is
+/// kept at most one frame ahead - publishing waits until the consumer has taken the ready frame - so no frame is skipped
+/// @tparam T the frame (reused between frames, so it can keep its allocations)
+template <typename T>
+class FrameExchange
+{
+public:
+    /// @brief constructor
+    FrameExchange()
+        : slots(), writeSlot(0), readySlot(1), readSlot(2), hasReady(false), closed(false), mutex(), changed()
+    {
+    }
+
+    // delete copy constructor
+    FrameExchange(FrameExchange const &) = delete;
+    // delete copy assignment
+    void operator=(FrameExchange const &) = delete;
+
+    /// @brief get the frame to write (producer only)
+    /// @return the frame - it still holds whatever was written to this slot three frames ago
+    T &getWriteFrame()
+    {
+        return slots[writeSlot];
+    }
+
+    /// @brief hand the written frame over - waits while the consumer has yet to take the previous one
+    /// @return false if the exchange was closed (the frame is dropped)
+    bool publish()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]
+                     { return !hasReady || closed; });
+        if (closed)
+            return false;
+        std::swap(writeSlot, readySlot);
+        hasReady = true;
+        changed.notify_all();
+        return true;
+    }
+
+    /// @brief take the latest published frame (consumer only) - waits until one is published
+    /// @return the frame, the consumer's until the next acquire (nullptr once the exchange is closed and drained)
+    T *acquire()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]
+                     { return hasReady || closed; });
+        if (!hasReady)
+            return nullptr;
+        std::swap(readySlot, readSlot);
+        hasReady = false;
+        changed.notify_all();
+        return &slots[readSlot];
+    }
+
+    /// @brief stop the exchange - wakes both threads, the consumer still gets a frame that was already published
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        changed.notify_all();
+    }
+
+private:
+    /// @brief the three frames
+    T slots[3];
+
+    /// @brief which slot is being written, is ready and is being read
+    int writeSlot, readySlot, readSlot;
+
+    /// @brief whether the ready slot holds a frame the consumer has not taken
+    bool hasReady;
+
+    /// @brief whether the exchange was closed
+    bool closed;
+
+    /// @brief guards the slot indices and flags
+    std::mutex mutex;
+
+    /// @brief signalled whenever a frame is published or taken, or the exchange is closed
+    std::condition_variable changed;
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <optional>
+#include <vector>
+
+namespace Hashing
+{
+    /// @brief compute a fast 64 bit hash of a block of memory (xxHash64)
+    /// @param data the data to hash
+    /// @param size the size of the data in bytes
+    /// @param seed a seed to vary the hash with
+    /// @return the 64 bit hash of the data
+    uint64_t hash64(const void *data, size_t size, uint64_t seed = 0);
+
+    /// @brief compute a fast 64 bit hash of a string
+    /// @param text the string to hash
+    /// @param seed a seed to vary the hash with
+    /// @return the 64 bit hash of the string
+    uint64_t hash64(const std::string &text, uint64_t seed = 0);
+
+    /// @brief read the whole contents of a file
+    /// @param file_path the path of the file to read
+    /// @return the file contents, or empty if the file could not be read
+    std::optional<std::vector<unsigned char>> readFile(const std::string &file_path);
+
+    /// @brief combine two hashes into one (order dependent)
+    /// @param seed the hash to combine into
+    /// @param value the hash to add
+    /// @return the combined hash
+    uint64_t combine(uint64_t seed, uint64_t value);
+}
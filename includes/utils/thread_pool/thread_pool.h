@@ -0,0 +1,76 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/// @brief a fixed set of worker threads that run submitted tasks in order
+class ThreadPool
+{
+public:
+    /// @brief constructor - starts the worker threads
+    /// @param thread_count the number of worker threads (0 for one per hardware thread, less one for the calling thread)
+    ThreadPool(unsigned int thread_count = 0);
+
+    /// @brief destructor - finishes every queued task, then joins the worker threads
+    ~ThreadPool();
+
+    // delete copy constructor
+    ThreadPool(ThreadPool const &) = delete;
+    // delete copy assignment
+    void operator=(ThreadPool const &) = delete;
+
+    /// @brief queue a task to run on a worker thread
+    /// @tparam Function the type of the task
+    /// @param function the task
+    /// @return a future holding the task's result once it has run
+    template <typename Function>
+    auto submit(Function &&function) -> std::future<decltype(function())>
+    {
+        using Result = decltype(function());
+        // std::function must be copyable, so the (move only) packaged task is shared
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+        std::future<Result> result = task->get_future();
+        enqueue([task]()
+                { (*task)(); });
+        return result;
+    }
+
+    /// @brief split a range of work into batches run across the worker threads and the calling thread, returning once every batch is done
+    /// @param count the number of items
+    /// @param batch_size the number of items per batch
+    /// @param function called with the [begin, end) range of each batch
+    void parallelFor(size_t count, size_t batch_size, const std::function<void(size_t, size_t)> &function);
+
+    /// @brief get the number of worker threads
+    /// @return the number of worker threads
+    unsigned int getThreadCount() const;
+
+private:
+    /// @brief add a task to the queue and wake a worker to run it
+    /// @param task the task
+    void enqueue(std::function<void()> task);
+
+    /// @brief the loop each worker thread runs - takes tasks from the queue until the pool is destroyed
+    void workerLoop();
+
+    /// @brief the worker threads
+    std::vector<std::thread> workers;
+
+    /// @brief the tasks waiting for a worker
+    std::queue<std::function<void()>> tasks;
+
+    /// @brief guards tasks and stopping
+    std::mutex tasksMutex;
+
+    /// @brief signalled when a task is queued or the pool is stopping
+    std::condition_variable tasksAvailable;
+
+    /// @brief true once the pool is being destroyed
+    bool stopping;
+};
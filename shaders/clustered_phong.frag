@@ -0,0 +1,51 @@
+#version 430 core
+out vec4 FragColor;
+
+#include "include/lights.glsl"
+#include "include/per_frame.glsl"
+#include "include/clustered_lights.glsl"
+
+// the maps a material has are selected by the shader permutation (DIFFUSE_MAP, SPECULAR_MAP)
+struct Material
+{
+#ifdef DIFFUSE_MAP
+    sampler2D texture_diffuse0;
+#endif
+#ifdef SPECULAR_MAP
+    sampler2D texture_specular0;
+#endif
+    float shininess;
+};
+
+in vec3 FragPos; // the position of the fragment in world space (interpolated from the vertex shader for each fragment between vertices)
+in vec3 Normal; // the normal of the fragment 
+in vec2 Texcoord; // the coords (interpolated) for the diffuse/specular maps corresponding to this fragment
+
+uniform Material material; // the material of the object
+
+
+void main()
+{
+    vec3 normal = normalize(Normal);
+    vec3 fragToViewDir = normalize(viewPos - FragPos);
+
+    // sample the material maps once for every light
+#ifdef DIFFUSE_MAP
+    vec3 diffuseColor = vec3(texture(material.texture_diffuse0, Texcoord));
+#else
+    vec3 diffuseColor = vec3(1.0);
+#endif
+#ifdef SPECULAR_MAP
+    vec3 specularColor = vec3(texture(material.texture_specular0, Texcoord));
+#else
+    vec3 specularColor = vec3(0.0);
+#endif
+
+    // process directional light
+    vec3 result = CalculateDirectionalLight(dirLight, normal, fragToViewDir, diffuseColor, specularColor, material.shininess);
+
+    // process only the point lights in this fragment's cluster
+    result += CalculateClusteredLights(normal, FragPos, fragToViewDir, diffuseColor, specularColor, material.shininess);
+
+    FragColor = vec4(result, 1.0);
+}
\ No newline at end of file
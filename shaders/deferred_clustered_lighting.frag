@@ -0,0 +1,24 @@
+#version 430 core
+// the lighting pass of deferred shading - lights each pixel of the G-buffer with only the point lights in its cluster
+out vec4 FragColor;
+
+// every surface in the G-buffer has a specular intensity (0 where the material had no specular map)
+#define SPECULAR_MAP
+#include "include/lights.glsl"
+#include "include/per_frame.glsl"
+#include "include/clustered_lights.glsl"
+#include "include/gbuffer.glsl"
+
+
+void main()
+{
+    GBufferSurface surface;
+    if (!ReadGBuffer(surface))
+        discard;
+    vec3 fragToViewDir = normalize(viewPos - surface.position);
+
+    vec3 result = CalculateDirectionalLight(dirLight, surface.normal, fragToViewDir, surface.diffuseColor, surface.specularColor, surface.shininess);
+    result += CalculateClusteredLights(surface.normal, surface.position, fragToViewDir, surface.diffuseColor, surface.specularColor, surface.shininess);
+
+    FragColor = vec4(result, 1.0);
+}
@@ -0,0 +1,9 @@
+#version 330 core
+// a triangle covering the whole screen, made from gl_VertexID (draw 3 vertices with no buffers)
+
+void main()
+{
+    // (-1, -1), (3, -1), (-1, 3) - the parts off screen are clipped
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+    gl_Position = vec4(position, 0.0, 1.0);
+}
@@ -0,0 +1,43 @@
+#version 330 core
+// the geometry pass of deferred shading - writes each fragment's material into the G-buffer rather than lighting it
+layout (location = 0) out vec4 gAlbedoSpecularOut;
+layout (location = 1) out vec4 gNormalShininessOut;
+
+#include "include/gbuffer.glsl"
+
+// the maps a material has are selected by the shader permutation (DIFFUSE_MAP, SPECULAR_MAP)
+struct Material
+{
+#ifdef DIFFUSE_MAP
+    sampler2D texture_diffuse0;
+#endif
+#ifdef SPECULAR_MAP
+    sampler2D texture_specular0;
+#endif
+    float shininess;
+};
+
+in vec3 FragPos; // the position of the fragment in world space
+in vec3 Normal; // the normal of the fragment
+in vec2 Texcoord; // the coords for the diffuse/specular maps corresponding to this fragment
+
+uniform Material material; // the material of the object
+
+
+void main()
+{
+#ifdef DIFFUSE_MAP
+    vec3 diffuseColor = vec3(texture(material.texture_diffuse0, Texcoord));
+#else
+    vec3 diffuseColor = vec3(1.0);
+#endif
+#ifdef SPECULAR_MAP
+    // the specular map is reduced to one intensity to fit in the alpha channel
+    float specular = dot(vec3(texture(material.texture_specular0, Texcoord)), vec3(1.0 / 3.0));
+#else
+    float specular = 0.0;
+#endif
+
+    gAlbedoSpecularOut = vec4(diffuseColor, specular);
+    gNormalShininessOut = vec4(EncodeNormal(normalize(Normal)), EncodeShininess(material.shininess), 0.0);
+}
@@ -0,0 +1,61 @@
+// the point lights binned into clusters over the view frustum by the LightManager (requires OpenGL 4.3)
+// (include lights.glsl and per_frame.glsl first)
+
+// a point light with the distance past which it has no effect (std430, must match ClusteredPointLight)
+struct ClusteredPointLight {
+    vec3 position;
+    float radius;
+    vec3 ambient;
+    float constant;
+    vec3 diffuse;
+    float linear;
+    vec3 specular;
+    float quadratic;
+};
+
+// every point light (binding point 1)
+layout (std430, binding = 1) readonly buffer ClusteredLights
+{
+    ClusteredPointLight clusteredLights[];
+};
+
+// the grid of clusters (binding point 2) - each cluster is an (offset, count) range of lightIndices, x fastest then y then z
+layout (std430, binding = 2) readonly buffer LightClusters
+{
+    uvec4 clusterGrid; // the number of clusters along x, y and z
+    vec4 clusterParams; // the depth scale and bias of the slices (slice = log(depth) * scale + bias), then the viewport width and height
+    uvec2 clusters[];
+};
+
+// the lights of every cluster, back to back (binding point 3)
+layout (std430, binding = 3) readonly buffer LightIndices
+{
+    uint lightIndices[];
+};
+
+// find the cluster of this fragment from its window coords and its world position
+uvec2 GetLightCluster(vec3 fragPos)
+{
+    float depth = -(view * vec4(fragPos, 1.0)).z;
+    uint slice = uint(clamp(floor(log(depth) * clusterParams.x + clusterParams.y), 0.0, float(clusterGrid.z - 1u)));
+    uvec2 tile = min(uvec2(gl_FragCoord.xy / clusterParams.zw * vec2(clusterGrid.xy)), clusterGrid.xy - 1u);
+    return clusters[(slice * clusterGrid.y + tile.y) * clusterGrid.x + tile.x];
+}
+
+// calculate phong lighting for every point light in this fragment's cluster
+vec3 CalculateClusteredLights(vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffuseColor, vec3 specularColor, float shininess)
+{
+    vec3 result = vec3(0.0);
+    uvec2 cluster = GetLightCluster(fragPos);
+    for(uint i = 0u; i < cluster.y; i++)
+    {
+        ClusteredPointLight light = clusteredLights[lightIndices[cluster.x + i]];
+        // the cluster holds every light overlapping its bounds, not just those reaching this fragment
+        vec3 toLight = light.position - fragPos;
+        if(dot(toLight, toLight) > light.radius * light.radius)
+            continue;
+        PointLight pointLight = PointLight(light.position, light.constant, light.linear, light.quadratic, light.ambient, light.diffuse, light.specular);
+        result += CalculatePointLight(pointLight, normal, fragPos, viewDir, diffuseColor, specularColor, shininess);
+    }
+    return result;
+}
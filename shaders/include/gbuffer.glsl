@@ -0,0 +1,76 @@
+// the packing of surfaces into the G-buffer (must match the attachments of GBuffer)
+// albedo (rgb) + specular intensity (a) in GL_RGBA8, octahedral normal (rg) + log shininess (b) in GL_RGB10_A2, position rebuilt from depth
+
+// the largest shininess that can be stored (2^11)
+#define GBUFFER_MAX_SHININESS_LOG2 11.0
+
+// wrap the lower hemisphere of the octahedron over the upper one
+vec2 OctahedronWrap(vec2 v)
+{
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// encode a unit normal into [0, 1]^2
+vec2 EncodeNormal(vec3 normal)
+{
+    normal /= abs(normal.x) + abs(normal.y) + abs(normal.z);
+    vec2 encoded = normal.z >= 0.0 ? normal.xy : OctahedronWrap(normal.xy);
+    return encoded * 0.5 + 0.5;
+}
+
+// decode a unit normal from [0, 1]^2
+vec3 DecodeNormal(vec2 encoded)
+{
+    encoded = encoded * 2.0 - 1.0;
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if (normal.z < 0.0)
+        normal.xy = OctahedronWrap(normal.xy);
+    return normalize(normal);
+}
+
+// encode a shininess into [0, 1] (logarithmically, as the highlight changes far less between high exponents)
+float EncodeShininess(float shininess)
+{
+    return clamp(log2(max(shininess, 1.0)) / GBUFFER_MAX_SHININESS_LOG2, 0.0, 1.0);
+}
+
+// decode a shininess from [0, 1]
+float DecodeShininess(float encoded)
+{
+    return exp2(encoded * GBUFFER_MAX_SHININESS_LOG2);
+}
+
+// a surface read back from the G-buffer
+struct GBufferSurface
+{
+    vec3 position;
+    vec3 normal;
+    vec3 diffuseColor;
+    vec3 specularColor;
+    float shininess;
+};
+
+uniform sampler2D gAlbedoSpecular;
+uniform sampler2D gNormalShininess;
+uniform sampler2D gDepth;
+uniform mat4 inverseViewProjection; // takes normalised device coords back to world space
+
+// read this pixel's surface from the G-buffer (false if nothing was drawn to it)
+bool ReadGBuffer(out GBufferSurface surface)
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, texel, 0).r;
+    if (depth >= 1.0)
+        return false;
+
+    vec4 albedoSpecular = texelFetch(gAlbedoSpecular, texel, 0);
+    vec4 normalShininess = texelFetch(gNormalShininess, texel, 0);
+    vec2 uv = gl_FragCoord.xy / vec2(textureSize(gDepth, 0));
+    vec4 position = inverseViewProjection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    surface.position = position.xyz / position.w;
+    surface.normal = DecodeNormal(normalShininess.rg);
+    surface.diffuseColor = albedoSpecular.rgb;
+    surface.specularColor = vec3(albedoSpecular.a);
+    surface.shininess = DecodeShininess(normalShininess.b);
+    return true;
+}
@@ -0,0 +1,103 @@
+// the scene's lights and the phong lighting functions shared by every lit shader
+// (define SPECULAR_MAP before including to add the specular term)
+
+// A directional light (e.g. the sun), where light only has direction - not position
+struct DirectionalLight {
+    vec3 direction;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+// A point light (e.g. a light bulb), where light is emitted in all directions from a position
+struct PointLight {
+    vec3 position;
+
+    float constant; // the constant factor in attenuation
+    float linear; // the linear factor in attenuation
+    float quadratic; // the quadratic factor in attenuation
+
+    // values used for attenuation
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+#ifndef NR_POINT_LIGHTS
+#define NR_POINT_LIGHTS 8 // the maximum number of point lights (injected from MAX_POINT_LIGHTS)
+#endif
+
+// the lights in the scene (binding point 1)
+layout (std140) uniform Lights
+{
+    DirectionalLight dirLight; // the directional light data for this scene
+    PointLight pointLights[NR_POINT_LIGHTS]; // the point lights data
+    int pointLightCount; // the number of point lights in use
+};
+
+// calculate phong lighting for a directional light and return resulting RGB for frag
+vec3 CalculateDirectionalLight(DirectionalLight dirLight, vec3 normal, vec3 fragToViewDir, vec3 diffuseColor, vec3 specularColor, float shininess)
+{
+    // calculate normalised light directions (both forwards and reverse)
+    vec3 lightDir = normalize(dirLight.direction);
+    vec3 revLightDir = -lightDir;
+
+    // diffuse shading factor (how perpendicular the angle is between the light and the fragment)
+    float diffFactor = max(dot(normal, revLightDir), 0.0);
+
+    // calculate ambient result
+    vec3 ambient = dirLight.ambient * diffuseColor;
+    // calculate diffuse result
+    vec3 diffuse = dirLight.diffuse * diffFactor * diffuseColor;
+
+#ifdef SPECULAR_MAP
+    // specular shading factor (how close the view direction is to the natural reflection of the light)
+    vec3 reflectDir = reflect(lightDir, normal);
+    float specFactor = pow(max(dot(fragToViewDir, reflectDir), 0.0), shininess);
+    // calculate specular result
+    vec3 specular = dirLight.specular * specFactor * specularColor;
+
+    // calculate final result
+    return (ambient + diffuse + specular);
+#else
+    return (ambient + diffuse);
+#endif
+}
+
+// calculate phong lighting for a point light and return resulting RGB for frag
+vec3 CalculatePointLight(PointLight pointLight, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffuseColor, vec3 specularColor, float shininess)
+{
+    // calculate normalised directions between this frag and the lightsource
+    vec3 fragToLightDir = normalize(pointLight.position - fragPos);
+    vec3 lightToFragDir = -fragToLightDir;
+
+    // diffuse shading factor (how perpendicular the angle is between the light and the fragment)
+    float diffFactor = max(dot(normal, fragToLightDir), 0.0);
+
+    // calculate ambient result
+    vec3 ambient = pointLight.ambient * diffuseColor;
+    // calculate diffuse result
+    vec3 diffuse = pointLight.diffuse * diffFactor * diffuseColor;
+
+#ifdef SPECULAR_MAP
+    // specular shading factor (how close the view direction is to the natural reflection of the light)
+    vec3 reflectDir = reflect(lightToFragDir, normal);
+    float specFactor = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    // calculate specular result
+    vec3 specular = pointLight.specular * specFactor * specularColor;
+#else
+    vec3 specular = vec3(0.0);
+#endif
+
+    // calculate attenuation
+    float distanceToLight = length(pointLight.position - fragPos);
+    float attenuation = 1.0 / (pointLight.constant + pointLight.linear * distanceToLight + pointLight.quadratic * distanceToLight * distanceToLight);
+
+    // modulate by attenuation
+    ambient *= attenuation;
+    diffuse *= attenuation;
+    specular *= attenuation;
+
+    return (ambient + diffuse + specular);
+}
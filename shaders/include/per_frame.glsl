@@ -0,0 +1,10 @@
+// the per-frame camera data shared by every shader
+
+// data that changes once per frame (binding point 0)
+layout (std140) uniform PerFrame
+{
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos; // the world space coords of the viewer (i.e active camera)
+    float time;
+};
@@ -0,0 +1,38 @@
+#version 430 core
+#extension GL_ARB_shader_draw_parameters : require
+// the phong vertex shader for draws submitted with glMultiDrawElementsIndirect - the per object data comes from an SSBO instead of a uniform block
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+out vec3 FragPos; // position of the fragment in world space
+out vec3 Normal; // normal
+out vec2 Texcoord; // the texcoord for specular and diffusion maps
+
+#include "include/per_frame.glsl"
+
+// the data of one draw (laid out like the PerObject block)
+struct PerDraw
+{
+    mat4 model;
+    mat3 normalModel; // the normal model matrix (transformation matrix for normals into world space)
+};
+
+// the data of every draw this frame (binding point 0)
+layout (std430, binding = 0) readonly buffer PerDrawData
+{
+    PerDraw draws[];
+};
+
+uniform int drawOffset; // the index of the first draw of this glMultiDrawElementsIndirect call in draws
+
+void main()
+{
+    PerDraw draw = draws[drawOffset + gl_DrawIDARB];
+    FragPos = vec3(draw.model * vec4(aPos, 1.0)); // forwards the world position to the fragment shader
+    Normal = draw.normalModel * aNormal; // forwards the normal (in world space) to the fragment shader
+    Texcoord = aTexCoord; // forwards the texture coord to the fragment shader
+
+    gl_Position = projection * view * draw.model * vec4(aPos, 1.0);
+}
@@ -9,10 +9,14 @@ out vec3 FragPos; // position of the fragment in world space
 out vec3 Normal; // normal
 out vec2 Texcoord; // the texcoord for specular and diffusion maps
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-uniform mat3 normalModel; // the normal model matrix (transformation matrix for normals into world space)
+#include "include/per_frame.glsl"
+
+// data that changes per drawn object (binding point 2)
+layout (std140) uniform PerObject
+{
+    mat4 model;
+    mat3 normalModel; // the normal model matrix (transformation matrix for normals into world space)
+};
 
 void main()
 {
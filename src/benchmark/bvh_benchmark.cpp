@@ -0,0 +1,124 @@
+#include "benchmark/benchmark.h"
+#include "rendering/culling/bvh.h"
+#include "utils/logging/logging.h"
+#include "utils/thread_pool/thread_pool.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <random>
+
+/// @brief get the milliseconds since a time
+/// @param start the time
+/// @return the milliseconds elapsed
+static double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Benchmark::runBVHBenchmark(const std::vector<unsigned int> &object_counts)
+{
+    ThreadPool threadPool;
+    for (unsigned int objectCount : object_counts)
+    {
+        // spread the objects so the density (and so the number in view) stays the same as the count grows
+        std::mt19937 random(1234);
+        float halfSize = 100.0f * std::cbrt(objectCount / 100000.0f);
+        std::uniform_real_distribution<float> position(-halfSize, halfSize), size(0.5f, 5.0f), step(-1.0f, 1.0f);
+        auto randomBox = [&]()
+        {
+            glm::vec3 centre = glm::vec3(position(random), position(random), position(random));
+            glm::vec3 extents = glm::vec3(size(random), size(random), size(random));
+            return AABB{centre - extents, centre + extents};
+        };
+
+        BVH bvh;
+        std::vector<AABB> bounds;
+        std::vector<uint32_t> objects;
+        for (unsigned int i = 0; i < objectCount; i++)
+        {
+            bounds.push_back(randomBox());
+            objects.push_back(bvh.insert(bounds.back()));
+        }
+        auto start = std::chrono::steady_clock::now();
+        bvh.rebuild();
+        double buildMilliseconds = millisecondsSince(start);
+
+        // move a tenth of the objects, as a busy frame might
+        for (unsigned int i = 0; i < objectCount; i += 10)
+        {
+            glm::vec3 offset = glm::vec3(step(random), step(random), step(random));
+            bounds[i] = {bounds[i].min + offset, bounds[i].max + offset};
+            bvh.update(objects[i], bounds[i]);
+        }
+        start = std::chrono::steady_clock::now();
+        bvh.refit();
+        double refitMilliseconds = millisecondsSince(start);
+
+        // the background build: how long this thread spends starting and applying it, and how long until it lands
+        for (unsigned int i = 0; i < objectCount; i++)
+            bvh.update(objects[i], bounds[i]);
+        bvh.refit();
+        double maintainMilliseconds = 0.0;
+        start = std::chrono::steady_clock::now();
+        while (true)
+        {
+            auto maintainStart = std::chrono::steady_clock::now();
+            bool applied = bvh.maintain(threadPool);
+            maintainMilliseconds += millisecondsSince(maintainStart);
+            if (applied)
+                break;
+            std::this_thread::yield();
+        }
+        double asyncBuildMilliseconds = millisecondsSince(start);
+
+        // queries
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        Frustum frustum(glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f) * view);
+        const unsigned int frustumQueries = 20, rayQueries = 10000, overlapQueries = 10000;
+        std::vector<uint32_t> results;
+
+        start = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < frustumQueries; i++)
+            bvh.queryFrustum(frustum, results);
+        double frustumMilliseconds = millisecondsSince(start) / frustumQueries;
+        size_t visibleCount = results.size();
+
+        CullingBounds cullingBounds;
+        for (const AABB &box : bounds)
+            cullingBounds.add(box);
+        std::vector<uint8_t> visible;
+        start = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < frustumQueries; i++)
+            frustum.cull(cullingBounds, visible);
+        double linearMilliseconds = millisecondsSince(start) / frustumQueries;
+
+        BVHRayHit hit;
+        unsigned int hits = 0;
+        start = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < rayQueries; i++)
+        {
+            glm::vec3 origin = glm::vec3(position(random), position(random), position(random));
+            glm::vec3 direction = glm::vec3(step(random), step(random), step(random));
+            hits += bvh.raycast(origin, direction, 2.0f * halfSize, hit) ? 1 : 0;
+        }
+        double raysPerSecond = rayQueries / (millisecondsSince(start) / 1000.0);
+
+        start = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < overlapQueries; i++)
+        {
+            glm::vec3 centre = glm::vec3(position(random), position(random), position(random));
+            bvh.queryOverlap({centre - glm::vec3(5.0f), centre + glm::vec3(5.0f)}, results);
+        }
+        double overlapsPerSecond = overlapQueries / (millisecondsSince(start) / 1000.0);
+
+        LOG("BVH benchmark (" + std::to_string(objectCount) + " objects, " + std::to_string(bvh.getNodeCount()) + " nodes):" +
+                "\n  SAH build:                         " + std::to_string(buildMilliseconds) + " ms" +
+                "\n  refit after moving 10%:            " + std::to_string(refitMilliseconds) + " ms" +
+                "\n  background rebuild:                " + std::to_string(asyncBuildMilliseconds) + " ms until applied, " +
+                std::to_string(maintainMilliseconds) + " ms on this thread" +
+                "\n  frustum query (" + std::to_string(visibleCount) + " visible):    " + std::to_string(frustumMilliseconds) + " ms (linear SIMD cull: " +
+                std::to_string(linearMilliseconds) + " ms)" +
+                "\n  ray casts:                         " + std::to_string(raysPerSecond) + " /s (" + std::to_string(hits) + " of " + std::to_string(rayQueries) + " hit)" +
+                "\n  overlap queries:                   " + std::to_string(overlapsPerSecond) + " /s",
+            Logging::LOG_TYPE::INFO, Logging::LOG_PRIORITY::HIGH);
+    }
+}
@@ -0,0 +1,88 @@
+#include "benchmark/benchmark.h"
+#include "rendering/lighting/light_manager.h"
+#include "utils/thread_pool/thread_pool.h"
+#include "utils/logging/logging.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <random>
+
+// the resolution the per pixel light counts are sampled at
+static const unsigned int LIGHT_SAMPLE_WIDTH = 160;
+static const unsigned int LIGHT_SAMPLE_HEIGHT = 90;
+
+void Benchmark::runClusteredLightingBenchmark(const std::vector<unsigned int> &light_counts, unsigned int iterations)
+{
+    // a camera looking across a floor covered in small point lights
+    const float nearPlane = 0.1f, farPlane = 100.0f;
+    glm::vec3 cameraPosition = glm::vec3(0.0f, 4.0f, 0.0f);
+    glm::mat4 view = glm::lookAt(cameraPosition, glm::vec3(0.0f, 0.0f, -20.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, nearPlane, farPlane);
+    glm::mat4 inverseView = glm::inverse(view);
+
+    // the floor position seen through each sampled pixel (rays that miss the floor are skipped)
+    std::vector<glm::vec3> floorPoints;
+    for (unsigned int y = 0; y < LIGHT_SAMPLE_HEIGHT; y++)
+        for (unsigned int x = 0; x < LIGHT_SAMPLE_WIDTH; x++)
+        {
+            float ndcX = (x + 0.5f) / LIGHT_SAMPLE_WIDTH * 2.0f - 1.0f, ndcY = (y + 0.5f) / LIGHT_SAMPLE_HEIGHT * 2.0f - 1.0f;
+            glm::vec3 direction = glm::vec3(inverseView * glm::vec4(ndcX / projection[0][0], ndcY / projection[1][1], -1.0f, 0.0f));
+            if (direction.y >= 0.0f)
+                continue;
+            glm::vec3 point = cameraPosition + direction * (-cameraPosition.y / direction.y);
+            float depth = -(view * glm::vec4(point, 1.0f)).z;
+            if (depth < farPlane)
+                floorPoints.push_back(point);
+        }
+
+    ThreadPool threadPool;
+    for (unsigned int lightCount : light_counts)
+    {
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> across(-60.0f, 60.0f), depth(-100.0f, 0.0f), height(0.2f, 1.5f), colour(0.2f, 1.0f);
+        LightManager lightManager(threadPool);
+        for (unsigned int i = 0; i < lightCount; i++)
+        {
+            PointLightData light = PointLightData();
+            light.position = glm::vec3(across(random), height(random), depth(random));
+            light.constant = 1.0f;
+            light.linear = 0.7f;
+            light.quadratic = 1.8f;
+            light.ambient = glm::vec3(0.0f);
+            light.diffuse = glm::vec3(colour(random), colour(random), colour(random));
+            light.specular = light.diffuse;
+            lightManager.addLight(light);
+        }
+
+        float buildMilliseconds = 0.0f;
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            lightManager.buildClusters(view, projection, nearPlane, farPlane, 1280.0f, 720.0f);
+            buildMilliseconds += lightManager.getStats().buildMilliseconds;
+        }
+
+        // the lights each pixel's cluster lists against the lights that actually reach it
+        size_t listed = 0, affecting = 0, maxListed = 0;
+        const std::vector<uint32_t> &lightIndices = lightManager.getLightIndices();
+        for (const glm::vec3 &point : floorPoints)
+        {
+            LightCluster cluster = lightManager.getCluster(point);
+            listed += cluster.count;
+            maxListed = std::max<size_t>(maxListed, cluster.count);
+            for (uint32_t i = 0; i < cluster.count; i++)
+            {
+                const ClusteredPointLight &light = lightManager.getLight(lightIndices[cluster.offset + i]);
+                if (glm::length(light.position - point) <= light.radius)
+                    affecting++;
+            }
+        }
+        LightClusterStats stats = lightManager.getStats();
+        float samples = (float)std::max<size_t>(floorPoints.size(), 1);
+        LOG("Clustered lighting benchmark (" + std::to_string(lightCount) + " lights, " + std::to_string(stats.visibleLights) + " in the depth range, " +
+                std::to_string(iterations) + " iterations, " + std::to_string(threadPool.getThreadCount() + 1) + " threads):" +
+                "\n  build:  " + std::to_string(buildMilliseconds / iterations) + " ms/frame (" + std::to_string(stats.lightIndexCount) + " indices, " +
+                std::to_string(stats.occupiedClusters) + " occupied clusters, at most " + std::to_string(stats.maxLightsPerCluster) + " lights in one)" +
+                "\n  lights per pixel: " + std::to_string(listed / samples) + " looped over, " + std::to_string(affecting / samples) + " in range (at most " +
+                std::to_string(maxListed) + ", forward would loop over all " + std::to_string(lightCount) + ")",
+            Logging::LOG_TYPE::INFO, Logging::LOG_PRIORITY::HIGH);
+    }
+}
@@ -0,0 +1,44 @@
+#include "benchmark/benchmark.h"
+#include "rendering/culling/frustum.h"
+#include "utils/logging/logging.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <random>
+
+void Benchmark::runFrustumCullingBenchmark(unsigned int object_count, unsigned int iterations)
+{
+    // scatter boxes through a cube around a camera looking down -z, so a small fraction of them are in view
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f), size(0.5f, 5.0f);
+    CullingBounds bounds;
+    for (unsigned int i = 0; i < object_count; i++)
+    {
+        glm::vec3 centre = glm::vec3(position(random), position(random), position(random));
+        glm::vec3 extents = glm::vec3(size(random), size(random), size(random));
+        bounds.add({centre - extents, centre + extents});
+    }
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    Frustum frustum(projection * view);
+
+    std::vector<uint8_t> visible;
+    size_t scalarVisible = 0, simdVisible = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < iterations; i++)
+        scalarVisible = frustum.cullScalar(bounds, visible);
+    auto scalarEnd = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < iterations; i++)
+        simdVisible = frustum.cull(bounds, visible);
+    auto simdEnd = std::chrono::steady_clock::now();
+
+    double scalarMilliseconds = std::chrono::duration<double, std::milli>(scalarEnd - start).count() / iterations;
+    double simdMilliseconds = std::chrono::duration<double, std::milli>(simdEnd - scalarEnd).count() / iterations;
+    if (scalarVisible != simdVisible)
+        LOG("Scalar and SIMD frustum culling disagree: " + std::to_string(scalarVisible) + " vs " + std::to_string(simdVisible) + " visible",
+            Logging::LOG_TYPE::ERROR);
+
+    LOG("Frustum culling benchmark (" + std::to_string(object_count) + " boxes, " + std::to_string(simdVisible) + " visible, " + std::to_string(iterations) + " iterations):" +
+            "\n  one at a time: " + std::to_string(scalarMilliseconds) + " ms/frame" +
+            "\n  4 at a time:   " + std::to_string(simdMilliseconds) + " ms/frame",
+        Logging::LOG_TYPE::INFO, Logging::LOG_PRIORITY::HIGH);
+}
@@ -0,0 +1,69 @@
+#include "benchmark/benchmark.h"
+#include "rendering/render_queue/render_queue.h"
+#include "rendering/render_queue/indirect_renderer.h"
+#include "utils/logging/logging.h"
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <random>
+
+void Benchmark::runIndirectDrawBenchmark(ShaderVariants &shader_variants, ShaderVariants &indirect_shader_variants, UniformBlock<PerObjectBlock> &per_object_block,
+                                         const std::vector<unsigned int> &draw_counts, unsigned int iterations)
+{
+    if (!IndirectRenderer::isSupported())
+    {
+        LOG("Skipping the indirect draw benchmark - multi draw indirect is not supported", Logging::LOG_TYPE::WARNING);
+        return;
+    }
+
+    // a small untextured cube, so the GPU work stays small next to the submission cost being measured
+    std::vector<Vertex> vertices;
+    for (int corner = 0; corner < 8; corner++)
+    {
+        glm::vec3 position = glm::vec3(corner & 1 ? 0.5f : -0.5f, corner & 2 ? 0.5f : -0.5f, corner & 4 ? 0.5f : -0.5f);
+        vertices.push_back({position, glm::normalize(position), glm::vec2(0.0f)});
+    }
+    std::vector<unsigned int> indices = {0, 1, 3, 0, 3, 2, 4, 6, 7, 4, 7, 5, 0, 4, 5, 0, 5, 1, 2, 3, 7, 2, 7, 6, 0, 2, 6, 0, 6, 4, 1, 5, 7, 1, 7, 3};
+    Mesh cube(vertices, indices, {}, 32.0f);
+    Shader &shader = shader_variants.getVariant(cube.getShaderPermutation());
+    Shader &indirectShader = indirect_shader_variants.getVariant(cube.getShaderPermutation());
+
+    IndirectRenderer indirectRenderer;
+    indirectRenderer.addMesh(cube);
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+    std::string results;
+    for (unsigned int drawCount : draw_counts)
+    {
+        RenderQueue queue(100.0f), indirectQueue(100.0f);
+        for (unsigned int i = 0; i < drawCount; i++)
+        {
+            glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(position(random), position(random), -50.0f + position(random))), glm::vec3(0.1f));
+            queue.submit(cube, shader, model, RENDER_PASS::OPAQUE, 0.0f);
+            indirectQueue.submit(cube, indirectShader, model, RENDER_PASS::OPAQUE, 0.0f);
+        }
+        queue.sort();
+        indirectQueue.sort();
+
+        // only the time to issue the calls is counted - the GPU is drained between frames so a full command queue does not block them
+        double directMilliseconds = 0.0, indirectMilliseconds = 0.0;
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            queue.execute(per_object_block);
+            directMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            glFinish();
+
+            start = std::chrono::steady_clock::now();
+            indirectRenderer.execute(indirectQueue);
+            indirectMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            glFinish();
+        }
+        results += "\n  " + std::to_string(drawCount) + " draws: glDrawElements " + std::to_string(directMilliseconds / iterations) + " ms/frame, " +
+                   "multi draw indirect " + std::to_string(indirectMilliseconds / iterations) + " ms/frame (" +
+                   std::to_string(indirectRenderer.getStats().multiDrawCalls) + " calls)";
+    }
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    LOG("Indirect draw benchmark (CPU submit time, " + std::to_string(iterations) + " iterations):" + results, Logging::LOG_TYPE::INFO, Logging::LOG_PRIORITY::HIGH);
+}
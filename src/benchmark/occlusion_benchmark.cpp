@@ -0,0 +1,60 @@
+#include "benchmark/benchmark.h"
+#include "rendering/culling/frustum.h"
+#include "rendering/culling/occlusion_culler.h"
+#include "utils/thread_pool/thread_pool.h"
+#include "utils/logging/logging.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <random>
+
+void Benchmark::runOcclusionCullingBenchmark(unsigned int occluder_count, unsigned int object_count, unsigned int iterations)
+{
+    // a city of thin walls in front of a camera looking down -z, with small objects scattered between and behind them
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> across(-60.0f, 60.0f), depth(-100.0f, -5.0f), height(-2.0f, 2.0f), size(0.2f, 1.0f);
+    std::vector<OccluderMesh> occluderMeshes;
+    for (unsigned int i = 0; i < occluder_count; i++)
+    {
+        glm::vec3 centre = glm::vec3(across(random), 0.0f, depth(random));
+        occluderMeshes.push_back(OccluderMesh::fromBox({centre - glm::vec3(4.0f, 4.0f, 0.25f), centre + glm::vec3(4.0f, 4.0f, 0.25f)}));
+    }
+    std::vector<AABB> objects;
+    for (unsigned int i = 0; i < object_count; i++)
+    {
+        glm::vec3 centre = glm::vec3(across(random), height(random), depth(random));
+        objects.push_back({centre - glm::vec3(size(random)), centre + glm::vec3(size(random))});
+    }
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    Frustum frustum(projection * view);
+
+    // only objects inside the frustum reach the occlusion test
+    std::vector<AABB> inFrustum;
+    for (const AABB &object : objects)
+        if (frustum.isVisible(object))
+            inFrustum.push_back(object);
+
+    ThreadPool threadPool;
+    OcclusionCuller culler(threadPool);
+    std::vector<uint8_t> visible;
+    size_t visibleCount = 0;
+    float rasterMilliseconds = 0.0f, testMilliseconds = 0.0f;
+    OcclusionStats stats = OcclusionStats();
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        culler.beginFrame(projection * view);
+        for (const OccluderMesh &occluder : occluderMeshes)
+            culler.addOccluder(occluder, glm::mat4(1.0f));
+        culler.rasterize();
+        visibleCount = culler.cull(inFrustum, visible);
+        stats = culler.getStats();
+        rasterMilliseconds += stats.rasterMilliseconds;
+        testMilliseconds += stats.testMilliseconds;
+    }
+
+    LOG("Occlusion culling benchmark (" + std::to_string(occluder_count) + " occluders, " + std::to_string(object_count) + " objects, " +
+            std::to_string(inFrustum.size()) + " in the frustum, " + std::to_string(iterations) + " iterations, " + std::to_string(threadPool.getThreadCount() + 1) + " threads):" +
+            "\n  rasterise: " + std::to_string(rasterMilliseconds / iterations) + " ms/frame (" + std::to_string(stats.trianglesDrawn) + " triangles)" +
+            "\n  test:      " + std::to_string(testMilliseconds / iterations) + " ms/frame (" + std::to_string(visibleCount) + " visible)",
+        Logging::LOG_TYPE::INFO, Logging::LOG_PRIORITY::HIGH);
+}
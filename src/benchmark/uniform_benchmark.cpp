@@ -0,0 +1,48 @@
+#include "benchmark/benchmark.h"
+#include "utils/logging/logging.h"
+#include <chrono>
+#include <functional>
+
+/// @brief time a function run a number of times
+/// @param iterations the number of times to call the function
+/// @param function the function to time - receives the current iteration
+/// @return the average time per call in nanoseconds
+static double timePerCall(unsigned int iterations, const std::function<void(unsigned int)> &function)
+{
+    glFinish(); // don't count work queued before we started
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < iterations; i++)
+        function(i);
+    glFinish();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+void Benchmark::runUniformBenchmark(Shader &shader, const std::string &uniform_name, unsigned int iterations)
+{
+    shader.use();
+    UniformHandle handle = shader.getUniformHandle(uniform_name);
+    if (!handle.isValid())
+    {
+        LOG("Cannot benchmark uniform " + uniform_name + " as it is not active in the shader", Logging::LOG_TYPE::ERROR);
+        return;
+    }
+
+    // the values alternate so the driver can't skip redundant updates
+    double queryEveryCall = timePerCall(iterations, [&](unsigned int i)
+                                        { glUniform1f(glGetUniformLocation(shader.program_ID, uniform_name.c_str()), (float)(i & 1)); });
+    double cachedByName = timePerCall(iterations, [&](unsigned int i)
+                                      { shader.setUniform(uniform_name, (float)(i & 1)); });
+    double byHandle = timePerCall(iterations, [&](unsigned int i)
+                                  { shader.setUniform(handle, (float)(i & 1)); });
+    // the same value every call, so the shadow copy skips the upload
+    double unchanged = timePerCall(iterations, [&](unsigned int)
+                                   { shader.setUniform(handle, 1.0f); });
+
+    LOG("setUniform benchmark (" + std::to_string(iterations) + " iterations of " + uniform_name + "):" +
+            "\n  glGetUniformLocation every call: " + std::to_string(queryEveryCall) + " ns/call" +
+            "\n  cached location by name:        " + std::to_string(cachedByName) + " ns/call" +
+            "\n  UniformHandle:                  " + std::to_string(byHandle) + " ns/call" +
+            "\n  UniformHandle, unchanged value: " + std::to_string(unchanged) + " ns/call",
+        Logging::LOG_TYPE::INFO, Logging::LOG_PRIORITY::HIGH);
+}
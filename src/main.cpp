@@ -31,15 +31,37 @@
 #include "rendering/texture/texture_manager.h"
 #include "utils/logging/logging.h"
 #include "utils/text_reading/text_reading.h"
+#include "rendering/sampler/sampler.h"
+#include "rendering/capabilities/gl_capabilities.h"
+#include "benchmark/benchmark.h"
+#include "rendering/uniform_blocks/uniform_blocks.h"
+#include "rendering/shader/program_cache.h"
+#include "rendering/shader/shader_variants.h"
+#include "rendering/shader/shader_source_cache.h"
+#include "rendering/render_queue/render_queue.h"
+#include "rendering/render_queue/indirect_renderer.h"
+#include "rendering/buffer/dynamic_buffer/dynamic_buffer.h"
+#include "rendering/state_cache/gl_state_cache.h"
+#include "rendering/culling/frustum.h"
+#include "rendering/culling/occlusion_culler.h"
+#include "rendering/lighting/light_manager.h"
+#include "rendering/deferred/deferred_renderer.h"
+#include "rendering/context/headless_context.h"
+#include "rendering/frame/frame_snapshot.h"
+#include "rendering/profiler/gpu_profiler.h"
+#include "utils/frame_exchange/frame_exchange.h"
+#include "utils/thread_pool/thread_pool.h"
+#include <string>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
 
-/// @brief a callback for when the window is resized
-/// @param window the glfw window
-/// @param width the new width
-/// @param height the new height
-void framebuffer_size_callback(GLFWwindow *window, int width, int height)
-{
-    glViewport(0, 0, width, height); // tell opengl the new window size (if changed)
-}
+/// @brief the simulated time between frames in headless mode (fixed, so every run draws the same frames)
+const float HEADLESS_FRAME_TIME = 1.0f / 60.0f;
 
 /// @brief initialise glfw
 /// @return a pointer to the glfw window
@@ -70,7 +92,34 @@ void init_glad()
         LOG("Failed to load GLAD", Logging::LOG_TYPE::ERROR);
 }
 
-int main()
+/// @brief check if an argument was passed on the command line
+/// @param argc the number of arguments
+/// @param argv the arguments
+/// @param argument the argument to look for (i.e. --benchmark-uniforms)
+/// @return true if the argument was passed
+bool hasArgument(int argc, char **argv, const std::string &argument)
+{
+    for (int i = 1; i < argc; i++)
+        if (argument == argv[i])
+            return true;
+    return false;
+}
+
+/// @brief get the value passed after an argument on the command line
+/// @param argc the number of arguments
+/// @param argv the arguments
+/// @param argument the argument to look for (i.e. --frames)
+/// @param default_value the value if the argument was not passed
+/// @return the value
+std::string getArgumentValue(int argc, char **argv, const std::string &argument, const std::string &default_value)
+{
+    for (int i = 1; i + 1 < argc; i++)
+        if (argument == argv[i])
+            return argv[i + 1];
+    return default_value;
+}
+
+int main(int argc, char **argv)
 {
     Logging::set_minimum_priority(Logging::LOG_PRIORITY::MEDIUM);
     LOG("\n" +
@@ -79,12 +128,26 @@ int main()
         Logging::LOG_TYPE::INFO,
         Logging::LOG_PRIORITY::HIGH);
 
-    std::shared_ptr<GLFWwindow> window = init_glfw();
-    init_glad();
+    // --headless draws a fixed number of frames (--frames) into an offscreen framebuffer with no window, then exits
+    bool headless = hasArgument(argc, argv, "--headless");
+    unsigned int headlessFrames = (unsigned int)std::max(1, std::atoi(getArgumentValue(argc, argv, "--frames", "300").c_str()));
+    std::string headlessScreenshotPath = getArgumentValue(argc, argv, "--screenshot", ""); // where to save the last headless frame (PPM)
+    std::unique_ptr<HeadlessContext> headlessContext;
+    std::shared_ptr<GLFWwindow> window;
+    if (headless)
+    {
+        headlessContext = std::make_unique<HeadlessContext>(SRC_WIDTH, SRC_HEIGHT);
+        if (!headlessContext->isValid())
+            return 1;
+    }
+    else
+    {
+        window = init_glfw();
+        init_glad();
+    }
 
     glEnable(GL_DEPTH_TEST);
     glViewport(0, 0, SRC_WIDTH, SRC_HEIGHT);
-    glfwSetFramebufferSizeCallback(window.get(), framebuffer_size_callback);
 
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
@@ -95,11 +158,72 @@ int main()
     ImGui::StyleColorsDark();
 
     // Set Up Rendering
-    Shader shader("shaders/test_phong.vert", "shaders/test_phong.frag");
+    // every phong variant shares the point light count of the Lights block
+    ShaderVariants phongShaders("shaders/test_phong.vert", "shaders/test_phong.frag",
+                                ShaderPermutation().setDefine("NR_POINT_LIGHTS", std::to_string(MAX_POINT_LIGHTS)));
+    std::vector<ShaderPermutation> materialPermutations = {
+        ShaderPermutation(),
+        ShaderPermutation().addFeature(SHADER_FEATURE_DIFFUSE_MAP),
+        ShaderPermutation().addFeature(SHADER_FEATURE_SPECULAR_MAP),
+        ShaderPermutation().addFeature(SHADER_FEATURE_DIFFUSE_MAP).addFeature(SHADER_FEATURE_SPECULAR_MAP)};
+    // --serial-shaders builds each variant to completion one after another (the old behaviour) for comparison
+    bool serialShaders = hasArgument(argc, argv, "--serial-shaders");
+    if (serialShaders)
+        for (const ShaderPermutation &permutation : materialPermutations)
+            phongShaders.getVariant(permutation);
+    else
+        phongShaders.submit(materialPermutations); // the driver can compile these while the model loads
 
     // test: load model
     Model modelObj("models/backpack/backpack.obj");
 
+    // finish the material variants and build any others the model needs before the first frame
+    phongShaders.finishBuilds();
+    phongShaders.precompile(modelObj.getShaderPermutations());
+
+    // the same shaders reading per draw data from an SSBO, for multi draw indirect submission (where supported)
+    std::unique_ptr<ShaderVariants> indirectPhongShaders;
+    if (IndirectRenderer::isSupported())
+    {
+        indirectPhongShaders = std::make_unique<ShaderVariants>("shaders/indirect_phong.vert", "shaders/test_phong.frag",
+                                                                ShaderPermutation().setDefine("NR_POINT_LIGHTS", std::to_string(MAX_POINT_LIGHTS)));
+        indirectPhongShaders->precompile(modelObj.getShaderPermutations());
+    }
+    else
+        LOG("Multi draw indirect is not supported - drawing one mesh at a time", Logging::LOG_TYPE::WARNING);
+    // the same shaders looping over only the point lights in each fragment's cluster (where supported)
+    std::unique_ptr<ShaderVariants> clusteredPhongShaders;
+    if (LightManager::isSupported())
+    {
+        clusteredPhongShaders = std::make_unique<ShaderVariants>("shaders/test_phong.vert", "shaders/clustered_phong.frag",
+                                                                 ShaderPermutation().setDefine("NR_POINT_LIGHTS", std::to_string(MAX_POINT_LIGHTS)));
+        clusteredPhongShaders->precompile(modelObj.getShaderPermutations());
+    }
+    else
+        LOG("Clustered lighting requires OpenGL 4.3 - clustered lighting is disabled", Logging::LOG_TYPE::WARNING);
+    // the geometry pass of the deferred path writes the same materials into the G-buffer
+    ShaderVariants gBufferShaders("shaders/test_phong.vert", "shaders/gbuffer.frag");
+    gBufferShaders.precompile(modelObj.getShaderPermutations());
+    ShaderStartupStats shaderStats = ProgramCache::getStartupStats();
+    LOG(std::string("Shader startup (") + (serialShaders ? "serial" : "batched") + "): " +
+            std::to_string(shaderStats.programsCompiled) + " compiled (" + std::to_string(shaderStats.compileMilliseconds) + " ms blocking), " +
+            std::to_string(shaderStats.programsLoadedFromCache) + " loaded from cache (" + std::to_string(shaderStats.cacheLoadMilliseconds) + " ms)",
+        Logging::LOG_TYPE::INFO, Logging::LOG_PRIORITY::HIGH);
+
+    if (hasArgument(argc, argv, "--benchmark-uniforms"))
+    {
+        Shader &benchmarkShader = phongShaders.getVariant(materialPermutations.back());
+        Benchmark::runUniformBenchmark(benchmarkShader, "material.shininess", 1000000);
+    }
+    if (hasArgument(argc, argv, "--benchmark-culling"))
+        Benchmark::runFrustumCullingBenchmark(100000, 100);
+    if (hasArgument(argc, argv, "--benchmark-bvh"))
+        Benchmark::runBVHBenchmark({10000, 100000, 1000000});
+    if (hasArgument(argc, argv, "--benchmark-occlusion"))
+        Benchmark::runOcclusionCullingBenchmark(200, 100000, 100);
+    if (hasArgument(argc, argv, "--benchmark-lights"))
+        Benchmark::runClusteredLightingBenchmark({256, 1024, 4096, 16384}, 50);
+
     // Setup Camera
     CameraParams cameraParams(glm::vec3(0.0f, 0.0f, 0.0f), 0.0f, 0.0f, 2.0f, 0.1f, 45.0f);
     Camera camera = Camera(cameraParams);
@@ -107,7 +231,8 @@ int main()
     // Input Handling
     float delta; // the time between frames
     bool mouse_active = false;
-    MouseTracker::initialise(window);
+    if (!headless)
+        MouseTracker::initialise(window);
     SignalHandler<MouseData> mouseHandler(
         [&camera, &mouse_active, &io](MouseData mouseData)
         { 
@@ -119,7 +244,8 @@ int main()
         });
     MouseTracker::getOnMouseMovedSignal().addHandler(mouseHandler);
 
-    KeyTracker::initialise(window);
+    if (!headless)
+        KeyTracker::initialise(window);
     SignalHandler<KeyData> keyEventHandler(
         [&window, &mouse_active, &io](KeyData keyData)
         {
@@ -165,75 +291,450 @@ int main()
 
     DeltaTracker deltaTracker;
 
-    // we only need to set some uniforms for the guitar shader once
-    shader.use();
-    shader.setUniform("dirLight.direction", glm::vec3(0.1f, -1.0f, 0.1f));
-    shader.setUniform("dirLight.ambient", glm::vec3(0.02f, 0.02f, 0.02f));
-    shader.setUniform("dirLight.diffuse", glm::vec3(0.5f, 0.5f, 0.5f));
-    shader.setUniform("dirLight.specular", glm::vec3(0.50f, 0.5f, 0.5f));
+    // the uniform blocks shared by every shader
+    UniformBlock<PerFrameBlock> perFrameBlock(UniformBlockBinding::PER_FRAME);
+    UniformBlock<LightsBlock> lightsBlock(UniformBlockBinding::LIGHTS);
+    UniformBlock<PerObjectBlock> perObjectBlock(UniformBlockBinding::PER_OBJECT);
+
+    // the lights do not move, so we only need to upload them once
+    lightsBlock.data.dirLight.direction = glm::vec3(0.1f, -1.0f, 0.1f);
+    lightsBlock.data.dirLight.ambient = glm::vec3(0.02f, 0.02f, 0.02f);
+    lightsBlock.data.dirLight.diffuse = glm::vec3(0.5f, 0.5f, 0.5f);
+    lightsBlock.data.dirLight.specular = glm::vec3(0.50f, 0.5f, 0.5f);
 
     glm::vec3 lightSourcePosition = glm::vec3(0.0f, 0.0f, 0.0f);
-    shader.setUniform("pointLights[0].position", glm::vec3(lightSourcePosition));
-    shader.setUniform("pointLights[0].constant", 1.0f);
-    shader.setUniform("pointLights[0].linear", 0.09f);
-    shader.setUniform("pointLights[0].quadratic", 0.032f);
-    shader.setUniform("pointLights[0].ambient", glm::vec3(0.05f, 0.05f, 0.05f));
-    shader.setUniform("pointLights[0].diffuse", glm::vec3(0.8f, 0.8f, 0.8f));
-    shader.setUniform("pointLights[0].specular", glm::vec3(1.0f, 1.0f, 1.0f));
+    lightsBlock.data.pointLights[0].position = lightSourcePosition;
+    lightsBlock.data.pointLights[0].constant = 1.0f;
+    lightsBlock.data.pointLights[0].linear = 0.09f;
+    lightsBlock.data.pointLights[0].quadratic = 0.032f;
+    lightsBlock.data.pointLights[0].ambient = glm::vec3(0.05f, 0.05f, 0.05f);
+    lightsBlock.data.pointLights[0].diffuse = glm::vec3(0.8f, 0.8f, 0.8f);
+    lightsBlock.data.pointLights[0].specular = glm::vec3(1.0f, 1.0f, 1.0f);
+    lightsBlock.data.pointLightCount = 1;
+    lightsBlock.upload();
 
     // Setup Platform/Renderer backends
-    ImGui_ImplGlfw_InitForOpenGL(window.get(), true); // Second param install_callback=true will install GLFW callbacks and chain to existing ones.
+    if (headless)
+        io.DisplaySize = ImVec2((float)SRC_WIDTH, (float)SRC_HEIGHT); // there is no window for the GLFW backend to size ImGui from
+    else
+        ImGui_ImplGlfw_InitForOpenGL(window.get(), true); // Second param install_callback=true will install GLFW callbacks and chain to existing ones.
     ImGui_ImplOpenGL3_Init();
 
+    RenderQueue renderQueue(100.0f); // sorts each frame's draws to minimise state changes (depths are quantised up to the far plane)
+    // each draw's per object block is written to its own range of a persistently mapped ring (room for 4096 draws a frame)
+    std::unique_ptr<DynamicBuffer> perObjectRing;
+    if (DynamicBuffer::isSupported())
+        perObjectRing = std::make_unique<DynamicBuffer>(GL_UNIFORM_BUFFER, 4096 * std::max<GLsizeiptr>(sizeof(PerObjectBlock), GLCapabilities::getUniformBufferOffsetAlignment()));
+    std::unique_ptr<IndirectRenderer> indirectRenderer = indirectPhongShaders ? std::make_unique<IndirectRenderer>() : nullptr;
+    DeferredRenderer deferredRenderer(SRC_WIDTH, SRC_HEIGHT, LightManager::isSupported()); // shades the scene from a G-buffer, beside the forward path
+    if (indirectRenderer && hasArgument(argc, argv, "--benchmark-indirect"))
+        Benchmark::runIndirectDrawBenchmark(phongShaders, *indirectPhongShaders, perObjectBlock, {1000, 10000, 100000}, 20);
+    ThreadPool threadPool;
+    TextureManager::setThreadPool(&threadPool); // streamed mip levels are decoded off the render thread
+    OcclusionCuller occlusionCuller(threadPool); // hides meshes behind other meshes
+    // the renderer options, picked in the UI on the main thread and applied by the render thread
+    FrameSettings settings = FrameSettings();
+    settings.deferredShading = false;
+    settings.occlusionCulling = true;
+    settings.parallelBuild = true;
+    settings.indirectDrawing = indirectRenderer != nullptr;
+    settings.clusteredLighting = false;
+    settings.clusteredLightCount = 256;
+    settings.anisotropy = SamplerCache::getAnisotropy();
+    settings.trilinearFiltering = SamplerCache::getTrilinearFiltering();
+    float maxAnisotropy = GLCapabilities::getMaxAnisotropy(); // queried here, while the main thread still has the context
+    // many small point lights orbiting the model, binned into clusters each frame
+    std::unique_ptr<LightManager> lightManager = clusteredPhongShaders ? std::make_unique<LightManager>(threadPool) : nullptr;
+    auto addOrbitingLights = [&lightManager](int light_count)
+    {
+        lightManager->clearLights();
+        for (int i = 0; i < light_count; i++)
+        {
+            PointLightData light = PointLightData();
+            light.constant = 1.0f;
+            light.linear = 0.7f;
+            light.quadratic = 1.8f;
+            light.ambient = glm::vec3(0.0f);
+            light.diffuse = 0.3f * glm::vec3(0.5f + 0.5f * std::cos(i * 0.7f), 0.5f + 0.5f * std::cos(i * 1.3f + 2.0f), 0.5f + 0.5f * std::cos(i * 2.1f + 4.0f));
+            light.specular = light.diffuse;
+            lightManager->addLight(light);
+        }
+    };
+    if (lightManager)
+        addOrbitingLights(settings.clusteredLightCount);
+
+    // times each frame and its passes on the GPU (--gpu-profile path also writes every frame's times to a CSV file)
+    GPUProfiler gpuProfiler;
+    std::string gpuProfilePath = getArgumentValue(argc, argv, "--gpu-profile", "");
+    if (!gpuProfilePath.empty())
+        gpuProfiler.openDump(gpuProfilePath);
+
+    // the backend creates its device objects (and the font atlas ImGui::NewFrame needs) on its first frame, which needs the context
+    ImGui_ImplOpenGL3_NewFrame();
+
+    // the main thread polls events, moves the camera and builds the UI, then hands each frame's snapshot to the render thread, which owns
+    // the context - so a slow frame on one thread does not hold up the other (--single-thread draws each frame on the main thread instead)
+    bool singleThreaded = hasArgument(argc, argv, "--single-thread");
+    FrameExchange<FrameSnapshot> frameExchange;
+    std::mutex renderStatsMutex;
+    RenderThreadStats renderStats = RenderThreadStats(); // the stats of the last frame drawn (guarded by renderStatsMutex)
+    double lastShaderPollTime = 0.0;                      // when we last checked shader files for edits (render thread)
+    std::vector<float> headlessFrameMilliseconds;         // the time each headless frame took, including the GPU's work (render thread)
+
+    auto makeContextCurrent = [&headless, &headlessContext, &window](bool current)
+    {
+        if (headless)
+            current ? headlessContext->makeCurrent() : headlessContext->releaseCurrent();
+        else
+            glfwMakeContextCurrent(current ? window.get() : nullptr);
+    };
+
+    // draw one frame from its snapshot (on the thread that owns the context)
+    auto renderFrame = [&](FrameSnapshot &frame)
+    {
+        auto frameStart = std::chrono::steady_clock::now();
+        gpuProfiler.beginFrame();
+        const FrameSettings &frameSettings = frame.settings;
+        if (frameSettings.anisotropy != SamplerCache::getAnisotropy())
+            SamplerCache::setAnisotropy(frameSettings.anisotropy);
+        if (frameSettings.trilinearFiltering != SamplerCache::getTrilinearFiltering())
+            SamplerCache::setTrilinearFiltering(frameSettings.trilinearFiltering);
+
+        // hot reload: once a second, rebuild exactly the shaders that use an edited file
+        if (frame.time - lastShaderPollTime > 1.0)
+        {
+            lastShaderPollTime = frame.time;
+            std::set<std::string> affectedShaderFiles = ShaderSourceCache::pollChanges();
+            if (!affectedShaderFiles.empty())
+            {
+                phongShaders.reload(affectedShaderFiles);
+                if (indirectPhongShaders)
+                    indirectPhongShaders->reload(affectedShaderFiles);
+                if (clusteredPhongShaders)
+                    clusteredPhongShaders->reload(affectedShaderFiles);
+                gBufferShaders.reload(affectedShaderFiles);
+                deferredRenderer.reload(affectedShaderFiles);
+            }
+        }
+
+        glViewport(0, 0, frame.framebufferWidth, frame.framebufferHeight);
+        perFrameBlock.data.view = frame.view;
+        perFrameBlock.data.projection = frame.projection;
+        perFrameBlock.data.viewPos = frame.viewPosition;
+        perFrameBlock.data.time = (float)frame.time;
+        perFrameBlock.upload();
+
+        if (frameSettings.clusteredLighting)
+        {
+            if ((int)lightManager->getLightCount() != frameSettings.clusteredLightCount)
+                addOrbitingLights(frameSettings.clusteredLightCount);
+            for (size_t i = 0; i < lightManager->getLightCount() && i < frame.lightPositions.size(); i++)
+                lightManager->setLightPosition(i, frame.lightPositions[i]);
+            lightManager->buildClusters(frame.view, frame.projection, 0.1f, 100.0f, (float)frame.framebufferWidth, (float)frame.framebufferHeight);
+            gpuProfiler.beginScope("Light upload");
+            lightManager->upload();
+            gpuProfiler.endScope();
+        }
+
+        checkGLError("BEFORE MODEL DRAW");
+        modelObj.requestTextureDetail(frame.model, frame.viewPosition, frame.projection, (float)frame.framebufferHeight);
+        auto buildStart = std::chrono::steady_clock::now();
+        renderQueue.clear();
+        occlusionCuller.beginFrame(frame.projection * frame.view);
+        if (frameSettings.occlusionCulling)
+        {
+            modelObj.addOccluders(occlusionCuller, frame.model);
+            occlusionCuller.rasterize();
+        }
+        // clustered lighting and deferred shading draw through the render queue (the indirect shaders use the Lights block)
+        bool frameIndirect = indirectRenderer && frameSettings.indirectDrawing && !frameSettings.clusteredLighting && !frameSettings.deferredShading;
+        ShaderVariants &frameShaders = frameSettings.deferredShading     ? gBufferShaders
+                                       : frameSettings.clusteredLighting ? *clusteredPhongShaders
+                                       : frameIndirect                   ? *indirectPhongShaders
+                                                                         : phongShaders;
+        Frustum frustum = Frustum(frame.projection * frame.view);
+        const OcclusionCuller *frameOccluders = frameSettings.occlusionCulling ? &occlusionCuller : nullptr;
+        CullingStats culling = frameSettings.parallelBuild
+                                   ? modelObj.submitParallel(threadPool, renderQueue, frameShaders, frame.model, frame.view, frustum, frameOccluders)
+                                   : modelObj.submit(renderQueue, frameShaders, frame.model, frame.view, frustum, frameOccluders);
+        renderQueue.sort();
+        float buildMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+        gpuProfiler.beginScope("Scene");
+        gpuProfiler.beginScope(frameSettings.deferredShading ? "Geometry pass" : "Model draw");
+        if (frameSettings.deferredShading)
+            deferredRenderer.beginGeometryPass(frame.framebufferWidth, frame.framebufferHeight);
+        if (frameIndirect)
+            indirectRenderer->execute(renderQueue);
+        else
+        {
+            if (perObjectRing)
+                perObjectRing->beginFrame();
+            renderQueue.execute(perObjectBlock, perObjectRing.get());
+            if (perObjectRing)
+                perObjectRing->endFrame();
+        }
+        if (frameSettings.deferredShading)
+        {
+            deferredRenderer.endGeometryPass();
+            gpuProfiler.endScope();
+            gpuProfiler.beginScope("Lighting pass");
+            deferredRenderer.executeLightingPass(frame.view, frame.projection, frameSettings.clusteredLighting);
+        }
+        gpuProfiler.endScope();
+        gpuProfiler.endScope();
+        TextureManager::updateStreaming();
+
+        // Rendering
+        gpuProfiler.beginScope("ImGui");
+        ImGui_ImplOpenGL3_RenderDrawData(frame.imGui.getDrawData());
+        gpuProfiler.endScope();
+        GLStateCache::invalidate(); // ImGui binds its own program, VAO, buffers and textures directly
+        gpuProfiler.endFrame();
+        if (headless)
+        {
+            headlessContext->endFrame();
+            headlessFrameMilliseconds.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+            if (frame.frameIndex + 1 == headlessFrames && !headlessScreenshotPath.empty())
+                headlessContext->saveImage(headlessScreenshotPath);
+        }
+        else
+            glfwSwapBuffers(window.get()); // swap the buffer we have been drawing to into the front
+
+        // hand this frame's stats to the main thread's UI
+        RenderThreadStats stats = RenderThreadStats();
+        stats.frameMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        stats.buildMilliseconds = buildMilliseconds;
+        stats.textures = TextureManager::getMemoryStats();
+        stats.samplerCount = SamplerCache::getSamplerCount();
+        stats.shaderVariantCount = phongShaders.getVariantCount();
+        stats.culling = culling;
+        stats.occlusion = occlusionCuller.getStats();
+        stats.queue = renderQueue.getStats();
+        if (frameIndirect)
+            stats.indirect = indirectRenderer->getStats();
+        if (frameSettings.clusteredLighting)
+            stats.clusters = lightManager->getStats();
+        if (perObjectRing)
+        {
+            stats.ring = perObjectRing->getStats();
+            stats.ringUsedBytes = perObjectRing->getUsedBytes();
+        }
+        stats.uploads = Shader::getUploadStats();
+        Shader::resetUploadStats();
+        stats.binds = GLStateCache::getStats();
+        GLStateCache::resetStats();
+        const GBuffer &gBuffer = deferredRenderer.getGBuffer();
+        stats.gBufferWidth = gBuffer.getWidth();
+        stats.gBufferHeight = gBuffer.getHeight();
+        stats.gBufferMemory = gBuffer.getMemorySize();
+        stats.gpuFrame = gpuProfiler.getFrameStats();
+        stats.gpuScopes = gpuProfiler.getScopeStats();
+        stats.gpuDroppedFrames = gpuProfiler.getDroppedFrames();
+        {
+            std::lock_guard<std::mutex> lock(renderStatsMutex);
+            renderStats = stats;
+        }
+
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    };
+
+    std::thread renderThread;
+    if (!singleThreaded)
+    {
+        makeContextCurrent(false);
+        renderThread = std::thread([&frameExchange, &renderFrame, &makeContextCurrent]()
+                                   {
+                                       makeContextCurrent(true);
+                                       while (FrameSnapshot *frame = frameExchange.acquire())
+                                           renderFrame(*frame);
+                                       makeContextCurrent(false); });
+    }
+
     // keep doing this loop until user wants to close
-    while (!glfwWindowShouldClose(window.get()))
+    unsigned int frameIndex = 0;
+    float aspectRatio = (float)SRC_WIDTH / (float)SRC_HEIGHT; // kept from the last frame while the window is minimised (a 0x0 framebuffer)
+    while (headless ? frameIndex < headlessFrames : !glfwWindowShouldClose(window.get()))
     {
-        delta = deltaTracker.getDelta();
+        double time = headless ? frameIndex * HEADLESS_FRAME_TIME : glfwGetTime();
+        delta = headless ? HEADLESS_FRAME_TIME : deltaTracker.getDelta();
 
-        glfwPollEvents();
-        KeyTracker::pollKeyEvents();
+        if (!headless)
+        {
+            glfwPollEvents();
+            KeyTracker::pollKeyEvents();
+        }
 
         // imgui
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
+        if (headless)
+            io.DeltaTime = HEADLESS_FRAME_TIME;
+        else
+            ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
         ImGui::ShowDemoWindow(); // Show demo window! :)
 
+        // renderer stats (from the last frame the render thread finished)
+        RenderThreadStats stats;
+        {
+            std::lock_guard<std::mutex> lock(renderStatsMutex);
+            stats = renderStats;
+        }
+        ImGui::Begin("Renderer Stats");
+        ImGui::Text("Frame: %.2f ms (%.1f FPS, %s), render thread: %.2f ms", 1000.0f / io.Framerate, io.Framerate,
+                    settings.deferredShading ? "deferred" : "forward", stats.frameMilliseconds);
+        ImGui::Checkbox("Deferred shading", &settings.deferredShading);
+        if (settings.deferredShading)
+            ImGui::Text("G-buffer: %dx%d (%.2f MiB)", stats.gBufferWidth, stats.gBufferHeight, stats.gBufferMemory / (1024.0f * 1024.0f));
+        ImGui::Text("Texture memory: %.2f / %.2f MiB", stats.textures.residentBytes / (1024.0f * 1024.0f), stats.textures.budgetBytes / (1024.0f * 1024.0f));
+        ImGui::Text("Texture evictions: %u, reloads: %u", stats.textures.evictions, stats.textures.reloads);
+        ImGui::Text("Mip levels streamed in: %u, dropped: %u", stats.textures.mipLevelsStreamedIn, stats.textures.mipLevelsDropped);
+        ImGui::Text("Duplicate textures shared: %u (%.2f MiB saved)", stats.textures.duplicateTextures, stats.textures.duplicateBytesSaved / (1024.0f * 1024.0f));
+        ImGui::Text("Samplers: %zu", stats.samplerCount);
+        ImGui::Text("Shader variants: %zu", stats.shaderVariantCount);
+        ImGui::Text("Meshes visible last frame: %u / %u (%u occluded)", stats.culling.visible, stats.culling.total, stats.culling.occluded);
+        ImGui::Checkbox("Occlusion culling", &settings.occlusionCulling);
+        ImGui::Checkbox("Parallel frame build", &settings.parallelBuild);
+        ImGui::Text("Frame build: %.3f ms (cull, encode, merge and sort on %u threads)", stats.buildMilliseconds,
+                    settings.parallelBuild ? threadPool.getThreadCount() + 1 : 1);
+        ImGui::Text("Occluders drawn: %u (%u triangles, %.3f ms), objects rejected: %u / %u", stats.occlusion.occludersDrawn, stats.occlusion.trianglesDrawn,
+                    stats.occlusion.rasterMilliseconds, stats.occlusion.objectsRejected, stats.occlusion.objectsTested);
+        ImGui::Text("Draws last frame: %u (program switches: %u, VAO switches: %u, material switches: %u, texture switches: %u)", stats.queue.draws,
+                    stats.queue.programSwitches, stats.queue.vaoSwitches, stats.queue.materialSwitches, stats.queue.textureSwitches);
+        if (indirectRenderer)
+        {
+            ImGui::Checkbox("Multi draw indirect", &settings.indirectDrawing);
+            if (settings.indirectDrawing && !settings.clusteredLighting && !settings.deferredShading)
+                ImGui::Text("Indirect draws last frame: %u in %u calls (%.3f ms to submit)", stats.indirect.draws, stats.indirect.multiDrawCalls,
+                            stats.indirect.submitMilliseconds);
+        }
+        if (lightManager)
+        {
+            ImGui::Checkbox("Clustered lighting", &settings.clusteredLighting);
+            ImGui::SliderInt("Clustered lights", &settings.clusteredLightCount, 0, 16384);
+            if (settings.clusteredLighting)
+                ImGui::Text("Lights: %u (%u in view depth), %u occupied clusters, %.1f lights per occupied cluster (at most %u), %.3f ms to bin",
+                            stats.clusters.lightCount, stats.clusters.visibleLights, stats.clusters.occupiedClusters,
+                            stats.clusters.occupiedClusters ? (float)stats.clusters.lightIndexCount / stats.clusters.occupiedClusters : 0.0f,
+                            stats.clusters.maxLightsPerCluster, stats.clusters.buildMilliseconds);
+        }
+        if (perObjectRing)
+            ImGui::Text("Per object ring: %.1f KiB used last frame, %u fence waits (%.2f ms), %u overflows", stats.ringUsedBytes / 1024.0f,
+                        stats.ring.fenceWaits, stats.ring.waitMilliseconds, stats.ring.failedAllocations);
+        ImGui::Text("Uniform uploads last frame: %u issued, %u skipped", stats.uploads.issued, stats.uploads.skipped);
+        ImGui::Text("GL binds last frame: %u issued, %u skipped", stats.binds.issued, stats.binds.skipped);
+        ImGui::Text("Shaders compiled: %u (%.2f ms), cached: %u (%.2f ms), rejected: %u", shaderStats.programsCompiled, shaderStats.compileMilliseconds,
+                    shaderStats.programsLoadedFromCache, shaderStats.cacheLoadMilliseconds, shaderStats.binariesRejected);
+        ImGui::SliderFloat("Anisotropy", &settings.anisotropy, 1.0f, maxAnisotropy);
+        ImGui::Checkbox("Trilinear filtering", &settings.trilinearFiltering);
+        ImGui::End();
+
+        // GPU time of each pass over the last few seconds
+        ImGui::Begin("GPU Profiler");
+        ImGui::Text("GPU frame: %.3f ms (average %.3f ms), %u frames dropped", stats.gpuFrame.lastMilliseconds, stats.gpuFrame.averageMilliseconds,
+                    stats.gpuDroppedFrames);
+        if (ImGui::BeginTable("GPU scopes", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Scope");
+            ImGui::TableSetupColumn("Avg ms");
+            ImGui::TableSetupColumn("p50 ms");
+            ImGui::TableSetupColumn("p95 ms");
+            ImGui::TableSetupColumn("p99 ms");
+            ImGui::TableSetupColumn("Max ms");
+            ImGui::TableHeadersRow();
+            for (const GPUScopeStats &scope : stats.gpuScopes)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%*s%s", (int)scope.depth * 2, "", scope.name.c_str());
+                for (float milliseconds : {scope.averageMilliseconds, scope.medianMilliseconds, scope.p95Milliseconds, scope.p99Milliseconds,
+                                           scope.maxMilliseconds})
+                {
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", milliseconds);
+                }
+            }
+            ImGui::EndTable();
+        }
+        ImGui::End();
+
+        // write this frame's snapshot
+        FrameSnapshot &frame = frameExchange.getWriteFrame();
+        frame.frameIndex = frameIndex;
+        frame.time = time;
+        if (headless)
+        {
+            frame.framebufferWidth = headlessContext->getWidth();
+            frame.framebufferHeight = headlessContext->getHeight();
+        }
+        else
+            glfwGetFramebufferSize(window.get(), &frame.framebufferWidth, &frame.framebufferHeight);
+
         // get view matrix
-        glm::mat4 view = camera.getViewMatrix();
+        frame.view = camera.getViewMatrix();
 
-        // projection matrix
-        glm::mat4 projection;
-        projection = glm::perspective(glm::radians(45.0f), (float)SRC_WIDTH / (float)SRC_HEIGHT, 0.1f, 100.0f);
+        // projection matrix (matching the framebuffer, which may have been resized)
+        if (frame.framebufferWidth > 0 && frame.framebufferHeight > 0)
+            aspectRatio = (float)frame.framebufferWidth / (float)frame.framebufferHeight;
+        frame.projection = camera.getProjectionMatrix(aspectRatio, 0.1f, 100.0f);
+        frame.viewPosition = camera.getPosition();
 
         // model matrix
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(0.0f, 0.0f, -2.0f)); // translate it down so it's at the center of the scene
-        model = glm::rotate(model, (float)glfwGetTime() * glm::radians(5.0f), glm::vec3(0.0f, 0.5f, 0.0f));
+        model = glm::rotate(model, (float)time * glm::radians(5.0f), glm::vec3(0.0f, 0.5f, 0.0f));
         model = glm::scale(model, glm::vec3(0.5f, 0.5f, 0.5f)); // it's a bit too big for our scene, so scale it down
+        frame.model = model;
 
-        shader.use();
-        shader.setUniform("view", 1, false, view);             // set the view matrix
-        shader.setUniform("projection", 1, false, projection); // set the projection matrix
-        shader.setUniform("model", 1, false, model);
-        shader.setUniform("viewPos", camera.getPosition());
-        shader.setUniform("normalModel", 1, false, glm::inverse(glm::transpose(glm::mat3(model))));
-        checkGLError("BEFORE MODEL DRAW");
-        modelObj.draw(shader);
+        // spread the lights over rings around the model, each circling at its own speed
+        frame.lightPositions.clear();
+        if (settings.clusteredLighting)
+            for (int i = 0; i < settings.clusteredLightCount; i++)
+            {
+                float orbitRadius = 0.5f + (i % 16) * 0.4f, angle = i * 2.39996f + (float)time * (0.2f + (i % 5) * 0.1f);
+                frame.lightPositions.push_back(glm::vec3(orbitRadius * std::cos(angle), ((i * 7) % 11) / 5.0f - 1.0f, -2.0f + orbitRadius * std::sin(angle)));
+            }
+        frame.settings = settings;
 
-        // Rendering
         ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        glfwSwapBuffers(window.get()); // swap the buffer we have been drawing to into the front
+        frame.imGui.capture(ImGui::GetDrawData());
+        frameExchange.publish();
+        if (singleThreaded)
+            renderFrame(*frameExchange.acquire());
+        frameIndex++;
+    }
 
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // let the render thread finish the frames already handed over, then take the context back to clean up
+    frameExchange.close();
+    if (renderThread.joinable())
+    {
+        renderThread.join();
+        makeContextCurrent(true);
+    }
+    TextureManager::setThreadPool(nullptr);
+
+    if (headless)
+    {
+        std::vector<float> sorted = headlessFrameMilliseconds;
+        std::sort(sorted.begin(), sorted.end());
+        float total = 0.0f;
+        for (float milliseconds : sorted)
+            total += milliseconds;
+        LOG("Headless run: " + std::to_string(sorted.size()) + " frames at " + std::to_string(SRC_WIDTH) + "x" + std::to_string(SRC_HEIGHT) + ", " +
+                std::to_string(total / sorted.size()) + " ms/frame average (min " + std::to_string(sorted.front()) + ", median " +
+                std::to_string(sorted[sorted.size() / 2]) + ", max " + std::to_string(sorted.back()) + ")",
+            Logging::LOG_TYPE::INFO, Logging::LOG_PRIORITY::HIGH);
+
+        std::string gpuTimes = "GPU frame " + std::to_string(renderStats.gpuFrame.averageMilliseconds) + " ms average";
+        for (const GPUScopeStats &scope : renderStats.gpuScopes)
+            gpuTimes += ", " + scope.path + " " + std::to_string(scope.averageMilliseconds) + " ms (p95 " + std::to_string(scope.p95Milliseconds) + ")";
+        LOG(gpuTimes, Logging::LOG_TYPE::INFO, Logging::LOG_PRIORITY::HIGH);
     }
 
     ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
+    if (!headless)
+        ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
 
     glfwTerminate();
     return 0;
-}
\ No newline at end of file
+}
@@ -1,16 +1,25 @@
 #include "rendering/assimp/mesh.h"
 #include "rendering/vertex/vertex.h"
+#include "utils/hashing/hashing.h"
 #include <string>
 #include "rendering/log/check_gl.h"
 #include "utils/logging/logging.h"
+#include <algorithm>
+#include <cmath>
 
 Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<TextureInfo> textures, float shininess)
-    : vao()
+    : vao(), boundsMin(0.0f), boundsMax(0.0f), uvDensity(0.0f), textureUniformHandles(), shininessHandle(), handlesShaderRevision(0), shaderPermutation(), materialKey(0)
 {
     this->vertices = vertices;
     this->indices = indices;
     this->textures = textures;
     this->shininess = shininess;
+    // let the texture manager know these textures are in use so they are not evicted
+    for (const auto &textureInfo : this->textures)
+        TextureManager::addMeshReference(textureInfo);
+    calculateBounds();
+    calculateShaderPermutation();
+    calculateMaterialKey();
     setupMesh();
 }
 
@@ -21,6 +30,15 @@ Mesh::Mesh(Mesh &&other)
     this->indices = other.indices;
     this->textures = other.textures;
     this->shininess = other.shininess;
+    this->boundsMin = other.boundsMin;
+    this->boundsMax = other.boundsMax;
+    this->uvDensity = other.uvDensity;
+    this->textureUniformHandles = std::move(other.textureUniformHandles);
+    this->shininessHandle = other.shininessHandle;
+    this->handlesShaderRevision = other.handlesShaderRevision;
+    this->shaderPermutation = other.shaderPermutation;
+    this->materialKey = other.materialKey;
+    other.handlesShaderRevision = 0;
     other.vertices.clear();
     other.indices.clear();
     other.textures.clear();
@@ -29,10 +47,22 @@ Mesh::Mesh(Mesh &&other)
 
 Mesh &Mesh::operator=(Mesh &&other) noexcept
 {
+    // release the textures we are replacing
+    for (const auto &textureInfo : this->textures)
+        TextureManager::removeMeshReference(textureInfo);
     this->vertices = other.vertices;
     this->indices = other.indices;
     this->textures = other.textures;
     this->shininess = other.shininess;
+    this->boundsMin = other.boundsMin;
+    this->boundsMax = other.boundsMax;
+    this->uvDensity = other.uvDensity;
+    this->textureUniformHandles = std::move(other.textureUniformHandles);
+    this->shininessHandle = other.shininessHandle;
+    this->handlesShaderRevision = other.handlesShaderRevision;
+    this->shaderPermutation = other.shaderPermutation;
+    this->materialKey = other.materialKey;
+    other.handlesShaderRevision = 0;
     this->vao = std::move(other.vao);
     other.vertices.clear();
     other.indices.clear();
@@ -43,6 +73,8 @@ Mesh &Mesh::operator=(Mesh &&other) noexcept
 
 Mesh::~Mesh()
 {
+    for (const auto &textureInfo : textures)
+        TextureManager::removeMeshReference(textureInfo);
 }
 
 void Mesh::setupMesh()
@@ -53,25 +85,109 @@ void Mesh::setupMesh()
     EBO ebo = EBO();
     ebo.assignData(&indices[0], indices.size() * sizeof(unsigned int), GL_STATIC_DRAW);
 
-    VertexBufferLayout layout = VertexBufferLayout();
-    layout.addAttribute(GL_FLOAT, 3, 3 * sizeof(float), GL_FALSE); // verts
-    layout.addAttribute(GL_FLOAT, 3, 3 * sizeof(float), GL_FALSE); // normals
-    layout.addAttribute(GL_FLOAT, 2, 2 * sizeof(float), GL_FALSE); // texture coords
+    // every mesh shares the layout described by the Vertex struct
+    static const VertexBufferLayout layout = VertexBufferLayout(Vertex::describe());
 
     vao.addBuffer(std::move(vbo), layout);
     vao.addBuffer(std::move(ebo));
 }
 
-void Mesh::draw(Shader &shader)
+OccluderMesh Mesh::createOccluder() const
 {
-    shader.use();
-    vao.bind();
+    OccluderMesh occluder;
+    occluder.positions.reserve(vertices.size());
+    for (const auto &vertex : vertices)
+        occluder.positions.push_back(vertex.position);
+    occluder.indices = indices;
+    return occluder;
+}
+
+void Mesh::calculateBounds()
+{
+    if (vertices.empty())
+        return;
+    boundsMin = boundsMax = vertices[0].position;
+    for (const auto &vertex : vertices)
+    {
+        boundsMin = glm::min(boundsMin, vertex.position);
+        boundsMax = glm::max(boundsMax, vertex.position);
+    }
+
+    // compare the total area of the triangles in model space and texture space
+    float surfaceArea = 0.0f, uvArea = 0.0f;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const Vertex &a = vertices[indices[i]], &b = vertices[indices[i + 1]], &c = vertices[indices[i + 2]];
+        surfaceArea += 0.5f * glm::length(glm::cross(b.position - a.position, c.position - a.position));
+        glm::vec2 uvEdge1 = b.texture_coords - a.texture_coords, uvEdge2 = c.texture_coords - a.texture_coords;
+        uvArea += 0.5f * std::abs(uvEdge1.x * uvEdge2.y - uvEdge1.y * uvEdge2.x);
+    }
+    uvDensity = surfaceArea > 0.0f ? std::sqrt(uvArea / surfaceArea) : 0.0f;
+}
+
+void Mesh::requestTextureDetail(const glm::mat4 &model, const glm::vec3 &camera_position, float projection_scale)
+{
+    if (uvDensity <= 0.0f)
+        return;
+
+    // approximate the mesh as a sphere in world space
+    glm::vec3 centre = glm::vec3(model * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.0f));
+    float scale = std::max({glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))});
+    float radius = glm::length(boundsMax - boundsMin) * 0.5f * scale;
+
+    // the closest point of the mesh needs the most detail
+    float distance = std::max(glm::length(centre - camera_position) - radius, MIN_TEXTURE_DETAIL_DISTANCE);
+    float pixelsPerUnit = projection_scale / distance;
+    float uvPerUnit = uvDensity / scale;
+
+    for (auto &textureInfo : textures)
+    {
+        auto texture_ptr = textureInfo.texture.lock();
+        if (!texture_ptr || !texture_ptr->isStreamed())
+            continue;
+        // how many texels of mip level 0 land on each pixel - every doubling needs one coarser mip level
+        glm::vec2 dimensions = texture_ptr->getDimensions();
+        float texelsPerPixel = uvPerUnit * std::max(dimensions.x, dimensions.y) / pixelsPerUnit;
+        int level = texelsPerPixel > 1.0f ? (int)std::floor(std::log2(texelsPerPixel)) : 0;
+        texture_ptr->requestMipLevel(level);
+    }
+}
+
+void Mesh::calculateShaderPermutation()
+{
+    // only sample the maps this mesh actually has
+    shaderPermutation = ShaderPermutation();
+    for (const auto &textureInfo : textures)
+    {
+        if (auto texture_ptr = textureInfo.texture.lock())
+        {
+            if (texture_ptr->getUseCase() == Texture::TEXTURE_USECASE::DIFFUSE)
+                shaderPermutation.addFeature(SHADER_FEATURE_DIFFUSE_MAP);
+            else if (texture_ptr->getUseCase() == Texture::TEXTURE_USECASE::SPECULAR)
+                shaderPermutation.addFeature(SHADER_FEATURE_SPECULAR_MAP);
+        }
+    }
+}
 
-    // bind textures associated with this mesh to their respective uniforms
+void Mesh::calculateMaterialKey()
+{
+    // meshes sharing the same textures and shininess share a material
+    materialKey = Hashing::hash64(&shininess, sizeof(shininess));
+    for (const auto &textureInfo : textures)
+    {
+        const Texture *texture = textureInfo.texture.lock().get();
+        materialKey = Hashing::combine(materialKey, Hashing::hash64(&texture, sizeof(texture)));
+    }
+}
+
+void Mesh::cacheUniformHandles(const Shader &shader)
+{
+    // work out the sampler uniform each texture is bound to
+    textureUniformHandles.clear();
     unsigned int num_diffuse = 0, num_specular = 0, num_other = 0; // the current number of diffuse/specular shaders processed by this mesh
     for (auto &textureInfo : textures)
     {
-        // convert weak texture pointer into shared pointer
+        UniformHandle handle;
         if (auto texture_ptr = textureInfo.texture.lock())
         {
             std::string uniformName = "material.texture_";
@@ -83,14 +199,100 @@ void Mesh::draw(Shader &shader)
                 uniformName.append("other" + std::to_string(num_other++));
             else
                 LOG("Invalid texture usecase in draw call for: " + textureInfo.file_path, Logging::LOG_TYPE::ERROR);
-            shader.setUniform(uniformName, (int)texture_ptr->getTextureUnit());
-            texture_ptr->bind();
+            handle = shader.getUniformHandle(uniformName);
         }
+        textureUniformHandles.push_back(handle);
+    }
+    shininessHandle = shader.getUniformHandle("material.shininess");
+    handlesShaderRevision = shader.getRevision();
+
+    // catch a vertex shader expecting attributes our vertices don't provide (the result is remembered by the shader, so this is cheap)
+    shader.validateVertexLayout(Vertex::describe());
+}
+
+void Mesh::draw(Shader &shader)
+{
+    shader.use();
+    vao.bind();
+    setMaterialUniforms(shader);
+    bindTextures();
+    drawElements();
+}
+
+void Mesh::draw(ShaderVariants &shader_variants)
+{
+    draw(shader_variants.getVariant(shaderPermutation));
+}
+
+void Mesh::setMaterialUniforms(Shader &shader)
+{
+    // fetch the uniform handles once per shader rather than building uniform names every draw
+    if (handlesShaderRevision != shader.getRevision())
+        cacheUniformHandles(shader);
+
+    // point each sampler uniform at the unit its texture is bound to
+    for (size_t i = 0; i < textures.size(); i++)
+    {
+        if (auto texture_ptr = textures[i].texture.lock())
+            shader.setUniform(textureUniformHandles[i], (int)texture_ptr->getTextureUnit());
+    }
+    // bind the 'shininess' of this mesh to its uniform
+    shader.setUniform(shininessHandle, shininess);
+}
+
+void Mesh::bindTextures()
+{
+    for (auto &textureInfo : textures)
+    {
+        // convert weak texture pointer into shared pointer
+        if (auto texture_ptr = textureInfo.texture.lock())
+            TextureManager::bindTexture(*texture_ptr); // reloads the texture if it has been evicted
         else // if the weak ptr in texture info has expired, log an error and skip it
             LOG("Trying to bind non-existent texture: " + textureInfo.file_path, Logging::LOG_TYPE::ERROR);
     }
-    // bind the 'shininess' of this mesh to its uniform
-    shader.setUniform("material.shininess", shininess);
+}
 
+void Mesh::drawElements() const
+{
     glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-}
\ No newline at end of file
+}
+
+const VAO &Mesh::getVAO() const
+{
+    return vao;
+}
+
+const std::vector<Vertex> &Mesh::getVertices() const
+{
+    return vertices;
+}
+
+const std::vector<unsigned int> &Mesh::getIndices() const
+{
+    return indices;
+}
+
+const std::vector<TextureInfo> &Mesh::getTextures() const
+{
+    return textures;
+}
+
+uint64_t Mesh::getMaterialKey() const
+{
+    return materialKey;
+}
+
+glm::vec3 Mesh::getBoundsMin() const
+{
+    return boundsMin;
+}
+
+glm::vec3 Mesh::getBoundsMax() const
+{
+    return boundsMax;
+}
+
+const ShaderPermutation &Mesh::getShaderPermutation() const
+{
+    return shaderPermutation;
+}
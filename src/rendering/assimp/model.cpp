@@ -1,8 +1,14 @@
 #include "rendering/assimp/model.h"
+#include "rendering/render_queue/render_queue.h"
+#include <algorithm>
+#include <numeric>
 #include "iostream"
 #include "utils/logging/logging.h"
 #include "string"
 
+// the number of meshes culled and encoded together in a parallel submit
+static const size_t MODEL_SUBMIT_BATCH_SIZE = 32;
+
 Model::Model(const char *path)
 {
     loadModel(path);
@@ -27,6 +33,139 @@ void Model::draw(Shader &shader)
         mesh.draw(shader);
 }
 
+void Model::draw(ShaderVariants &shader_variants)
+{
+    for (auto &mesh : meshes)
+        mesh.draw(shader_variants);
+}
+
+CullingStats Model::submit(RenderQueue &render_queue, ShaderVariants &shader_variants, const glm::mat4 &model, const glm::mat4 &view, const Frustum &frustum,
+                           const OcclusionCuller *occlusion_culler)
+{
+    size_t visibleCount = findVisibleMeshes(model, frustum);
+
+    glm::mat4 modelView = view * model;
+    unsigned int occludedCount = 0;
+    for (uint32_t i : visibleMeshes)
+    {
+        Mesh &mesh = meshes[i];
+        if (occlusion_culler && !occlusion_culler->isVisible(AABB{mesh.getBoundsMin(), mesh.getBoundsMax()}.transformed(model)))
+        {
+            occludedCount++;
+            continue;
+        }
+        // sort by the depth of the centre of the mesh's bounds (the camera looks down -z in view space)
+        glm::vec3 centre = (mesh.getBoundsMin() + mesh.getBoundsMax()) * 0.5f;
+        float viewDepth = -(modelView * glm::vec4(centre, 1.0f)).z;
+        render_queue.submit(mesh, shader_variants.getVariant(mesh.getShaderPermutation()), model, RENDER_PASS::OPAQUE, viewDepth);
+    }
+    return {(unsigned int)meshes.size(), (unsigned int)visibleCount - occludedCount, occludedCount};
+}
+
+CullingStats Model::submitParallel(ThreadPool &thread_pool, RenderQueue &render_queue, ShaderVariants &shader_variants, const glm::mat4 &model,
+                                   const glm::mat4 &view, const Frustum &frustum, const OcclusionCuller *occlusion_culler)
+{
+    if (&shader_variants != meshShadersSource || meshShaders.size() != meshes.size())
+    {
+        meshShaders.clear();
+        for (const auto &mesh : meshes)
+            meshShaders.push_back(&shader_variants.getVariant(mesh.getShaderPermutation()));
+        meshShadersSource = &shader_variants;
+    }
+
+    // the tree is queried once here, then the meshes it finds are occlusion tested and encoded in batches across the pool
+    size_t visibleCount = findVisibleMeshes(model, frustum);
+    size_t batchCount = (visibleCount + MODEL_SUBMIT_BATCH_SIZE - 1) / MODEL_SUBMIT_BATCH_SIZE;
+    std::vector<RenderCommandBuffer> &commandBuffers = render_queue.getCommandBuffers(batchCount);
+    batchStats.assign(batchCount, CullingStats());
+    glm::mat4 modelView = view * model;
+    thread_pool.parallelFor(visibleCount, MODEL_SUBMIT_BATCH_SIZE, [&](size_t begin, size_t end)
+                            {
+                                // batches start on multiples of the batch size, so each one finds its own buffers
+                                size_t batch = begin / MODEL_SUBMIT_BATCH_SIZE;
+                                unsigned int occludedCount = 0;
+                                for (size_t visible = begin; visible < end; visible++)
+                                {
+                                    uint32_t i = visibleMeshes[visible];
+                                    Mesh &mesh = meshes[i];
+                                    if (occlusion_culler && !occlusion_culler->isVisible(AABB{mesh.getBoundsMin(), mesh.getBoundsMax()}.transformed(model)))
+                                    {
+                                        occludedCount++;
+                                        continue;
+                                    }
+                                    glm::vec3 centre = (mesh.getBoundsMin() + mesh.getBoundsMax()) * 0.5f;
+                                    float viewDepth = -(modelView * glm::vec4(centre, 1.0f)).z;
+                                    commandBuffers[batch].submit(mesh, *meshShaders[i], model, RENDER_PASS::OPAQUE, viewDepth);
+                                }
+                                batchStats[batch] = {0, (unsigned int)(end - begin) - occludedCount, occludedCount}; });
+    render_queue.mergeCommandBuffers();
+
+    CullingStats stats = {(unsigned int)meshes.size(), 0, 0};
+    for (const CullingStats &batch : batchStats)
+    {
+        stats.visible += batch.visible;
+        stats.occluded += batch.occluded;
+    }
+    return stats;
+}
+
+size_t Model::findVisibleMeshes(const glm::mat4 &model, const Frustum &frustum)
+{
+    // the meshes are inserted in order into an empty tree, so their ids in the tree are their indices
+    if (meshTree.getObjectCount() != meshes.size())
+    {
+        for (const auto &mesh : meshes)
+            meshTree.insert(AABB{mesh.getBoundsMin(), mesh.getBoundsMax()});
+        meshTree.rebuild();
+    }
+    meshTree.queryFrustum(frustum.transformed(model), visibleMeshes);
+    // keep mesh order so meshes with equal sort keys are drawn in the same order every frame
+    std::sort(visibleMeshes.begin(), visibleMeshes.end());
+    return visibleMeshes.size();
+}
+
+void Model::addOccluders(OcclusionCuller &occlusion_culler, const glm::mat4 &model, size_t max_occluders)
+{
+    // small meshes hide little but cost as much to rasterise per triangle, so rank the meshes by the surface area of their bounds once
+    if (occluderOrder.size() != meshes.size())
+    {
+        std::vector<float> areas;
+        for (const auto &mesh : meshes)
+        {
+            glm::vec3 size = mesh.getBoundsMax() - mesh.getBoundsMin();
+            areas.push_back(size.x * size.y + size.y * size.z + size.z * size.x);
+        }
+        occluderOrder.resize(meshes.size());
+        std::iota(occluderOrder.begin(), occluderOrder.end(), 0);
+        std::stable_sort(occluderOrder.begin(), occluderOrder.end(), [&](size_t a, size_t b)
+                         { return areas[a] > areas[b]; });
+        meshOccluders.clear();
+    }
+
+    size_t occluderCount = std::min(max_occluders, meshes.size());
+    while (meshOccluders.size() < occluderCount)
+        meshOccluders.push_back(meshes[occluderOrder[meshOccluders.size()]].createOccluder());
+    for (size_t i = 0; i < occluderCount; i++)
+        occlusion_culler.addOccluder(meshOccluders[i], model);
+}
+
+std::vector<ShaderPermutation> Model::getShaderPermutations() const
+{
+    std::vector<ShaderPermutation> permutations;
+    for (const auto &mesh : meshes)
+        if (std::find(permutations.begin(), permutations.end(), mesh.getShaderPermutation()) == permutations.end())
+            permutations.push_back(mesh.getShaderPermutation());
+    return permutations;
+}
+
+void Model::requestTextureDetail(const glm::mat4 &model, const glm::vec3 &camera_position, const glm::mat4 &projection, float viewport_height)
+{
+    // the number of pixels 1 world unit covers at a distance of 1
+    float projectionScale = projection[1][1] * viewport_height * 0.5f;
+    for (auto &mesh : meshes)
+        mesh.requestTextureDetail(model, camera_position, projectionScale);
+}
+
 Model::~Model()
 {
 }
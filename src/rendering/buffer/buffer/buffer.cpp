@@ -1,4 +1,5 @@
 #include "rendering/buffer/buffer/buffer.h"
+#include "rendering/state_cache/gl_state_cache.h"
 #include "utility"
 
 Buffer::Buffer(GLenum targetType)
@@ -20,6 +21,7 @@ Buffer &Buffer::operator=(Buffer &&other) noexcept
     if (this != &other)
     {
         // delete current buffer as its being replaced
+        GLStateCache::forgetBuffer(ID);
         glDeleteBuffers(1, &ID);
         // take over ownership of other's buffer
         assumeData(std::move(other));
@@ -29,41 +31,55 @@ Buffer &Buffer::operator=(Buffer &&other) noexcept
 
 Buffer::~Buffer()
 {
+    GLStateCache::forgetBuffer(ID);
     glDeleteBuffers(1, &ID);
 }
 
 void Buffer::assignData(const float *data, GLsizeiptr dataSize, GLenum usage)
 {
-    bind();
-    glBufferData(targetType, dataSize, data, usage);
-    unbind();
+    assignData(static_cast<const void *>(data), dataSize, usage);
 }
 
 void Buffer::assignData(const unsigned int *data, GLsizeiptr dataSize, GLenum usage)
 {
-    bind();
-    glBufferData(targetType, dataSize, data, usage);
-    unbind();
+    assignData(static_cast<const void *>(data), dataSize, usage);
 }
 
 void Buffer::assignData(const Vertex *data, GLsizeiptr dataSize, GLenum usage)
 {
-    bind();
-    glBufferData(targetType, dataSize, data, usage);
-    unbind();
+    assignData(static_cast<const void *>(data), dataSize, usage);
+}
+
+void Buffer::assignData(const void *data, GLsizeiptr dataSize, GLenum usage)
+{
+    // the buffer is left bound - the state cache makes rebinding it for the next upload free
+    GLStateCache::bindBuffer(getUploadTarget(), ID);
+    glBufferData(getUploadTarget(), dataSize, data, usage);
+}
+
+void Buffer::assignSubData(const void *data, GLintptr offset, GLsizeiptr dataSize)
+{
+    GLStateCache::bindBuffer(getUploadTarget(), ID);
+    glBufferSubData(getUploadTarget(), offset, dataSize, data);
 }
 
 void Buffer::bind() const
 {
-    glBindBuffer(targetType, ID);
+    GLStateCache::bindBuffer(targetType, ID);
 }
 
 void Buffer::unbind() const
 {
-    glBindBuffer(targetType, 0);
+    GLStateCache::bindBuffer(targetType, 0);
+}
+
+GLenum Buffer::getUploadTarget() const
+{
+    // the element array binding is part of the bound VAO, so uploading through it would attach this buffer to whichever VAO is bound
+    return targetType == GL_ELEMENT_ARRAY_BUFFER ? GL_COPY_WRITE_BUFFER : targetType;
 }
 
-unsigned int Buffer::getID()
+unsigned int Buffer::getID() const
 {
     return ID;
 }
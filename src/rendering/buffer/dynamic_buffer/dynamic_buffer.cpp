@@ -0,0 +1,132 @@
+#include "rendering/buffer/dynamic_buffer/dynamic_buffer.h"
+#include "rendering/capabilities/gl_capabilities.h"
+#include "rendering/state_cache/gl_state_cache.h"
+#include "utils/logging/logging.h"
+#include <chrono>
+#include <cstring>
+#include <string>
+
+// how long to wait on a fence before checking it again (in nanoseconds)
+static const GLuint64 DYNAMIC_BUFFER_WAIT_TIMEOUT = 1000000;
+
+DynamicBuffer::DynamicBuffer(GLenum target, GLsizeiptr frame_size, unsigned int frame_count)
+    : buffer(target), target(target), frameSize(0), frameCount(frame_count), currentFrame(0), usedBytes(0), persistent(isSupported()), mapped(nullptr),
+      staging(), fences(frame_count, nullptr), stats()
+{
+    frameSize = (frame_size + DYNAMIC_BUFFER_FRAME_ALIGNMENT - 1) / DYNAMIC_BUFFER_FRAME_ALIGNMENT * DYNAMIC_BUFFER_FRAME_ALIGNMENT;
+    GLsizeiptr totalSize = frameSize * frameCount;
+    // set up through the copy target, so an element array buffer is not attached to whichever VAO is bound
+    GLStateCache::bindBuffer(GL_COPY_WRITE_BUFFER, buffer.getID());
+    if (persistent)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, totalSize, nullptr, flags);
+        mapped = static_cast<char *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalSize, flags));
+        if (!mapped)
+            LOG("Failed to persistently map dynamic buffer " + std::to_string(buffer.getID()), Logging::LOG_TYPE::ERROR);
+    }
+    else
+    {
+        glBufferData(GL_COPY_WRITE_BUFFER, totalSize, nullptr, GL_DYNAMIC_DRAW);
+        staging.resize(totalSize);
+        mapped = staging.data();
+    }
+    LOG("Initialised new dynamic buffer: " + std::to_string(buffer.getID()) + " (" + std::to_string(frameCount) + " x " + std::to_string(frameSize) + " bytes, " +
+            (persistent ? "persistently mapped" : "glBufferSubData fallback") + ")",
+        Logging::LOG_TYPE::INFO);
+}
+
+DynamicBuffer::~DynamicBuffer()
+{
+    for (GLsync fence : fences)
+        if (fence)
+            glDeleteSync(fence);
+}
+
+bool DynamicBuffer::isSupported()
+{
+    return GLCapabilities::isVersionAtLeast(4, 4) || GLCapabilities::hasExtension("GL_ARB_buffer_storage");
+}
+
+void DynamicBuffer::beginFrame()
+{
+    usedBytes = 0;
+    GLsync &fence = fences[currentFrame];
+    if (!fence)
+        return;
+
+    // the first check does not wait, so a region the GPU is already done with costs nothing
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        auto start = std::chrono::steady_clock::now();
+        do
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, DYNAMIC_BUFFER_WAIT_TIMEOUT);
+        while (result == GL_TIMEOUT_EXPIRED);
+        stats.fenceWaits++;
+        stats.waitMilliseconds += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    if (result == GL_WAIT_FAILED)
+        LOG("Waiting on a dynamic buffer fence failed", Logging::LOG_TYPE::ERROR);
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+DynamicAllocation DynamicBuffer::allocate(GLsizeiptr size, GLsizeiptr alignment)
+{
+    // regions start on a multiple of DYNAMIC_BUFFER_FRAME_ALIGNMENT, so aligning within the region aligns within the buffer
+    GLsizeiptr regionStart = currentFrame * frameSize;
+    GLsizeiptr offset = alignment > 1 ? (regionStart + usedBytes + alignment - 1) / alignment * alignment : regionStart + usedBytes;
+    if (!mapped || offset + size > regionStart + frameSize)
+    {
+        stats.failedAllocations++;
+        return {nullptr, 0, 0};
+    }
+    usedBytes = offset + size - regionStart;
+    return {mapped + offset, offset, size};
+}
+
+DynamicAllocation DynamicBuffer::write(const void *data, GLsizeiptr size, GLsizeiptr alignment)
+{
+    DynamicAllocation allocation = allocate(size, alignment);
+    if (allocation.data)
+        std::memcpy(allocation.data, data, size);
+    return allocation;
+}
+
+void DynamicBuffer::flush(const DynamicAllocation &allocation)
+{
+    if (persistent || !allocation.data)
+        return;
+    GLStateCache::bindBuffer(GL_COPY_WRITE_BUFFER, buffer.getID());
+    glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.offset, allocation.size, allocation.data);
+}
+
+void DynamicBuffer::bindRange(const DynamicAllocation &allocation, GLuint binding_point)
+{
+    flush(allocation);
+    GLStateCache::bindBufferRange(target, binding_point, buffer.getID(), allocation.offset, allocation.size);
+}
+
+void DynamicBuffer::endFrame()
+{
+    // the glBufferSubData fallback is ordered by the driver, so it needs no fences
+    if (persistent)
+        fences[currentFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    currentFrame = (currentFrame + 1) % frameCount;
+}
+
+unsigned int DynamicBuffer::getID() const
+{
+    return buffer.getID();
+}
+
+GLsizeiptr DynamicBuffer::getUsedBytes() const
+{
+    return usedBytes;
+}
+
+DynamicBufferStats DynamicBuffer::getStats() const
+{
+    return stats;
+}
@@ -0,0 +1,27 @@
+#include "rendering/buffer/ssbo/ssbo.h"
+#include "rendering/state_cache/gl_state_cache.h"
+#include <utility>
+#include "utils/logging/logging.h"
+#include <string>
+
+SSBO::SSBO()
+    : Buffer(GL_SHADER_STORAGE_BUFFER) // SSBOs should always target the shader storage buffer
+{
+    LOG("Initialised new SSBO: " + std::to_string(getID()), Logging::LOG_TYPE::INFO);
+}
+
+SSBO::SSBO(SSBO &&other)
+    : Buffer(std::move(other))
+{
+}
+
+SSBO &SSBO::operator=(SSBO &&other) noexcept
+{
+    Buffer::operator=(std::move(other));
+    return *this;
+}
+
+void SSBO::bindToBindingPoint(unsigned int binding_point) const
+{
+    GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_point, getID());
+}
@@ -0,0 +1,27 @@
+#include "rendering/buffer/ubo/ubo.h"
+#include "rendering/state_cache/gl_state_cache.h"
+#include <utility>
+#include "utils/logging/logging.h"
+#include <string>
+
+UBO::UBO()
+    : Buffer(GL_UNIFORM_BUFFER) // UBOs should always target the uniform buffer
+{
+    LOG("Initialised new UBO: " + std::to_string(getID()), Logging::LOG_TYPE::INFO);
+}
+
+UBO::UBO(UBO &&other)
+    : Buffer(std::move(other))
+{
+}
+
+UBO &UBO::operator=(UBO &&other) noexcept
+{
+    Buffer::operator=(std::move(other));
+    return *this;
+}
+
+void UBO::bindToBindingPoint(unsigned int binding_point) const
+{
+    GLStateCache::bindBufferBase(GL_UNIFORM_BUFFER, binding_point, getID());
+}
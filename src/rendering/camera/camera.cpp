@@ -43,6 +43,11 @@ glm::mat4 Camera::getViewMatrix()
     return glm::lookAt(cameraParams.cameraPos, cameraParams.cameraPos + cameraParams.cameraFront, cameraParams.cameraUp);
 }
 
+glm::mat4 Camera::getProjectionMatrix(float aspect_ratio, float near_plane, float far_plane) const
+{
+    return glm::perspective(glm::radians(cameraParams.zoom), aspect_ratio, near_plane, far_plane);
+}
+
 void Camera::processKeyboard(Movement direction, float deltaTime)
 {
     float velocity = cameraParams.movementSpeed * deltaTime;
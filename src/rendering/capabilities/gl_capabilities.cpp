@@ -0,0 +1,54 @@
+#include "rendering/capabilities/gl_capabilities.h"
+#include "utils/logging/logging.h"
+
+// anisotropic filtering is core in OpenGL 4.6 but these may be missing from older loaders
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY 0x84FF
+#endif
+
+bool GLCapabilities::hasExtension(const std::string &extension_name)
+{
+    return getInstance().extensions.count(extension_name) > 0;
+}
+
+bool GLCapabilities::isVersionAtLeast(int major, int minor)
+{
+    return getInstance().majorVersion > major || (getInstance().majorVersion == major && getInstance().minorVersion >= minor);
+}
+
+float GLCapabilities::getMaxAnisotropy()
+{
+    return getInstance().maxAnisotropy;
+}
+
+GLint GLCapabilities::getUniformBufferOffsetAlignment()
+{
+    return getInstance().uniformBufferOffsetAlignment;
+}
+
+GLCapabilities &GLCapabilities::getInstance()
+{
+    static GLCapabilities instance;
+    return instance;
+}
+
+GLCapabilities::GLCapabilities()
+    : majorVersion(0), minorVersion(0), extensions(), maxAnisotropy(1.0f), uniformBufferOffsetAlignment(256)
+{
+    glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+    glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+    int extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (int i = 0; i < extensionCount; i++)
+        extensions.insert(reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i)));
+
+    // (we can't use the static helpers here as the instance is still being constructed)
+    bool isVersion46 = majorVersion > 4 || (majorVersion == 4 && minorVersion >= 6);
+    if (isVersion46 || extensions.count("GL_EXT_texture_filter_anisotropic") > 0 || extensions.count("GL_ARB_texture_filter_anisotropic") > 0)
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &maxAnisotropy);
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformBufferOffsetAlignment);
+
+    LOG("OpenGL context version " + std::to_string(majorVersion) + "." + std::to_string(minorVersion) + " with " + std::to_string(extensionCount) + " extensions",
+        Logging::LOG_TYPE::INFO, Logging::LOG_PRIORITY::MEDIUM);
+}
@@ -0,0 +1,250 @@
+#include "rendering/context/headless_context.h"
+#include "utils/logging/logging.h"
+#include <fstream>
+#include <vector>
+#ifdef THREEDIMSIM_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+
+// these are from EGL 1.5 and its extensions, but may be missing from older headers
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+#ifndef EGL_PLATFORM_DEVICE_EXT
+#define EGL_PLATFORM_DEVICE_EXT 0x313F
+#endif
+#ifndef EGL_CONTEXT_MAJOR_VERSION_KHR
+#define EGL_CONTEXT_MAJOR_VERSION_KHR 0x3098
+#endif
+#ifndef EGL_CONTEXT_MINOR_VERSION_KHR
+#define EGL_CONTEXT_MINOR_VERSION_KHR 0x30FB
+#endif
+#ifndef EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR
+#define EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR 0x30FD
+#endif
+#ifndef EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR
+#define EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR 0x00000001
+#endif
+
+/// @brief check if a space separated EGL extension string contains an extension
+/// @param extensions the extension string (may be nullptr)
+/// @param extension the extension
+/// @return true if found
+static bool hasEGLExtension(const char *extensions, const char *extension)
+{
+    if (!extensions)
+        return false;
+    size_t length = std::strlen(extension);
+    for (const char *found = std::strstr(extensions, extension); found; found = std::strstr(found + length, extension))
+        if ((found == extensions || found[-1] == ' ') && (found[length] == ' ' || found[length] == '\0'))
+            return true;
+    return false;
+}
+
+/// @brief get a display that needs no window system - Mesa's surfaceless platform, then the first EGL device, then the default display
+/// @return the display (EGL_NO_DISPLAY if none)
+static EGLDisplay getHeadlessDisplay()
+{
+    const char *clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (getPlatformDisplay && hasEGLExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+    {
+        EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display != EGL_NO_DISPLAY)
+            return display;
+    }
+    auto queryDevices = reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC>(eglGetProcAddress("eglQueryDevicesEXT"));
+    if (getPlatformDisplay && queryDevices && hasEGLExtension(clientExtensions, "EGL_EXT_platform_device"))
+    {
+        EGLDeviceEXT device;
+        EGLint deviceCount = 0;
+        if (queryDevices(1, &device, &deviceCount) && deviceCount > 0)
+        {
+            EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, device, nullptr);
+            if (display != EGL_NO_DISPLAY)
+                return display;
+        }
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+#endif
+
+HeadlessContext::HeadlessContext(int width, int height)
+    : display(nullptr), context(nullptr), surface(nullptr), framebuffer_ID(0), colourRenderbuffer_ID(0), depthRenderbuffer_ID(0), width(width), height(height),
+      valid(false)
+{
+#ifdef THREEDIMSIM_EGL
+    EGLDisplay eglDisplay = getHeadlessDisplay();
+    EGLint major, minor;
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor))
+    {
+        LOG("Failed to initialise an EGL display", Logging::LOG_TYPE::ERROR);
+        return;
+    }
+    display = eglDisplay;
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24, EGL_STENCIL_SIZE, 8,
+        EGL_NONE};
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0 || !eglBindAPI(EGL_OPENGL_API))
+    {
+        LOG("No EGL config supports desktop OpenGL", Logging::LOG_TYPE::ERROR);
+        return;
+    }
+
+    // the same version and profile init_glfw asks for
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+        EGL_CONTEXT_MINOR_VERSION_KHR, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+        EGL_NONE};
+    EGLContext eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+    if (eglContext == EGL_NO_CONTEXT)
+    {
+        LOG("Failed to create an EGL OpenGL 3.3 core context", Logging::LOG_TYPE::ERROR);
+        return;
+    }
+    context = eglContext;
+
+    // everything is drawn into our own framebuffer, so a surface is only made if the driver cannot go without one
+    EGLSurface eglSurface = EGL_NO_SURFACE;
+    if (!hasEGLExtension(eglQueryString(eglDisplay, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+    {
+        const EGLint surfaceAttributes[] = {EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE};
+        eglSurface = eglCreatePbufferSurface(eglDisplay, config, surfaceAttributes);
+        if (eglSurface == EGL_NO_SURFACE)
+        {
+            LOG("Failed to create an EGL pbuffer surface", Logging::LOG_TYPE::ERROR);
+            return;
+        }
+        surface = eglSurface;
+    }
+    if (!eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext))
+    {
+        LOG("Failed to make the EGL context current", Logging::LOG_TYPE::ERROR);
+        return;
+    }
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+    {
+        LOG("Failed to load GLAD", Logging::LOG_TYPE::ERROR);
+        return;
+    }
+
+    glGenFramebuffers(1, &framebuffer_ID);
+    glGenRenderbuffers(1, &colourRenderbuffer_ID);
+    glGenRenderbuffers(1, &depthRenderbuffer_ID);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_ID);
+    glBindRenderbuffer(GL_RENDERBUFFER, colourRenderbuffer_ID);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colourRenderbuffer_ID);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer_ID);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer_ID);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LOG("Headless framebuffer is incomplete", Logging::LOG_TYPE::ERROR);
+        return;
+    }
+    valid = true;
+    LOG("Created headless EGL " + std::to_string(major) + "." + std::to_string(minor) + " context (" + (surface ? "pbuffer" : "surfaceless") + ", " +
+            std::to_string(width) + "x" + std::to_string(height) + "): " + reinterpret_cast<const char *>(glGetString(GL_RENDERER)),
+        Logging::LOG_TYPE::INFO, Logging::LOG_PRIORITY::HIGH);
+#else
+    LOG("Headless mode needs EGL - configure with -DTHREEDIMSIM_EGL=ON", Logging::LOG_TYPE::ERROR);
+#endif
+}
+
+HeadlessContext::~HeadlessContext()
+{
+#ifdef THREEDIMSIM_EGL
+    if (framebuffer_ID)
+    {
+        glDeleteRenderbuffers(1, &colourRenderbuffer_ID);
+        glDeleteRenderbuffers(1, &depthRenderbuffer_ID);
+        glDeleteFramebuffers(1, &framebuffer_ID);
+    }
+    if (display)
+    {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (surface)
+            eglDestroySurface(display, surface);
+        if (context)
+            eglDestroyContext(display, context);
+        eglTerminate(display);
+    }
+#endif
+}
+
+bool HeadlessContext::isAvailable()
+{
+#ifdef THREEDIMSIM_EGL
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool HeadlessContext::isValid() const
+{
+    return valid;
+}
+
+void HeadlessContext::makeCurrent()
+{
+#ifdef THREEDIMSIM_EGL
+    if (valid && !eglMakeCurrent(display, surface, surface, context))
+        LOG("Failed to make the EGL context current", Logging::LOG_TYPE::ERROR);
+#endif
+}
+
+void HeadlessContext::releaseCurrent()
+{
+#ifdef THREEDIMSIM_EGL
+    if (valid)
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+#endif
+}
+
+void HeadlessContext::endFrame()
+{
+    glFinish();
+}
+
+bool HeadlessContext::saveImage(const std::string &path) const
+{
+    if (!valid)
+        return false;
+    std::vector<unsigned char> pixels(width * height * 3);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_ID);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        LOG("Failed to open " + path + " to save the headless framebuffer", Logging::LOG_TYPE::ERROR);
+        return false;
+    }
+    file << "P6\n" << width << " " << height << "\n255\n";
+    // OpenGL reads bottom row first, but images start at the top
+    for (int row = height - 1; row >= 0; row--)
+        file.write(reinterpret_cast<const char *>(&pixels[row * width * 3]), width * 3);
+    LOG("Saved the headless framebuffer to " + path, Logging::LOG_TYPE::INFO, Logging::LOG_PRIORITY::HIGH);
+    return true;
+}
+
+int HeadlessContext::getWidth() const
+{
+    return width;
+}
+
+int HeadlessContext::getHeight() const
+{
+    return height;
+}
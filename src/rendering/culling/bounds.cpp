@@ -0,0 +1,81 @@
+#include "rendering/culling/bounds.h"
+#include <cmath>
+#include <initializer_list>
+#include <limits>
+
+glm::vec3 AABB::getCentre() const
+{
+    return (min + max) * 0.5f;
+}
+
+glm::vec3 AABB::getExtents() const
+{
+    return (max - min) * 0.5f;
+}
+
+float AABB::getSurfaceArea() const
+{
+    glm::vec3 size = glm::max(max - min, glm::vec3(0.0f));
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+void AABB::expand(const AABB &other)
+{
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+}
+
+bool AABB::overlaps(const AABB &other) const
+{
+    return min.x <= other.max.x && max.x >= other.min.x &&
+           min.y <= other.max.y && max.y >= other.min.y &&
+           min.z <= other.max.z && max.z >= other.min.z;
+}
+
+AABB AABB::empty()
+{
+    return {glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max())};
+}
+
+AABB AABB::transformed(const glm::mat4 &transform) const
+{
+    // transform the centre, then project each axis of the transformed box onto the world axes (Arvo's method)
+    glm::vec3 centre = glm::vec3(transform * glm::vec4(getCentre(), 1.0f));
+    glm::vec3 extents = getExtents();
+    glm::vec3 newExtents = glm::vec3(0.0f);
+    for (int axis = 0; axis < 3; axis++)
+        for (int row = 0; row < 3; row++)
+            newExtents[row] += std::abs(transform[axis][row]) * extents[axis];
+    return {centre - newExtents, centre + newExtents};
+}
+
+void CullingBounds::add(const AABB &bounds)
+{
+    glm::vec3 centre = bounds.getCentre(), extents = bounds.getExtents();
+    // grow by a whole batch at a time, padding with boxes that are never tested
+    if (count == centreX.size())
+    {
+        size_t padded = count + CULLING_BATCH_SIZE;
+        for (std::vector<float> *array : {&centreX, &centreY, &centreZ, &extentX, &extentY, &extentZ})
+            array->resize(padded, 0.0f);
+    }
+    centreX[count] = centre.x;
+    centreY[count] = centre.y;
+    centreZ[count] = centre.z;
+    extentX[count] = extents.x;
+    extentY[count] = extents.y;
+    extentZ[count] = extents.z;
+    count++;
+}
+
+void CullingBounds::clear()
+{
+    count = 0;
+    for (std::vector<float> *array : {&centreX, &centreY, &centreZ, &extentX, &extentY, &extentZ})
+        array->clear();
+}
+
+size_t CullingBounds::size() const
+{
+    return count;
+}
@@ -0,0 +1,482 @@
+#include "rendering/culling/bvh.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+/// @brief find where a ray enters a box (slab test)
+/// @param bounds the box
+/// @param origin the start of the ray
+/// @param inverse_direction 1 / the direction of the ray, per component
+/// @param max_distance the furthest distance to look
+/// @return the distance along the ray the box is entered (0 if the ray starts inside), or infinity if it is missed
+static float rayEntryDistance(const AABB &bounds, const glm::vec3 &origin, const glm::vec3 &inverse_direction, float max_distance)
+{
+    float entry = 0.0f, exit = max_distance;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        float toMin = (bounds.min[axis] - origin[axis]) * inverse_direction[axis];
+        float toMax = (bounds.max[axis] - origin[axis]) * inverse_direction[axis];
+        entry = std::max(entry, std::min(toMin, toMax));
+        exit = std::min(exit, std::max(toMin, toMax));
+    }
+    return entry <= exit ? entry : std::numeric_limits<float>::infinity();
+}
+
+BVH::BVH()
+    : objectBounds(), objectAlive(), objectLeaves(), pendingObjects(), freeObjects(), removedObjects(), nodes(), leafObjects(), dirtyLeaves(),
+      nodeDirty(), movedSinceBuild(0), objectCount(0), pendingBuild(), pendingBuildRemovedObjects()
+{
+}
+
+BVH::~BVH()
+{
+    // the build only touches its own copy of the objects, but it must not outlive the tree it will be given to
+    if (pendingBuild.valid())
+        pendingBuild.wait();
+}
+
+uint32_t BVH::insert(const AABB &bounds)
+{
+    uint32_t object;
+    if (!freeObjects.empty())
+    {
+        object = freeObjects.back();
+        freeObjects.pop_back();
+    }
+    else
+    {
+        object = (uint32_t)objectBounds.size();
+        objectBounds.push_back(bounds);
+        objectAlive.push_back(0);
+        objectLeaves.push_back(BVH_NO_NODE);
+    }
+    objectBounds[object] = bounds;
+    objectAlive[object] = 1;
+    objectLeaves[object] = BVH_NO_NODE;
+    pendingObjects.push_back(object);
+    objectCount++;
+    return object;
+}
+
+void BVH::remove(uint32_t object)
+{
+    if (object >= objectAlive.size() || !objectAlive[object])
+        return;
+    objectAlive[object] = 0;
+    objectCount--;
+    removedObjects.push_back(object);
+
+    uint32_t leaf = objectLeaves[object];
+    if (leaf == BVH_NO_NODE)
+        pendingObjects.erase(std::find(pendingObjects.begin(), pendingObjects.end(), object));
+    else if (!nodeDirty[leaf]) // shrink the leaf without it
+    {
+        nodeDirty[leaf] = 1;
+        dirtyLeaves.push_back(leaf);
+    }
+}
+
+void BVH::update(uint32_t object, const AABB &bounds)
+{
+    if (object >= objectAlive.size() || !objectAlive[object])
+        return;
+    objectBounds[object] = bounds;
+    movedSinceBuild++;
+
+    uint32_t leaf = objectLeaves[object];
+    if (leaf != BVH_NO_NODE && !nodeDirty[leaf])
+    {
+        nodeDirty[leaf] = 1;
+        dirtyLeaves.push_back(leaf);
+    }
+}
+
+void BVH::refit()
+{
+    for (uint32_t leaf : dirtyLeaves)
+    {
+        refitLeaf(leaf);
+        nodeDirty[leaf] = 0;
+        // walk up until a node's bounds stop changing (another dirty leaf may have already fixed the rest of the path)
+        for (uint32_t parent = nodes[leaf].parent; parent != BVH_NO_NODE; parent = nodes[parent].parent)
+        {
+            AABB bounds = nodes[nodes[parent].firstChildOrObject].bounds;
+            bounds.expand(nodes[nodes[parent].firstChildOrObject + 1].bounds);
+            if (bounds.min == nodes[parent].bounds.min && bounds.max == nodes[parent].bounds.max)
+                break;
+            nodes[parent].bounds = bounds;
+        }
+    }
+    dirtyLeaves.clear();
+}
+
+void BVH::rebuild()
+{
+    if (pendingBuild.valid())
+        applyBuild(pendingBuild.get());
+    pendingBuildRemovedObjects = std::move(removedObjects);
+    removedObjects.clear();
+    movedSinceBuild = 0;
+    applyBuild(build(objectBounds, objectAlive));
+}
+
+bool BVH::maintain(ThreadPool &thread_pool)
+{
+    bool applied = false;
+    if (pendingBuild.valid() && pendingBuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+        applyBuild(pendingBuild.get());
+        applied = true;
+    }
+    refit();
+
+    if (!pendingBuild.valid() && needsRebuild())
+    {
+        // the worker builds from a copy, so the tree can keep being refitted and queried while it runs
+        pendingBuildRemovedObjects = std::move(removedObjects);
+        removedObjects.clear();
+        movedSinceBuild = 0;
+        pendingBuild = thread_pool.submit([bounds = objectBounds, alive = objectAlive]() mutable
+                                          { return build(std::move(bounds), std::move(alive)); });
+    }
+    return applied;
+}
+
+void BVH::queryFrustum(const Frustum &frustum, std::vector<uint32_t> &objects) const
+{
+    objects.clear();
+    std::vector<uint32_t> stack;
+    if (!nodes.empty())
+        stack.push_back(0);
+    while (!stack.empty())
+    {
+        uint32_t nodeIndex = stack.back();
+        stack.pop_back();
+        const BVHNode &node = nodes[nodeIndex];
+        if (!frustum.isVisible(node.bounds))
+            continue;
+        // everything inside a node that is entirely in view is visible too
+        if (frustum.contains(node.bounds))
+            collectObjects(nodeIndex, objects);
+        else if (node.objectCount > 0)
+        {
+            for (uint32_t i = 0; i < node.objectCount; i++)
+            {
+                uint32_t object = leafObjects[node.firstChildOrObject + i];
+                if (objectAlive[object] && frustum.isVisible(objectBounds[object]))
+                    objects.push_back(object);
+            }
+        }
+        else
+        {
+            stack.push_back(node.firstChildOrObject);
+            stack.push_back(node.firstChildOrObject + 1);
+        }
+    }
+
+    for (uint32_t object : pendingObjects)
+        if (frustum.isVisible(objectBounds[object]))
+            objects.push_back(object);
+}
+
+void BVH::queryOverlap(const AABB &bounds, std::vector<uint32_t> &objects) const
+{
+    objects.clear();
+    std::vector<uint32_t> stack;
+    if (!nodes.empty())
+        stack.push_back(0);
+    while (!stack.empty())
+    {
+        const BVHNode &node = nodes[stack.back()];
+        stack.pop_back();
+        if (!node.bounds.overlaps(bounds))
+            continue;
+        if (node.objectCount > 0)
+        {
+            for (uint32_t i = 0; i < node.objectCount; i++)
+            {
+                uint32_t object = leafObjects[node.firstChildOrObject + i];
+                if (objectAlive[object] && objectBounds[object].overlaps(bounds))
+                    objects.push_back(object);
+            }
+        }
+        else
+        {
+            stack.push_back(node.firstChildOrObject);
+            stack.push_back(node.firstChildOrObject + 1);
+        }
+    }
+
+    for (uint32_t object : pendingObjects)
+        if (objectBounds[object].overlaps(bounds))
+            objects.push_back(object);
+}
+
+bool BVH::raycast(const glm::vec3 &origin, const glm::vec3 &direction, float max_distance, BVHRayHit &hit) const
+{
+    glm::vec3 inverseDirection = glm::vec3(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    float closest = max_distance;
+    uint32_t closestObject = BVH_NO_NODE;
+    auto testObject = [&](uint32_t object)
+    {
+        float distance = rayEntryDistance(objectBounds[object], origin, inverseDirection, closest);
+        if (distance < closest)
+        {
+            closest = distance;
+            closestObject = object;
+        }
+    };
+
+    std::vector<uint32_t> stack;
+    if (!nodes.empty() && rayEntryDistance(nodes[0].bounds, origin, inverseDirection, closest) <= closest)
+        stack.push_back(0);
+    while (!stack.empty())
+    {
+        const BVHNode &node = nodes[stack.back()];
+        stack.pop_back();
+        // a closer hit may have been found since this node was pushed
+        if (rayEntryDistance(node.bounds, origin, inverseDirection, closest) > closest)
+            continue;
+        if (node.objectCount > 0)
+        {
+            for (uint32_t i = 0; i < node.objectCount; i++)
+                if (objectAlive[leafObjects[node.firstChildOrObject + i]])
+                    testObject(leafObjects[node.firstChildOrObject + i]);
+            continue;
+        }
+        // visit the nearer child first, so the further one is more likely to be skipped
+        uint32_t nearChild = node.firstChildOrObject, farChild = node.firstChildOrObject + 1;
+        float nearDistance = rayEntryDistance(nodes[nearChild].bounds, origin, inverseDirection, closest);
+        float farDistance = rayEntryDistance(nodes[farChild].bounds, origin, inverseDirection, closest);
+        if (farDistance < nearDistance)
+        {
+            std::swap(nearChild, farChild);
+            std::swap(nearDistance, farDistance);
+        }
+        if (farDistance <= closest)
+            stack.push_back(farChild);
+        if (nearDistance <= closest)
+            stack.push_back(nearChild);
+    }
+
+    for (uint32_t object : pendingObjects)
+        testObject(object);
+
+    if (closestObject == BVH_NO_NODE)
+        return false;
+    hit = {closestObject, closest};
+    return true;
+}
+
+size_t BVH::getObjectCount() const
+{
+    return objectCount;
+}
+
+size_t BVH::getNodeCount() const
+{
+    return nodes.size();
+}
+
+bool BVH::isRebuilding() const
+{
+    return pendingBuild.valid();
+}
+
+BVH::BuildResult BVH::build(std::vector<AABB> bounds, std::vector<uint8_t> alive)
+{
+    // the objects are partitioned by value rather than through their ids, so each node reads a contiguous run of memory
+    struct BuildObject
+    {
+        AABB bounds;
+        glm::vec3 centroid;
+        uint32_t object;
+    };
+    std::vector<BuildObject> objects;
+    for (uint32_t object = 0; object < bounds.size(); object++)
+        if (alive[object])
+            objects.push_back({bounds[object], bounds[object].getCentre(), object});
+
+    BuildResult result;
+    if (objects.empty())
+        return result;
+    // a binary tree with at least 1 object per leaf has fewer than 2n nodes
+    result.nodes.reserve(2 * objects.size());
+    result.nodes.push_back({AABB::empty(), 0, 0, BVH_NO_NODE});
+
+    struct BuildTask
+    {
+        uint32_t node, begin, end;
+    };
+    std::vector<BuildTask> tasks = {{0, 0, (uint32_t)objects.size()}};
+    while (!tasks.empty())
+    {
+        BuildTask task = tasks.back();
+        tasks.pop_back();
+
+        AABB nodeBounds = AABB::empty(), centroidBounds = AABB::empty();
+        for (uint32_t i = task.begin; i < task.end; i++)
+        {
+            nodeBounds.expand(objects[i].bounds);
+            centroidBounds.expand({objects[i].centroid, objects[i].centroid});
+        }
+        result.nodes[task.node].bounds = nodeBounds;
+        uint32_t count = task.end - task.begin;
+        if (count <= BVH_MAX_LEAF_SIZE)
+        {
+            result.nodes[task.node].firstChildOrObject = task.begin;
+            result.nodes[task.node].objectCount = count;
+            continue;
+        }
+
+        // bin the centroids along each axis and pick the split between bins with the lowest surface area cost
+        int bestAxis = -1;
+        unsigned int bestSplit = 0;
+        float bestCost = std::numeric_limits<float>::max();
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+            if (extent <= 0.0f)
+                continue;
+            float scale = BVH_SAH_BIN_COUNT / extent;
+            AABB binBounds[BVH_SAH_BIN_COUNT];
+            uint32_t binCounts[BVH_SAH_BIN_COUNT] = {};
+            std::fill(binBounds, binBounds + BVH_SAH_BIN_COUNT, AABB::empty());
+            for (uint32_t i = task.begin; i < task.end; i++)
+            {
+                unsigned int bin = std::min(BVH_SAH_BIN_COUNT - 1, (unsigned int)((objects[i].centroid[axis] - centroidBounds.min[axis]) * scale));
+                binCounts[bin]++;
+                binBounds[bin].expand(objects[i].bounds);
+            }
+
+            // sweep from the right to get the cost of everything right of each split, then from the left
+            float rightAreas[BVH_SAH_BIN_COUNT];
+            uint32_t rightCounts[BVH_SAH_BIN_COUNT];
+            AABB right = AABB::empty();
+            uint32_t rightCount = 0;
+            for (unsigned int bin = BVH_SAH_BIN_COUNT - 1; bin > 0; bin--)
+            {
+                right.expand(binBounds[bin]);
+                rightCount += binCounts[bin];
+                rightAreas[bin] = right.getSurfaceArea();
+                rightCounts[bin] = rightCount;
+            }
+            AABB left = AABB::empty();
+            uint32_t leftCount = 0;
+            for (unsigned int split = 1; split < BVH_SAH_BIN_COUNT; split++)
+            {
+                left.expand(binBounds[split - 1]);
+                leftCount += binCounts[split - 1];
+                if (leftCount == 0 || rightCounts[split] == 0)
+                    continue;
+                float cost = leftCount * left.getSurfaceArea() + rightCounts[split] * rightAreas[split];
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = split;
+                }
+            }
+        }
+
+        uint32_t middle;
+        if (bestAxis == -1) // every centroid is in the same place, so any split is as good as another
+            middle = task.begin + count / 2;
+        else
+        {
+            float scale = BVH_SAH_BIN_COUNT / (centroidBounds.max[bestAxis] - centroidBounds.min[bestAxis]);
+            auto isLeft = [&](const BuildObject &object)
+            { return std::min(BVH_SAH_BIN_COUNT - 1, (unsigned int)((object.centroid[bestAxis] - centroidBounds.min[bestAxis]) * scale)) < bestSplit; };
+            middle = (uint32_t)(std::partition(objects.begin() + task.begin, objects.begin() + task.end, isLeft) - objects.begin());
+        }
+
+        uint32_t leftChild = (uint32_t)result.nodes.size();
+        result.nodes[task.node].firstChildOrObject = leftChild;
+        result.nodes[task.node].objectCount = 0;
+        result.nodes.push_back({AABB::empty(), 0, 0, task.node});
+        result.nodes.push_back({AABB::empty(), 0, 0, task.node});
+        tasks.push_back({leftChild, task.begin, middle});
+        tasks.push_back({leftChild + 1, middle, task.end});
+    }
+
+    result.leafObjects.reserve(objects.size());
+    for (const BuildObject &object : objects)
+        result.leafObjects.push_back(object.object);
+    return result;
+}
+
+void BVH::applyBuild(BuildResult &&result)
+{
+    nodes = std::move(result.nodes);
+    leafObjects = std::move(result.leafObjects);
+    objectLeaves.assign(objectBounds.size(), BVH_NO_NODE);
+    nodeDirty.assign(nodes.size(), 0);
+    dirtyLeaves.clear();
+
+    // the objects may have moved while the tree was built, so refit all of it (children always come after their parent)
+    for (size_t i = nodes.size(); i-- > 0;)
+    {
+        BVHNode &node = nodes[i];
+        if (node.objectCount > 0)
+        {
+            for (uint32_t j = 0; j < node.objectCount; j++)
+                objectLeaves[leafObjects[node.firstChildOrObject + j]] = (uint32_t)i;
+            refitLeaf((uint32_t)i);
+        }
+        else
+        {
+            node.bounds = nodes[node.firstChildOrObject].bounds;
+            node.bounds.expand(nodes[node.firstChildOrObject + 1].bounds);
+        }
+    }
+
+    // objects added while the tree was built are still pending
+    pendingObjects.erase(std::remove_if(pendingObjects.begin(), pendingObjects.end(), [this](uint32_t object)
+                                        { return objectLeaves[object] != BVH_NO_NODE; }),
+                         pendingObjects.end());
+    // nothing can refer to objects removed before the build started any more
+    freeObjects.insert(freeObjects.end(), pendingBuildRemovedObjects.begin(), pendingBuildRemovedObjects.end());
+    pendingBuildRemovedObjects.clear();
+}
+
+bool BVH::needsRebuild() const
+{
+    if (objectCount == 0)
+        return false;
+    size_t untracked = pendingObjects.size() + removedObjects.size();
+    return untracked > std::max<size_t>(BVH_MAX_LEAF_SIZE, (size_t)(BVH_REBUILD_PENDING_FRACTION * objectCount)) ||
+           movedSinceBuild > BVH_REBUILD_MOVED_FRACTION * objectCount;
+}
+
+void BVH::refitLeaf(uint32_t node_index)
+{
+    BVHNode &node = nodes[node_index];
+    node.bounds = AABB::empty();
+    for (uint32_t i = 0; i < node.objectCount; i++)
+    {
+        uint32_t object = leafObjects[node.firstChildOrObject + i];
+        if (objectAlive[object])
+            node.bounds.expand(objectBounds[object]);
+    }
+}
+
+void BVH::collectObjects(uint32_t node_index, std::vector<uint32_t> &objects) const
+{
+    std::vector<uint32_t> stack = {node_index};
+    while (!stack.empty())
+    {
+        const BVHNode &node = nodes[stack.back()];
+        stack.pop_back();
+        if (node.objectCount > 0)
+        {
+            for (uint32_t i = 0; i < node.objectCount; i++)
+                if (objectAlive[leafObjects[node.firstChildOrObject + i]])
+                    objects.push_back(leafObjects[node.firstChildOrObject + i]);
+        }
+        else
+        {
+            stack.push_back(node.firstChildOrObject);
+            stack.push_back(node.firstChildOrObject + 1);
+        }
+    }
+}
@@ -0,0 +1,117 @@
+#include "rendering/culling/frustum.h"
+#include <cmath>
+
+// SSE is always available on x86-64
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRUSTUM_CULLING_SSE
+#include <xmmintrin.h>
+#endif
+
+Frustum::Frustum(const glm::mat4 &view_projection)
+{
+    // each plane is the sum or difference of the last row with another row of the matrix (Gribb & Hartmann) - glm is column major
+    auto row = [&](int i)
+    { return glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]); };
+    planes[(int)FRUSTUM_PLANE::LEFT] = row(3) + row(0);
+    planes[(int)FRUSTUM_PLANE::RIGHT] = row(3) - row(0);
+    planes[(int)FRUSTUM_PLANE::BOTTOM] = row(3) + row(1);
+    planes[(int)FRUSTUM_PLANE::TOP] = row(3) - row(1);
+    planes[(int)FRUSTUM_PLANE::NEAR_CLIP] = row(3) + row(2);
+    planes[(int)FRUSTUM_PLANE::FAR_CLIP] = row(3) - row(2);
+    // normalise so distances to the planes are in world units
+    for (glm::vec4 &plane : planes)
+        plane /= glm::length(glm::vec3(plane));
+}
+
+Frustum Frustum::transformed(const glm::mat4 &transform) const
+{
+    // a point p is in front of a plane if dot(plane, transform * p) >= 0, which is dot(transpose(transform) * plane, p)
+    Frustum result = *this;
+    glm::mat4 transposed = glm::transpose(transform);
+    for (glm::vec4 &plane : result.planes)
+    {
+        plane = transposed * plane;
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return result;
+}
+
+bool Frustum::isVisible(const AABB &bounds) const
+{
+    glm::vec3 centre = bounds.getCentre(), extents = bounds.getExtents();
+    for (const glm::vec4 &plane : planes)
+    {
+        // the box is outside if even its corner furthest along the plane normal is behind the plane
+        glm::vec3 normal = glm::vec3(plane);
+        float distance = glm::dot(normal, centre) + plane.w;
+        float radius = glm::dot(glm::abs(normal), extents);
+        if (distance + radius < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+bool Frustum::contains(const AABB &bounds) const
+{
+    glm::vec3 centre = bounds.getCentre(), extents = bounds.getExtents();
+    for (const glm::vec4 &plane : planes)
+    {
+        // the box is inside if even its corner furthest against the plane normal is in front of the plane
+        glm::vec3 normal = glm::vec3(plane);
+        if (glm::dot(normal, centre) + plane.w - glm::dot(glm::abs(normal), extents) < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+size_t Frustum::cull(const CullingBounds &bounds, std::vector<uint8_t> &visible) const
+{
+#ifdef FRUSTUM_CULLING_SSE
+    visible.resize(bounds.size());
+    size_t visibleCount = 0;
+    // the arrays are padded to a whole number of batches, so every load is in bounds
+    for (size_t i = 0; i < bounds.size(); i += CULLING_BATCH_SIZE)
+    {
+        __m128 centreX = _mm_loadu_ps(&bounds.centreX[i]), centreY = _mm_loadu_ps(&bounds.centreY[i]), centreZ = _mm_loadu_ps(&bounds.centreZ[i]);
+        __m128 extentX = _mm_loadu_ps(&bounds.extentX[i]), extentY = _mm_loadu_ps(&bounds.extentY[i]), extentZ = _mm_loadu_ps(&bounds.extentZ[i]);
+        __m128 outside = _mm_setzero_ps();
+        for (const glm::vec4 &plane : planes)
+        {
+            // distance + radius, for 4 boxes at once
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(centreX, _mm_set1_ps(plane.x)), _mm_mul_ps(centreY, _mm_set1_ps(plane.y))),
+                                         _mm_add_ps(_mm_mul_ps(centreZ, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(extentX, _mm_set1_ps(std::abs(plane.x))), _mm_mul_ps(extentY, _mm_set1_ps(std::abs(plane.y)))),
+                                       _mm_mul_ps(extentZ, _mm_set1_ps(std::abs(plane.z))));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+        int outsideMask = _mm_movemask_ps(outside);
+        for (size_t lane = 0; lane < CULLING_BATCH_SIZE && i + lane < bounds.size(); lane++)
+        {
+            visible[i + lane] = (outsideMask >> lane) & 1 ? 0 : 1;
+            visibleCount += visible[i + lane];
+        }
+    }
+    return visibleCount;
+#else
+    return cullScalar(bounds, visible);
+#endif
+}
+
+size_t Frustum::cullScalar(const CullingBounds &bounds, std::vector<uint8_t> &visible) const
+{
+    visible.resize(bounds.size());
+    size_t visibleCount = 0;
+    for (size_t i = 0; i < bounds.size(); i++)
+    {
+        glm::vec3 centre = glm::vec3(bounds.centreX[i], bounds.centreY[i], bounds.centreZ[i]);
+        glm::vec3 extents = glm::vec3(bounds.extentX[i], bounds.extentY[i], bounds.extentZ[i]);
+        visible[i] = isVisible({centre - extents, centre + extents}) ? 1 : 0;
+        visibleCount += visible[i];
+    }
+    return visibleCount;
+}
+
+const glm::vec4 &Frustum::getPlane(FRUSTUM_PLANE plane) const
+{
+    return planes[(int)plane];
+}
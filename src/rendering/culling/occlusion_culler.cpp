@@ -0,0 +1,291 @@
+#include "rendering/culling/occlusion_culler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+// SSE is always available on x86-64
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_CULLING_SSE
+#include <xmmintrin.h>
+#endif
+
+// vertices closer than this to the camera plane (in clip space w) are clipped away
+static const float OCCLUSION_NEAR_W = 1e-5f;
+
+OccluderMesh OccluderMesh::fromBox(const AABB &bounds)
+{
+    OccluderMesh mesh;
+    for (int corner = 0; corner < 8; corner++)
+        mesh.positions.push_back(glm::vec3(corner & 1 ? bounds.max.x : bounds.min.x, corner & 2 ? bounds.max.y : bounds.min.y, corner & 4 ? bounds.max.z : bounds.min.z));
+    // two triangles per face (both sides are drawn, so the winding does not matter)
+    mesh.indices = {0, 1, 3, 0, 3, 2, 4, 6, 7, 4, 7, 5,  // -z, +z
+                    0, 4, 5, 0, 5, 1, 2, 3, 7, 2, 7, 6,  // -y, +y
+                    0, 2, 6, 0, 6, 4, 1, 5, 7, 1, 7, 3}; // -x, +x
+    return mesh;
+}
+
+OcclusionCuller::OcclusionCuller(ThreadPool &thread_pool, unsigned int width, unsigned int height)
+    : threadPool(thread_pool), width(0), height(0), tilesX(0), tilesY(0), depthBuffer(), viewProjection(1.0f), occluders(), occluderTriangles(),
+      tileBins(), stats(), objectsTested(0), objectsRejected(0)
+{
+    tilesX = std::max(1u, (width + OCCLUSION_TILE_WIDTH - 1) / OCCLUSION_TILE_WIDTH);
+    tilesY = std::max(1u, (height + OCCLUSION_TILE_HEIGHT - 1) / OCCLUSION_TILE_HEIGHT);
+    this->width = tilesX * OCCLUSION_TILE_WIDTH;
+    this->height = tilesY * OCCLUSION_TILE_HEIGHT;
+    depthBuffer.assign((size_t)this->width * this->height, 1.0f);
+    tileBins.resize((size_t)tilesX * tilesY);
+}
+
+void OcclusionCuller::beginFrame(const glm::mat4 &view_projection)
+{
+    viewProjection = view_projection;
+    occluders.clear();
+    std::fill(depthBuffer.begin(), depthBuffer.end(), 1.0f);
+    stats = OcclusionStats();
+    objectsTested = 0;
+    objectsRejected = 0;
+}
+
+void OcclusionCuller::addOccluder(const OccluderMesh &occluder, const glm::mat4 &model)
+{
+    occluders.push_back({&occluder, viewProjection * model});
+}
+
+void OcclusionCuller::rasterize()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    // transform and clip each occluder's triangles in parallel
+    occluderTriangles.resize(occluders.size());
+    threadPool.parallelFor(occluders.size(), 1, [this](size_t begin, size_t end)
+                           {
+                               for (size_t i = begin; i < end; i++)
+                               {
+                                   occluderTriangles[i].clear();
+                                   setupTriangles(i, occluderTriangles[i]);
+                               } });
+
+    // bin each triangle into the tiles its bounds overlap
+    for (auto &bin : tileBins)
+        bin.clear();
+    for (uint32_t occluder = 0; occluder < occluders.size(); occluder++)
+    {
+        const std::vector<ScreenTriangle> &triangles = occluderTriangles[occluder];
+        if (!triangles.empty())
+            stats.occludersDrawn++;
+        stats.trianglesDrawn += (unsigned int)triangles.size();
+        for (uint32_t triangle = 0; triangle < triangles.size(); triangle++)
+        {
+            const glm::vec3 *vertices = triangles[triangle].vertices;
+            float minX = std::min({vertices[0].x, vertices[1].x, vertices[2].x}), maxX = std::max({vertices[0].x, vertices[1].x, vertices[2].x});
+            float minY = std::min({vertices[0].y, vertices[1].y, vertices[2].y}), maxY = std::max({vertices[0].y, vertices[1].y, vertices[2].y});
+            if (maxX < 0.0f || maxY < 0.0f || minX >= width || minY >= height)
+                continue;
+            unsigned int firstTileX = (unsigned int)std::max(0.0f, minX) / OCCLUSION_TILE_WIDTH, lastTileX = std::min((unsigned int)maxX / OCCLUSION_TILE_WIDTH, tilesX - 1);
+            unsigned int firstTileY = (unsigned int)std::max(0.0f, minY) / OCCLUSION_TILE_HEIGHT, lastTileY = std::min((unsigned int)maxY / OCCLUSION_TILE_HEIGHT, tilesY - 1);
+            for (unsigned int tileY = firstTileY; tileY <= lastTileY; tileY++)
+                for (unsigned int tileX = firstTileX; tileX <= lastTileX; tileX++)
+                    tileBins[tileY * tilesX + tileX].push_back({occluder, triangle});
+        }
+    }
+
+    // tiles cover separate pixels, so they can be drawn at the same time without locking
+    threadPool.parallelFor(tileBins.size(), 1, [this](size_t begin, size_t end)
+                           {
+                               for (size_t tile = begin; tile < end; tile++)
+                                   rasterizeTile(tile); });
+
+    stats.rasterMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool OcclusionCuller::isVisible(const AABB &bounds) const
+{
+    objectsTested++;
+    glm::vec3 screenMin = glm::vec3(std::numeric_limits<float>::max()), screenMax = glm::vec3(-std::numeric_limits<float>::max());
+    for (int corner = 0; corner < 8; corner++)
+    {
+        glm::vec4 clip = viewProjection * glm::vec4(corner & 1 ? bounds.max.x : bounds.min.x, corner & 2 ? bounds.max.y : bounds.min.y, corner & 4 ? bounds.max.z : bounds.min.z, 1.0f);
+        // a box crossing the near plane is too close to be hidden
+        if (clip.w <= OCCLUSION_NEAR_W || clip.z < -clip.w)
+            return true;
+        glm::vec3 screen = toScreen(clip);
+        screenMin = glm::min(screenMin, screen);
+        screenMax = glm::max(screenMax, screen);
+    }
+    // off screen boxes are left to frustum culling
+    if (screenMax.x < 0.0f || screenMax.y < 0.0f || screenMin.x >= width || screenMin.y >= height)
+        return true;
+
+    // the box is visible if any pixel it covers has no occluder in front of its nearest point
+    int firstX = std::max(0, (int)screenMin.x), lastX = std::min((int)width - 1, (int)screenMax.x);
+    int firstY = std::max(0, (int)screenMin.y), lastY = std::min((int)height - 1, (int)screenMax.y);
+    float nearestDepth = screenMin.z - OCCLUSION_DEPTH_BIAS;
+    for (int y = firstY; y <= lastY; y++)
+    {
+        const float *row = &depthBuffer[(size_t)y * width];
+        int x = firstX;
+#ifdef OCCLUSION_CULLING_SSE
+        __m128 depth = _mm_set1_ps(nearestDepth);
+        for (; x + 3 <= lastX; x += 4)
+            if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), depth)))
+                return true;
+#endif
+        for (; x <= lastX; x++)
+            if (row[x] >= nearestDepth)
+                return true;
+    }
+    objectsRejected++;
+    return false;
+}
+
+size_t OcclusionCuller::cull(const std::vector<AABB> &bounds, std::vector<uint8_t> &visible)
+{
+    auto start = std::chrono::steady_clock::now();
+    visible.resize(bounds.size());
+    threadPool.parallelFor(bounds.size(), 256, [&](size_t begin, size_t end)
+                           {
+                               for (size_t i = begin; i < end; i++)
+                                   visible[i] = isVisible(bounds[i]) ? 1 : 0; });
+    size_t visibleCount = std::count(visible.begin(), visible.end(), (uint8_t)1);
+    stats.testMilliseconds += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return visibleCount;
+}
+
+OcclusionStats OcclusionCuller::getStats() const
+{
+    OcclusionStats result = stats;
+    result.objectsTested = objectsTested;
+    result.objectsRejected = objectsRejected;
+    return result;
+}
+
+const std::vector<float> &OcclusionCuller::getDepthBuffer() const
+{
+    return depthBuffer;
+}
+
+void OcclusionCuller::setupTriangles(size_t occluder_index, std::vector<ScreenTriangle> &triangles) const
+{
+    const OccluderInstance &occluder = occluders[occluder_index];
+    std::vector<glm::vec4> clip;
+    clip.reserve(occluder.mesh->positions.size());
+    for (const glm::vec3 &position : occluder.mesh->positions)
+        clip.push_back(occluder.modelViewProjection * glm::vec4(position, 1.0f));
+
+    for (size_t i = 0; i + 2 < occluder.mesh->indices.size(); i += 3)
+    {
+        const glm::vec4 corners[3] = {clip[occluder.mesh->indices[i]], clip[occluder.mesh->indices[i + 1]], clip[occluder.mesh->indices[i + 2]]};
+        // skip triangles entirely outside one side of the frustum
+        bool outside = false;
+        for (int axis = 0; axis < 3 && !outside; axis++)
+            outside = (corners[0][axis] > corners[0].w && corners[1][axis] > corners[1].w && corners[2][axis] > corners[2].w) ||
+                      (axis < 2 && corners[0][axis] < -corners[0].w && corners[1][axis] < -corners[1].w && corners[2][axis] < -corners[2].w);
+        if (outside)
+            continue;
+
+        // clip against the near plane (z = -w), which turns the triangle into a polygon of up to 4 vertices
+        glm::vec4 polygon[4];
+        int polygonSize = 0;
+        for (int v = 0; v < 3; v++)
+        {
+            const glm::vec4 &current = corners[v], &next = corners[(v + 1) % 3];
+            float currentDistance = current.z + current.w, nextDistance = next.z + next.w;
+            if (currentDistance >= 0.0f && current.w > OCCLUSION_NEAR_W)
+                polygon[polygonSize++] = current;
+            if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+            {
+                float t = currentDistance / (currentDistance - nextDistance);
+                glm::vec4 crossing = current + (next - current) * t;
+                if (crossing.w > OCCLUSION_NEAR_W)
+                    polygon[polygonSize++] = crossing;
+            }
+        }
+
+        for (int v = 1; v + 1 < polygonSize; v++)
+        {
+            ScreenTriangle triangle = {{toScreen(polygon[0]), toScreen(polygon[v]), toScreen(polygon[v + 1])}};
+            const glm::vec3 *vertices = triangle.vertices;
+            float area = (vertices[1].x - vertices[0].x) * (vertices[2].y - vertices[0].y) - (vertices[1].y - vertices[0].y) * (vertices[2].x - vertices[0].x);
+            if (std::abs(area) > 1e-6f)
+                triangles.push_back(triangle);
+        }
+    }
+}
+
+void OcclusionCuller::rasterizeTile(size_t tile_index)
+{
+    int tileMinX = (int)((tile_index % tilesX) * OCCLUSION_TILE_WIDTH), tileMinY = (int)((tile_index / tilesX) * OCCLUSION_TILE_HEIGHT);
+    int tileMaxX = tileMinX + OCCLUSION_TILE_WIDTH - 1, tileMaxY = tileMinY + OCCLUSION_TILE_HEIGHT - 1;
+
+    for (const auto &binned : tileBins[tile_index])
+    {
+        glm::vec3 a = occluderTriangles[binned.first][binned.second].vertices[0];
+        glm::vec3 b = occluderTriangles[binned.first][binned.second].vertices[1];
+        glm::vec3 c = occluderTriangles[binned.first][binned.second].vertices[2];
+        float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        if (area < 0.0f) // make the winding counter clockwise, so the inside is where every edge function is positive
+        {
+            std::swap(b, c);
+            area = -area;
+        }
+
+        // edge functions (A * x + B * y + C) for edges ab, bc and ca
+        const glm::vec3 *edgeStarts[3] = {&a, &b, &c}, *edgeEnds[3] = {&b, &c, &a};
+        float edgeA[3], edgeB[3], edgeC[3];
+        for (int edge = 0; edge < 3; edge++)
+        {
+            edgeA[edge] = edgeStarts[edge]->y - edgeEnds[edge]->y;
+            edgeB[edge] = edgeEnds[edge]->x - edgeStarts[edge]->x;
+            edgeC[edge] = -(edgeA[edge] * edgeStarts[edge]->x + edgeB[edge] * edgeStarts[edge]->y);
+        }
+        // depth is linear in screen space
+        float depthX = ((b.z - a.z) * (c.y - a.y) - (c.z - a.z) * (b.y - a.y)) / area;
+        float depthY = ((c.z - a.z) * (b.x - a.x) - (b.z - a.z) * (c.x - a.x)) / area;
+        float depthC = a.z - depthX * a.x - depthY * a.y;
+
+        // the pixels the triangle's bounds cover in this tile (starting on a multiple of 4 for SIMD)
+        int minX = std::max(tileMinX, (int)std::floor(std::min({a.x, b.x, c.x}))) & ~3, maxX = std::min(tileMaxX, (int)std::floor(std::max({a.x, b.x, c.x})));
+        int minY = std::max(tileMinY, (int)std::floor(std::min({a.y, b.y, c.y}))), maxY = std::min(tileMaxY, (int)std::floor(std::max({a.y, b.y, c.y})));
+
+        for (int y = minY; y <= maxY; y++)
+        {
+            float *row = &depthBuffer[(size_t)y * width];
+            float centreY = y + 0.5f;
+#ifdef OCCLUSION_CULLING_SSE
+            __m128 rowEdge0 = _mm_set1_ps(edgeB[0] * centreY + edgeC[0]), rowEdge1 = _mm_set1_ps(edgeB[1] * centreY + edgeC[1]);
+            __m128 rowEdge2 = _mm_set1_ps(edgeB[2] * centreY + edgeC[2]), rowDepth = _mm_set1_ps(depthY * centreY + depthC);
+            __m128 zero = _mm_setzero_ps();
+            // the tile width is a multiple of 4, so groups of 4 never cross into the next tile
+            for (int x = minX; x <= maxX; x += 4)
+            {
+                __m128 centreX = _mm_add_ps(_mm_set1_ps((float)x), _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f));
+                __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeA[0]), centreX), rowEdge0), zero),
+                                                      _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeA[1]), centreX), rowEdge1), zero)),
+                                           _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeA[2]), centreX), rowEdge2), zero));
+                if (!_mm_movemask_ps(inside))
+                    continue;
+                __m128 depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(depthX), centreX), rowDepth);
+                __m128 current = _mm_loadu_ps(row + x);
+                __m128 nearest = _mm_min_ps(current, depth);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+            }
+#else
+            for (int x = minX; x <= maxX; x++)
+            {
+                float centreX = x + 0.5f;
+                if (edgeA[0] * centreX + edgeB[0] * centreY + edgeC[0] < 0.0f || edgeA[1] * centreX + edgeB[1] * centreY + edgeC[1] < 0.0f ||
+                    edgeA[2] * centreX + edgeB[2] * centreY + edgeC[2] < 0.0f)
+                    continue;
+                row[x] = std::min(row[x], depthX * centreX + depthY * centreY + depthC);
+            }
+#endif
+        }
+    }
+}
+
+glm::vec3 OcclusionCuller::toScreen(const glm::vec4 &clip) const
+{
+    glm::vec3 ndc = glm::vec3(clip) / clip.w;
+    return glm::vec3((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z * 0.5f + 0.5f);
+}
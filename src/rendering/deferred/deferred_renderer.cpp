@@ -0,0 +1,60 @@
+#include "rendering/deferred/deferred_renderer.h"
+#include "rendering/uniform_blocks/uniform_blocks.h"
+#include <string>
+
+DeferredRenderer::DeferredRenderer(int width, int height, bool clustered_lights)
+    : gBuffer(width, height),
+      lightingShaders("shaders/fullscreen.vert", "shaders/deferred_lighting.frag", ShaderPermutation().setDefine("NR_POINT_LIGHTS", std::to_string(MAX_POINT_LIGHTS))),
+      clusteredLightingShaders(), fullscreenVAO()
+{
+    lightingShaders.precompile({ShaderPermutation()});
+    if (clustered_lights)
+    {
+        clusteredLightingShaders = std::make_unique<ShaderVariants>("shaders/fullscreen.vert", "shaders/deferred_clustered_lighting.frag",
+                                                                    ShaderPermutation().setDefine("NR_POINT_LIGHTS", std::to_string(MAX_POINT_LIGHTS)));
+        clusteredLightingShaders->precompile({ShaderPermutation()});
+    }
+}
+
+void DeferredRenderer::beginGeometryPass(int width, int height)
+{
+    gBuffer.resize(width, height);
+    gBuffer.bind();
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void DeferredRenderer::endGeometryPass()
+{
+    gBuffer.unbind();
+}
+
+void DeferredRenderer::executeLightingPass(const glm::mat4 &view, const glm::mat4 &projection, bool clustered_lights)
+{
+    ShaderVariants &shaders = clustered_lights && clusteredLightingShaders ? *clusteredLightingShaders : lightingShaders;
+    Shader &shader = shaders.getVariant(ShaderPermutation());
+    shader.use();
+    gBuffer.bindTextures(GL_TEXTURE0);
+    shader.setUniform("gAlbedoSpecular", (int)GBUFFER_ATTACHMENT::ALBEDO_SPECULAR);
+    shader.setUniform("gNormalShininess", (int)GBUFFER_ATTACHMENT::NORMAL_SHININESS);
+    shader.setUniform("gDepth", (int)GBUFFER_ATTACHMENT::DEPTH);
+    shader.setUniform("inverseViewProjection", 1, false, glm::inverse(projection * view));
+
+    // every pixel is shaded exactly once, and the sky (which has nothing in the G-buffer) is left as cleared
+    glDisable(GL_DEPTH_TEST);
+    fullscreenVAO.bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glEnable(GL_DEPTH_TEST);
+    gBuffer.copyDepthToOutput();
+}
+
+void DeferredRenderer::reload(const std::set<std::string> &affected_files)
+{
+    lightingShaders.reload(affected_files);
+    if (clusteredLightingShaders)
+        clusteredLightingShaders->reload(affected_files);
+}
+
+const GBuffer &DeferredRenderer::getGBuffer() const
+{
+    return gBuffer;
+}
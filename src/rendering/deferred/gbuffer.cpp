@@ -0,0 +1,120 @@
+#include "rendering/deferred/gbuffer.h"
+#include "rendering/state_cache/gl_state_cache.h"
+#include "utils/logging/logging.h"
+#include <string>
+
+// how each attachment is stored and where it is attached
+struct GBufferFormat
+{
+    GLenum internalFormat;
+    GLenum format;
+    GLenum type;
+    GLenum attachment;
+    unsigned int bytesPerPixel;
+};
+static const GBufferFormat GBUFFER_FORMATS[GBUFFER_ATTACHMENT_COUNT] = {
+    {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, GL_COLOR_ATTACHMENT0, 4},
+    {GL_RGB10_A2, GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV, GL_COLOR_ATTACHMENT1, 4},
+    {GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, GL_DEPTH_STENCIL_ATTACHMENT, 4}};
+
+GBuffer::GBuffer(int width, int height)
+    : framebuffer_ID(0), outputFramebuffer_ID(0), textures(), width(width), height(height)
+{
+    glGenFramebuffers(1, &framebuffer_ID);
+    glGenTextures(GBUFFER_ATTACHMENT_COUNT, textures);
+    allocate();
+}
+
+GBuffer::~GBuffer()
+{
+    for (GLuint texture : textures)
+        GLStateCache::forgetTexture(texture);
+    glDeleteTextures(GBUFFER_ATTACHMENT_COUNT, textures);
+    glDeleteFramebuffers(1, &framebuffer_ID);
+}
+
+void GBuffer::resize(int width, int height)
+{
+    if (width == this->width && height == this->height)
+        return;
+    this->width = width;
+    this->height = height;
+    allocate();
+}
+
+void GBuffer::bind()
+{
+    GLint output;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &output);
+    outputFramebuffer_ID = (GLuint)output;
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_ID);
+    glViewport(0, 0, width, height);
+}
+
+void GBuffer::unbind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer_ID);
+}
+
+void GBuffer::bindTextures(GLenum first_unit) const
+{
+    for (unsigned int i = 0; i < GBUFFER_ATTACHMENT_COUNT; i++)
+    {
+        GLStateCache::bindTexture(first_unit + i, GL_TEXTURE_2D, textures[i]);
+        // a material's sampler left on the unit would override the attachment's nearest filtering
+        GLStateCache::bindSampler(first_unit - GL_TEXTURE0 + i, 0);
+    }
+}
+
+void GBuffer::copyDepthToOutput() const
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_ID);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, outputFramebuffer_ID);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer_ID);
+}
+
+int GBuffer::getWidth() const
+{
+    return width;
+}
+
+int GBuffer::getHeight() const
+{
+    return height;
+}
+
+size_t GBuffer::getMemorySize() const
+{
+    size_t bytesPerPixel = 0;
+    for (const GBufferFormat &format : GBUFFER_FORMATS)
+        bytesPerPixel += format.bytesPerPixel;
+    return bytesPerPixel * width * height;
+}
+
+void GBuffer::allocate()
+{
+    GLint previous;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_ID);
+    for (unsigned int i = 0; i < GBUFFER_ATTACHMENT_COUNT; i++)
+    {
+        const GBufferFormat &format = GBUFFER_FORMATS[i];
+        GLStateCache::bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, textures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, format.internalFormat, width, height, 0, format.format, format.type, nullptr);
+        // the lighting pass reads one texel per pixel, so there are no mips
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, format.attachment, GL_TEXTURE_2D, textures[i], 0);
+    }
+    const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, drawBuffers);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        LOG("G-buffer framebuffer " + std::to_string(framebuffer_ID) + " is incomplete", Logging::LOG_TYPE::ERROR);
+    else
+        LOG("Allocated G-buffer: " + std::to_string(width) + "x" + std::to_string(height) + " (" + std::to_string(getMemorySize() / 1024) + " KiB)",
+            Logging::LOG_TYPE::INFO);
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previous);
+}
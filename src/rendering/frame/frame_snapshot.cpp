@@ -0,0 +1,43 @@
+#include "rendering/frame/frame_snapshot.h"
+
+ImGuiDrawSnapshot::ImGuiDrawSnapshot()
+    : drawData(), drawLists()
+{
+}
+
+ImGuiDrawSnapshot::~ImGuiDrawSnapshot()
+{
+    for (ImDrawList *drawList : drawLists)
+        IM_DELETE(drawList);
+}
+
+void ImGuiDrawSnapshot::capture(const ImDrawData *draw_data)
+{
+    // reuse last frame's lists, so their buffers keep their capacity
+    while ((int)drawLists.size() < draw_data->CmdListsCount)
+        drawLists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+    for (int i = 0; i < draw_data->CmdListsCount; i++)
+    {
+        const ImDrawList *source = draw_data->CmdLists[i];
+        ImDrawList *copy = drawLists[i];
+        copy->CmdBuffer = source->CmdBuffer;
+        copy->IdxBuffer = source->IdxBuffer;
+        copy->VtxBuffer = source->VtxBuffer;
+        copy->Flags = source->Flags;
+    }
+
+    // the counts, display rect and scale are copied as they are, then the lists are pointed at the copies
+    drawData = *draw_data;
+#if IMGUI_VERSION_NUM >= 18980
+    // since 1.89.8 the draw data owns its array of lists
+    for (int i = 0; i < draw_data->CmdListsCount; i++)
+        drawData.CmdLists[i] = drawLists[i];
+#else
+    drawData.CmdLists = drawLists.data();
+#endif
+}
+
+ImDrawData *ImGuiDrawSnapshot::getDrawData()
+{
+    return &drawData;
+}
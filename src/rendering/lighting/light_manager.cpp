@@ -0,0 +1,244 @@
+#include "rendering/lighting/light_manager.h"
+#include "rendering/buffer/ssbo/ssbo.h"
+#include "rendering/capabilities/gl_capabilities.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+LightManager::LightManager(ThreadPool &thread_pool)
+    : threadPool(thread_pool), lights(), lightBounds(), view(1.0f), projection(1.0f), nearPlane(0.1f), farPlane(100.0f), header(), clusters(),
+      sliceLightIndices(LIGHT_CLUSTERS_Z), lightIndices(), lightBuffer(), clusterBuffer(), lightIndexBuffer(), stats()
+{
+}
+
+LightManager::~LightManager()
+{
+}
+
+bool LightManager::isSupported()
+{
+    // the clustered shaders are GLSL 4.30 (for their std430 light blocks), so the extension alone is not enough on an older context
+    return GLCapabilities::isVersionAtLeast(4, 3);
+}
+
+size_t LightManager::addLight(const PointLightData &light)
+{
+    // solve constant + linear * d + quadratic * d^2 = brightest / cutoff for the distance where the light fades below the cutoff
+    float brightest = std::max({light.diffuse.x, light.diffuse.y, light.diffuse.z, light.specular.x, light.specular.y, light.specular.z,
+                                light.ambient.x, light.ambient.y, light.ambient.z});
+    float target = brightest / LIGHT_CUTOFF_INTENSITY - light.constant;
+    float radius = 0.0f;
+    if (target > 0.0f)
+    {
+        if (light.quadratic > 0.0f)
+            radius = (-light.linear + std::sqrt(light.linear * light.linear + 4.0f * light.quadratic * target)) / (2.0f * light.quadratic);
+        else if (light.linear > 0.0f)
+            radius = target / light.linear;
+        else // the light never fades
+            radius = std::numeric_limits<float>::max();
+    }
+    lights.push_back({light.position, radius, light.ambient, light.constant, light.diffuse, light.linear, light.specular, light.quadratic});
+    return lights.size() - 1;
+}
+
+void LightManager::setLightPosition(size_t index, const glm::vec3 &position)
+{
+    lights[index].position = position;
+}
+
+const ClusteredPointLight &LightManager::getLight(size_t index) const
+{
+    return lights[index];
+}
+
+void LightManager::clearLights()
+{
+    lights.clear();
+}
+
+size_t LightManager::getLightCount() const
+{
+    return lights.size();
+}
+
+void LightManager::buildClusters(const glm::mat4 &view, const glm::mat4 &projection, float near_plane, float far_plane, float viewport_width, float viewport_height)
+{
+    auto start = std::chrono::steady_clock::now();
+    this->view = view;
+    this->projection = projection;
+    nearPlane = near_plane;
+    farPlane = far_plane;
+    // slices are spaced exponentially, so slice = log(depth / near) / log(far / near) * slice count
+    float logDepthRange = std::log(far_plane / near_plane);
+    header = {{LIGHT_CLUSTERS_X, LIGHT_CLUSTERS_Y, LIGHT_CLUSTERS_Z, 0}, LIGHT_CLUSTERS_Z / logDepthRange,
+              -(float)LIGHT_CLUSTERS_Z * std::log(near_plane) / logDepthRange, viewport_width, viewport_height};
+
+    // find the depth slices each light overlaps
+    lightBounds.resize(lights.size());
+    threadPool.parallelFor(lights.size(), 1024, [this](size_t begin, size_t end)
+                           {
+                               for (size_t i = begin; i < end; i++)
+                               {
+                                   LightBounds &bounds = lightBounds[i];
+                                   bounds.viewCentre = glm::vec3(this->view * glm::vec4(lights[i].position, 1.0f));
+                                   bounds.radius = lights[i].radius;
+                                   float depth = -bounds.viewCentre.z;
+                                   if (depth + bounds.radius < nearPlane || depth - bounds.radius > farPlane)
+                                       bounds.firstSlice = bounds.lastSlice = -1;
+                                   else
+                                   {
+                                       bounds.firstSlice = getSlice(std::max(depth - bounds.radius, nearPlane));
+                                       bounds.lastSlice = getSlice(std::min(depth + bounds.radius, farPlane));
+                                   }
+                               } });
+
+    // bin each slice on its own, then merge the slices' index lists
+    clusters.assign(LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y * LIGHT_CLUSTERS_Z, {0, 0});
+    threadPool.parallelFor(LIGHT_CLUSTERS_Z, 1, [this](size_t begin, size_t end)
+                           {
+                               for (size_t slice = begin; slice < end; slice++)
+                                   buildSlice((unsigned int)slice); });
+    std::vector<uint32_t> sliceStarts(LIGHT_CLUSTERS_Z + 1, 0);
+    for (unsigned int slice = 0; slice < LIGHT_CLUSTERS_Z; slice++)
+        sliceStarts[slice + 1] = sliceStarts[slice] + (uint32_t)sliceLightIndices[slice].size();
+    lightIndices.resize(sliceStarts.back());
+    threadPool.parallelFor(LIGHT_CLUSTERS_Z, 1, [this, &sliceStarts](size_t begin, size_t end)
+                           {
+                               for (size_t slice = begin; slice < end; slice++)
+                               {
+                                   std::copy(sliceLightIndices[slice].begin(), sliceLightIndices[slice].end(), lightIndices.begin() + sliceStarts[slice]);
+                                   LightCluster *sliceClusters = &clusters[slice * LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y];
+                                   for (unsigned int i = 0; i < LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y; i++)
+                                       sliceClusters[i].offset += sliceStarts[slice];
+                               } });
+
+    stats = LightClusterStats();
+    stats.lightCount = (unsigned int)lights.size();
+    for (const LightBounds &bounds : lightBounds)
+        if (bounds.firstSlice >= 0)
+            stats.visibleLights++;
+    stats.lightIndexCount = (unsigned int)lightIndices.size();
+    for (const LightCluster &cluster : clusters)
+    {
+        if (cluster.count > 0)
+            stats.occupiedClusters++;
+        stats.maxLightsPerCluster = std::max(stats.maxLightsPerCluster, cluster.count);
+    }
+    stats.buildMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void LightManager::upload()
+{
+    if (!lightBuffer)
+    {
+        lightBuffer = std::make_unique<SSBO>();
+        clusterBuffer = std::make_unique<SSBO>();
+        lightIndexBuffer = std::make_unique<SSBO>();
+    }
+    // empty buffers cannot be bound, so there is always at least one (unused) element
+    ClusteredPointLight noLight = ClusteredPointLight();
+    lightBuffer->assignData(lights.empty() ? &noLight : static_cast<const void *>(lights.data()), std::max<size_t>(lights.size(), 1) * sizeof(ClusteredPointLight),
+                            GL_STREAM_DRAW);
+    clusterBuffer->assignData(static_cast<const void *>(nullptr), sizeof(ClusterGridHeader) + clusters.size() * sizeof(LightCluster), GL_STREAM_DRAW);
+    clusterBuffer->assignSubData(&header, 0, sizeof(ClusterGridHeader));
+    clusterBuffer->assignSubData(clusters.data(), sizeof(ClusterGridHeader), clusters.size() * sizeof(LightCluster));
+    uint32_t noIndex = 0;
+    lightIndexBuffer->assignData(lightIndices.empty() ? &noIndex : static_cast<const void *>(lightIndices.data()),
+                                 std::max<size_t>(lightIndices.size(), 1) * sizeof(uint32_t), GL_STREAM_DRAW);
+
+    lightBuffer->bindToBindingPoint(CLUSTERED_LIGHTS_BINDING);
+    clusterBuffer->bindToBindingPoint(LIGHT_CLUSTERS_BINDING);
+    lightIndexBuffer->bindToBindingPoint(LIGHT_INDICES_BINDING);
+}
+
+LightCluster LightManager::getCluster(const glm::vec3 &position) const
+{
+    glm::vec4 viewPosition = view * glm::vec4(position, 1.0f);
+    float depth = -viewPosition.z;
+    if (depth < nearPlane || depth > farPlane || clusters.empty())
+        return {0, 0};
+    glm::vec4 clip = projection * viewPosition;
+    float ndcX = clip.x / clip.w, ndcY = clip.y / clip.w;
+    if (ndcX < -1.0f || ndcX > 1.0f || ndcY < -1.0f || ndcY > 1.0f)
+        return {0, 0};
+    unsigned int x = std::min((unsigned int)((ndcX * 0.5f + 0.5f) * LIGHT_CLUSTERS_X), LIGHT_CLUSTERS_X - 1);
+    unsigned int y = std::min((unsigned int)((ndcY * 0.5f + 0.5f) * LIGHT_CLUSTERS_Y), LIGHT_CLUSTERS_Y - 1);
+    return clusters[(getSlice(depth) * LIGHT_CLUSTERS_Y + y) * LIGHT_CLUSTERS_X + x];
+}
+
+const std::vector<uint32_t> &LightManager::getLightIndices() const
+{
+    return lightIndices;
+}
+
+LightClusterStats LightManager::getStats() const
+{
+    return stats;
+}
+
+void LightManager::buildSlice(unsigned int slice)
+{
+    float sliceNear = nearPlane * std::pow(farPlane / nearPlane, (float)slice / LIGHT_CLUSTERS_Z);
+    float sliceFar = nearPlane * std::pow(farPlane / nearPlane, (float)(slice + 1) / LIGHT_CLUSTERS_Z);
+    LightCluster *sliceClusters = &clusters[slice * LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y];
+
+    // the tiles each light covers in this slice
+    struct TileRect
+    {
+        uint32_t light;
+        unsigned int firstX, lastX, firstY, lastY;
+    };
+    std::vector<TileRect> rects;
+    for (uint32_t i = 0; i < lightBounds.size(); i++)
+    {
+        const LightBounds &bounds = lightBounds[i];
+        if (bounds.firstSlice > (int)slice || bounds.lastSlice < (int)slice)
+            continue;
+
+        // project the sphere's bounding box over the part of the slice it overlaps - each edge is widest at the near or far depth
+        float depth = -bounds.viewCentre.z;
+        float nearDepth = std::max(sliceNear, depth - bounds.radius), farDepth = std::min(sliceFar, depth + bounds.radius);
+        float left = bounds.viewCentre.x - bounds.radius, right = bounds.viewCentre.x + bounds.radius;
+        float bottom = bounds.viewCentre.y - bounds.radius, top = bounds.viewCentre.y + bounds.radius;
+        float minX = projection[0][0] * left / (left >= 0.0f ? farDepth : nearDepth), maxX = projection[0][0] * right / (right >= 0.0f ? nearDepth : farDepth);
+        float minY = projection[1][1] * bottom / (bottom >= 0.0f ? farDepth : nearDepth), maxY = projection[1][1] * top / (top >= 0.0f ? nearDepth : farDepth);
+        if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f)
+            continue;
+
+        TileRect rect;
+        rect.light = i;
+        rect.firstX = (unsigned int)((std::max(minX, -1.0f) * 0.5f + 0.5f) * LIGHT_CLUSTERS_X);
+        rect.lastX = std::min((unsigned int)((std::min(maxX, 1.0f) * 0.5f + 0.5f) * LIGHT_CLUSTERS_X), LIGHT_CLUSTERS_X - 1);
+        rect.firstY = (unsigned int)((std::max(minY, -1.0f) * 0.5f + 0.5f) * LIGHT_CLUSTERS_Y);
+        rect.lastY = std::min((unsigned int)((std::min(maxY, 1.0f) * 0.5f + 0.5f) * LIGHT_CLUSTERS_Y), LIGHT_CLUSTERS_Y - 1);
+        rects.push_back(rect);
+        for (unsigned int y = rect.firstY; y <= rect.lastY; y++)
+            for (unsigned int x = rect.firstX; x <= rect.lastX; x++)
+                sliceClusters[y * LIGHT_CLUSTERS_X + x].count++;
+    }
+
+    // give each cluster its range of the slice's list, then fill the ranges
+    std::vector<uint32_t> &indices = sliceLightIndices[slice];
+    uint32_t offset = 0;
+    for (unsigned int i = 0; i < LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y; i++)
+    {
+        sliceClusters[i].offset = offset;
+        offset += sliceClusters[i].count;
+    }
+    indices.resize(offset);
+    std::vector<uint32_t> filled(LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y, 0);
+    for (const TileRect &rect : rects)
+        for (unsigned int y = rect.firstY; y <= rect.lastY; y++)
+            for (unsigned int x = rect.firstX; x <= rect.lastX; x++)
+            {
+                unsigned int cluster = y * LIGHT_CLUSTERS_X + x;
+                indices[sliceClusters[cluster].offset + filled[cluster]++] = rect.light;
+            }
+}
+
+int LightManager::getSlice(float view_depth) const
+{
+    int slice = (int)std::floor(std::log(view_depth) * header.depthScale + header.depthBias);
+    return std::clamp(slice, 0, (int)LIGHT_CLUSTERS_Z - 1);
+}
@@ -0,0 +1,192 @@
+#include "rendering/profiler/gpu_profiler.h"
+#include "utils/logging/logging.h"
+#include <algorithm>
+
+// the path the whole frame's times are kept under
+static const std::string GPU_PROFILER_FRAME_PATH = "Frame";
+
+GPUProfiler::GPUProfiler(unsigned int frame_count)
+    : frames(std::max(frame_count, 1u)), currentFrame(0), frameCount(0), openScopes(), lastFrame(), histories(), droppedFrames(0), dump()
+{
+    for (FrameQueries &frame : frames)
+    {
+        frame.frameIndex = 0;
+        frame.pending = false;
+        frame.usedTimestamps = 0;
+        frame.endQuery = 0;
+    }
+    lastFrame.frameIndex = 0;
+    lastFrame.frameMilliseconds = 0.0f;
+}
+
+GPUProfiler::~GPUProfiler()
+{
+    for (FrameQueries &frame : frames)
+        if (!frame.timestampQuery_IDs.empty())
+            glDeleteQueries((GLsizei)frame.timestampQuery_IDs.size(), frame.timestampQuery_IDs.data());
+}
+
+bool GPUProfiler::openDump(const std::string &path)
+{
+    dump.open(path, std::ios::trunc);
+    if (!dump)
+    {
+        LOG("Failed to open GPU profile dump: " + path, Logging::LOG_TYPE::ERROR);
+        return false;
+    }
+    dump << "frame,scope,depth,gpu_ms\n";
+    LOG("Writing GPU profile to " + path, Logging::LOG_TYPE::INFO);
+    return true;
+}
+
+void GPUProfiler::beginFrame()
+{
+    FrameQueries &frame = frames[currentFrame];
+    if (frame.pending && !resolve(frame))
+        droppedFrames++;
+
+    frame.frameIndex = frameCount++;
+    frame.pending = true;
+    frame.usedTimestamps = 0;
+    frame.scopes.clear();
+    openScopes.clear();
+    writeTimestamp();
+}
+
+void GPUProfiler::endFrame()
+{
+    if (!openScopes.empty())
+    {
+        LOG("GPU profiler scope " + frames[currentFrame].scopes[openScopes.back()].path + " was not closed before the end of the frame",
+            Logging::LOG_TYPE::WARNING);
+        while (!openScopes.empty())
+            endScope();
+    }
+    frames[currentFrame].endQuery = writeTimestamp();
+    currentFrame = (currentFrame + 1) % frames.size();
+}
+
+void GPUProfiler::beginScope(const std::string &name)
+{
+    FrameQueries &frame = frames[currentFrame];
+    std::string path = openScopes.empty() ? name : frame.scopes[openScopes.back()].path + "/" + name;
+    frame.scopes.push_back({path, name, (unsigned int)openScopes.size(), writeTimestamp(), 0});
+    openScopes.push_back(frame.scopes.size() - 1);
+}
+
+void GPUProfiler::endScope()
+{
+    if (openScopes.empty())
+    {
+        LOG("GPU profiler scope closed without being opened", Logging::LOG_TYPE::WARNING);
+        return;
+    }
+    frames[currentFrame].scopes[openScopes.back()].endQuery = writeTimestamp();
+    openScopes.pop_back();
+}
+
+const GPUFrameTimings &GPUProfiler::getLastFrame() const
+{
+    return lastFrame;
+}
+
+GPUScopeStats GPUProfiler::getFrameStats() const
+{
+    return makeStats(GPU_PROFILER_FRAME_PATH, GPU_PROFILER_FRAME_PATH, 0, lastFrame.frameMilliseconds);
+}
+
+std::vector<GPUScopeStats> GPUProfiler::getScopeStats() const
+{
+    std::vector<GPUScopeStats> stats;
+    for (const GPUScopeTiming &scope : lastFrame.scopes)
+        stats.push_back(makeStats(scope.path, scope.name, scope.depth, scope.milliseconds));
+    return stats;
+}
+
+unsigned int GPUProfiler::getDroppedFrames() const
+{
+    return droppedFrames;
+}
+
+size_t GPUProfiler::writeTimestamp()
+{
+    FrameQueries &frame = frames[currentFrame];
+    if (frame.usedTimestamps == frame.timestampQuery_IDs.size())
+    {
+        GLuint query_ID;
+        glGenQueries(1, &query_ID);
+        frame.timestampQuery_IDs.push_back(query_ID);
+    }
+    glQueryCounter(frame.timestampQuery_IDs[frame.usedTimestamps], GL_TIMESTAMP);
+    return frame.usedTimestamps++;
+}
+
+bool GPUProfiler::resolve(FrameQueries &frame)
+{
+    frame.pending = false;
+    // queries complete in order, so once the end of the frame is available every query of the frame is
+    GLint available = 0;
+    glGetQueryObjectiv(frame.timestampQuery_IDs[frame.endQuery], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+        return false;
+
+    std::vector<GLuint64> timestamps(frame.usedTimestamps);
+    for (size_t i = 0; i < frame.usedTimestamps; i++)
+        glGetQueryObjectui64v(frame.timestampQuery_IDs[i], GL_QUERY_RESULT, &timestamps[i]);
+
+    lastFrame.frameIndex = frame.frameIndex;
+    lastFrame.frameMilliseconds = (timestamps[frame.endQuery] - timestamps[0]) / 1000000.0f;
+    lastFrame.scopes.clear();
+    addSample(GPU_PROFILER_FRAME_PATH, lastFrame.frameMilliseconds);
+    if (dump.is_open())
+        dump << frame.frameIndex << "," << GPU_PROFILER_FRAME_PATH << ",0," << lastFrame.frameMilliseconds << "\n";
+    for (const PendingScope &scope : frame.scopes)
+    {
+        float milliseconds = (timestamps[scope.endQuery] - timestamps[scope.beginQuery]) / 1000000.0f;
+        lastFrame.scopes.push_back({scope.path, scope.name, scope.depth, milliseconds});
+        addSample(scope.path, milliseconds);
+        if (dump.is_open())
+            dump << frame.frameIndex << "," << GPU_PROFILER_FRAME_PATH << "/" << scope.path << "," << scope.depth + 1 << "," << milliseconds << "\n";
+    }
+    return true;
+}
+
+void GPUProfiler::addSample(const std::string &path, float milliseconds)
+{
+    ScopeHistory &history = histories[path];
+    if (history.samples.size() < GPU_PROFILER_HISTORY)
+    {
+        history.samples.push_back(milliseconds);
+        history.next = 0;
+    }
+    else
+    {
+        history.samples[history.next] = milliseconds;
+        history.next = (history.next + 1) % GPU_PROFILER_HISTORY;
+    }
+}
+
+GPUScopeStats GPUProfiler::makeStats(const std::string &path, const std::string &name, unsigned int depth, float last_milliseconds) const
+{
+    GPUScopeStats stats = {path, name, depth, last_milliseconds, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    auto found = histories.find(path);
+    if (found == histories.end() || found->second.samples.empty())
+        return stats;
+
+    std::vector<float> sorted = found->second.samples;
+    std::sort(sorted.begin(), sorted.end());
+    float total = 0.0f;
+    for (float milliseconds : sorted)
+        total += milliseconds;
+    // nearest rank percentiles
+    auto percentile = [&sorted](float fraction)
+    {
+        return sorted[std::min(sorted.size() - 1, (size_t)(fraction * sorted.size()))];
+    };
+    stats.averageMilliseconds = total / sorted.size();
+    stats.medianMilliseconds = percentile(0.5f);
+    stats.p95Milliseconds = percentile(0.95f);
+    stats.p99Milliseconds = percentile(0.99f);
+    stats.maxMilliseconds = sorted.back();
+    return stats;
+}
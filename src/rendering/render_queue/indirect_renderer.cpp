@@ -0,0 +1,110 @@
+#include "rendering/render_queue/indirect_renderer.h"
+#include "rendering/capabilities/gl_capabilities.h"
+#include "rendering/buffer/ebo/ebo.h"
+#include "rendering/buffer/vbo/vbo.h"
+#include "utils/logging/logging.h"
+#include <chrono>
+
+IndirectRenderer::IndirectRenderer()
+    : sharedVAO(), sharedVertices(), sharedIndices(), meshRanges(), geometryDirty(false), commands(), drawData(), groups(),
+      indirectBuffer(GL_DRAW_INDIRECT_BUFFER), drawDataBuffer(), stats()
+{
+}
+
+bool IndirectRenderer::isSupported()
+{
+    // the indirect shaders are GLSL 4.30 (for the std430 draw data block), so the extensions alone are not enough on an older context
+    // gl_DrawIDARB (core as gl_DrawID in 4.6)
+    return GLCapabilities::isVersionAtLeast(4, 3) && GLCapabilities::hasExtension("GL_ARB_shader_draw_parameters");
+}
+
+void IndirectRenderer::addMesh(const Mesh &mesh)
+{
+    getRange(mesh);
+}
+
+void IndirectRenderer::execute(const RenderQueue &render_queue)
+{
+    auto start = std::chrono::steady_clock::now();
+    stats = IndirectRendererStats();
+    commands.clear();
+    drawData.clear();
+    groups.clear();
+
+    // the queue is sorted by shader then material, so each group is one run of commands
+    for (const RenderCommand &command : render_queue.getCommands())
+    {
+        const SharedMeshRange &range = getRange(*command.mesh);
+        if (groups.empty() || groups.back().shader != command.shader || groups.back().mesh->getMaterialKey() != command.mesh->getMaterialKey())
+            groups.push_back({command.shader, command.mesh, commands.size(), 0});
+        groups.back().commandCount++;
+
+        commands.push_back({range.indexCount, 1, range.firstIndex, range.baseVertex, 0});
+        drawData.push_back(render_queue.getObjectData()[command.objectIndex]);
+    }
+    if (commands.empty())
+        return;
+
+    if (geometryDirty)
+        uploadGeometry();
+    // orphan last frame's buffers rather than waiting for the GPU to finish reading them
+    indirectBuffer.assignData(commands.data(), commands.size() * sizeof(DrawElementsIndirectCommand), GL_STREAM_DRAW);
+    drawDataBuffer.assignData(drawData.data(), drawData.size() * sizeof(PerObjectBlock), GL_STREAM_DRAW);
+
+    sharedVAO->bind();
+    indirectBuffer.bind();
+    drawDataBuffer.bindToBindingPoint(INDIRECT_PER_DRAW_BINDING);
+    Shader *currentShader = nullptr;
+    for (const DrawGroup &group : groups)
+    {
+        if (group.shader != currentShader)
+        {
+            group.shader->use();
+            currentShader = group.shader;
+        }
+        group.mesh->setMaterialUniforms(*group.shader);
+        group.mesh->bindTextures();
+        // gl_DrawIDARB restarts at 0 for each call, so the shader is told where this group's draws start
+        group.shader->setUniform("drawOffset", (int)group.firstCommand);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<const void *>(group.firstCommand * sizeof(DrawElementsIndirectCommand)),
+                                    (GLsizei)group.commandCount, 0);
+        stats.multiDrawCalls++;
+    }
+    stats.draws = (unsigned int)commands.size();
+    stats.submitMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+IndirectRendererStats IndirectRenderer::getStats() const
+{
+    return stats;
+}
+
+const SharedMeshRange &IndirectRenderer::getRange(const Mesh &mesh)
+{
+    auto found = meshRanges.find(&mesh);
+    if (found != meshRanges.end())
+        return found->second;
+
+    SharedMeshRange range = {(GLuint)sharedIndices.size(), (GLuint)mesh.getIndices().size(), (GLint)sharedVertices.size()};
+    sharedVertices.insert(sharedVertices.end(), mesh.getVertices().begin(), mesh.getVertices().end());
+    sharedIndices.insert(sharedIndices.end(), mesh.getIndices().begin(), mesh.getIndices().end());
+    geometryDirty = true;
+    return meshRanges.emplace(&mesh, range).first->second;
+}
+
+void IndirectRenderer::uploadGeometry()
+{
+    VBO vbo = VBO(GL_ARRAY_BUFFER);
+    vbo.assignData(sharedVertices.data(), sharedVertices.size() * sizeof(Vertex), GL_STATIC_DRAW);
+    EBO ebo = EBO();
+    ebo.assignData(sharedIndices.data(), sharedIndices.size() * sizeof(unsigned int), GL_STATIC_DRAW);
+
+    // the shared buffers use the same layout as every mesh's own buffers
+    static const VertexBufferLayout layout = VertexBufferLayout(Vertex::describe());
+    sharedVAO = std::make_unique<VAO>();
+    sharedVAO->addBuffer(std::move(vbo), layout);
+    sharedVAO->addBuffer(std::move(ebo));
+    geometryDirty = false;
+    LOG("Uploaded " + std::to_string(meshRanges.size()) + " meshes (" + std::to_string(sharedVertices.size()) + " vertices) to the shared indirect buffers",
+        Logging::LOG_TYPE::INFO);
+}
@@ -0,0 +1,233 @@
+#include "rendering/render_queue/render_queue.h"
+#include "rendering/texture/texture_manager.h"
+#include "rendering/capabilities/gl_capabilities.h"
+#include <algorithm>
+#include <cstring>
+
+// the shift of the material id in a sort key
+static const unsigned int SORT_KEY_MATERIAL_SHIFT = SORT_KEY_VAO_BITS + SORT_KEY_DEPTH_BITS;
+
+/// @brief build the sort key of a draw
+/// @param pass the pass of the draw
+/// @param shader the shader of the draw
+/// @param mesh the mesh of the draw
+/// @param material_id the small id of the mesh's material
+/// @param view_depth the view depth of the draw
+/// @param max_depth the furthest view depth
+/// @return the key
+static uint64_t makeSortKey(RENDER_PASS pass, const Shader &shader, const Mesh &mesh, uint32_t material_id, float view_depth, float max_depth)
+{
+    const uint64_t depthMax = (1ull << SORT_KEY_DEPTH_BITS) - 1;
+    uint64_t depth = (uint64_t)(std::clamp(view_depth / max_depth, 0.0f, 1.0f) * depthMax);
+    if (pass == RENDER_PASS::TRANSPARENT)
+        depth = depthMax - depth; // back to front so blending composites correctly
+
+    uint64_t key = (uint64_t)pass & ((1ull << SORT_KEY_PASS_BITS) - 1);
+    key = (key << SORT_KEY_SHADER_BITS) | (shader.program_ID & ((1ull << SORT_KEY_SHADER_BITS) - 1));
+    key = (key << SORT_KEY_MATERIAL_BITS) | (material_id & ((1ull << SORT_KEY_MATERIAL_BITS) - 1));
+    key = (key << SORT_KEY_VAO_BITS) | (mesh.getVAO().getID() & ((1ull << SORT_KEY_VAO_BITS) - 1));
+    key = (key << SORT_KEY_DEPTH_BITS) | depth;
+    return key;
+}
+
+/// @brief pack the per object uniform data of a draw
+/// @param model the model matrix of the draw
+/// @return the data
+static PerObjectBlock packObjectData(const glm::mat4 &model)
+{
+    PerObjectBlock data;
+    data.model = model;
+    data.normalModel = glm::inverse(glm::transpose(glm::mat3(model)));
+    return data;
+}
+
+RenderCommandBuffer::RenderCommandBuffer(float max_depth)
+    : maxDepth(max_depth), commands(), objectData()
+{
+}
+
+void RenderCommandBuffer::submit(Mesh &mesh, Shader &shader, const glm::mat4 &model, RENDER_PASS pass, float view_depth)
+{
+    commands.push_back({makeSortKey(pass, shader, mesh, 0, view_depth, maxDepth), &mesh, &shader, (uint32_t)objectData.size()});
+    objectData.push_back(packObjectData(model));
+}
+
+void RenderCommandBuffer::clear()
+{
+    commands.clear();
+    objectData.clear();
+}
+
+size_t RenderCommandBuffer::getCommandCount() const
+{
+    return commands.size();
+}
+
+RenderQueue::RenderQueue(float max_depth)
+    : maxDepth(max_depth), commands(), objectData(), commandBuffers(), sortBuffer(), materialIDs(), stats()
+{
+}
+
+void RenderQueue::submit(Mesh &mesh, Shader &shader, const glm::mat4 &model, RENDER_PASS pass, float view_depth)
+{
+    commands.push_back({makeSortKey(pass, shader, mesh, getMaterialID(mesh.getMaterialKey()), view_depth, maxDepth), &mesh, &shader,
+                        (uint32_t)objectData.size()});
+    objectData.push_back(packObjectData(model));
+}
+
+std::vector<RenderCommandBuffer> &RenderQueue::getCommandBuffers(size_t count)
+{
+    commandBuffers.resize(count, RenderCommandBuffer(maxDepth));
+    for (RenderCommandBuffer &buffer : commandBuffers)
+        buffer.clear();
+    return commandBuffers;
+}
+
+void RenderQueue::mergeCommandBuffers()
+{
+    for (RenderCommandBuffer &buffer : commandBuffers)
+    {
+        // material ids are only given out here, on one thread, so they stay stable and the map needs no lock
+        uint32_t firstObject = (uint32_t)objectData.size();
+        for (RenderCommand command : buffer.commands)
+        {
+            uint64_t materialID = getMaterialID(command.mesh->getMaterialKey()) & ((1ull << SORT_KEY_MATERIAL_BITS) - 1);
+            command.sortKey |= materialID << SORT_KEY_MATERIAL_SHIFT;
+            command.objectIndex += firstObject;
+            commands.push_back(command);
+        }
+        objectData.insert(objectData.end(), buffer.objectData.begin(), buffer.objectData.end());
+        buffer.clear();
+    }
+}
+
+void RenderQueue::sort()
+{
+    // least significant digit radix sort, one byte at a time - stable, so equal keys keep their submission order
+    sortBuffer.resize(commands.size());
+    for (unsigned int shift = 0; shift < 64; shift += 8)
+    {
+        size_t counts[256] = {};
+        for (const RenderCommand &command : commands)
+            counts[(command.sortKey >> shift) & 0xFF]++;
+        // every key has the same byte here, so this pass would not change the order
+        if (counts[(commands.empty() ? 0 : commands[0].sortKey >> shift) & 0xFF] == commands.size())
+            continue;
+
+        size_t offset = 0;
+        for (size_t &count : counts)
+        {
+            size_t bucketSize = count;
+            count = offset;
+            offset += bucketSize;
+        }
+        for (const RenderCommand &command : commands)
+            sortBuffer[counts[(command.sortKey >> shift) & 0xFF]++] = command;
+        commands.swap(sortBuffer);
+    }
+}
+
+void RenderQueue::execute(UniformBlock<PerObjectBlock> &per_object_block, DynamicBuffer *per_object_ring)
+{
+    GLsizeiptr uniformAlignment = per_object_ring ? GLCapabilities::getUniformBufferOffsetAlignment() : 0;
+    stats = RenderQueueStats();
+    Shader *currentShader = nullptr;
+    const VAO *currentVAO = nullptr;
+    uint64_t currentMaterial = 0;
+    std::unordered_map<GLenum, const Texture *> boundTextures; // the texture bound to each unit by this queue
+
+    for (const RenderCommand &command : commands)
+    {
+        bool shaderChanged = command.shader != currentShader;
+        if (shaderChanged)
+        {
+            command.shader->use();
+            currentShader = command.shader;
+            stats.programSwitches++;
+        }
+
+        const VAO &vao = command.mesh->getVAO();
+        if (&vao != currentVAO)
+        {
+            vao.bind();
+            currentVAO = &vao;
+            stats.vaoSwitches++;
+        }
+
+        // material uniforms live in the program, so they must be set again after a program switch
+        if (shaderChanged || command.mesh->getMaterialKey() != currentMaterial)
+        {
+            command.mesh->setMaterialUniforms(*command.shader);
+            currentMaterial = command.mesh->getMaterialKey();
+            stats.materialSwitches++;
+
+            for (const TextureInfo &textureInfo : command.mesh->getTextures())
+            {
+                std::shared_ptr<Texture> texture = textureInfo.texture.lock();
+                if (!texture)
+                    continue;
+                const Texture *&bound = boundTextures[texture->getTextureUnit()];
+                if (bound == texture.get() && texture->isResident())
+                    continue;
+                TextureManager::bindTexture(*texture); // reloads the texture if it has been evicted
+                bound = texture.get();
+                stats.textureSwitches++;
+            }
+        }
+
+        // write each draw's block to its own range of the ring rather than re-uploading the same UBO between draws
+        const PerObjectBlock &data = objectData[command.objectIndex];
+        DynamicAllocation allocation = per_object_ring ? per_object_ring->write(&data, sizeof(PerObjectBlock), uniformAlignment)
+                                                       : DynamicAllocation{nullptr, 0, 0};
+        if (allocation.data)
+            per_object_ring->bindRange(allocation, static_cast<GLuint>(UniformBlockBinding::PER_OBJECT));
+        else
+        {
+            if (per_object_ring) // the ring is full this frame
+                per_object_block.bind();
+            per_object_block.data = data;
+            per_object_block.upload();
+        }
+
+        command.mesh->drawElements();
+        stats.draws++;
+    }
+    if (per_object_ring)
+        per_object_block.bind(); // leave the whole block bound for anything drawn outside the queue
+}
+
+void RenderQueue::clear()
+{
+    commands.clear();
+    objectData.clear();
+}
+
+RenderQueueStats RenderQueue::getStats() const
+{
+    return stats;
+}
+
+size_t RenderQueue::getCommandCount() const
+{
+    return commands.size();
+}
+
+const std::vector<RenderCommand> &RenderQueue::getCommands() const
+{
+    return commands;
+}
+
+const std::vector<PerObjectBlock> &RenderQueue::getObjectData() const
+{
+    return objectData;
+}
+
+uint32_t RenderQueue::getMaterialID(uint64_t material_key)
+{
+    auto search = materialIDs.find(material_key);
+    if (search != materialIDs.end())
+        return search->second;
+    uint32_t id = (uint32_t)materialIDs.size();
+    materialIDs.emplace(material_key, id);
+    return id;
+}
@@ -0,0 +1,158 @@
+#include "rendering/sampler/sampler.h"
+#include "rendering/capabilities/gl_capabilities.h"
+#include "rendering/state_cache/gl_state_cache.h"
+#include "utils/hashing/hashing.h"
+#include "utils/logging/logging.h"
+#include <algorithm>
+
+// anisotropic filtering is core in OpenGL 4.6 but this may be missing from older loaders
+#ifndef GL_TEXTURE_MAX_ANISOTROPY
+#define GL_TEXTURE_MAX_ANISOTROPY 0x84FE
+#endif
+
+Sampler::Sampler(const std::vector<TextureParam> &params)
+    : sampler_ID(0), params(params)
+{
+    glGenSamplers(1, &sampler_ID);
+    LOG("Initialised new Sampler: " + std::to_string(sampler_ID), Logging::LOG_TYPE::INFO);
+}
+
+Sampler::Sampler(Sampler &&other)
+    : sampler_ID(other.sampler_ID), params(std::move(other.params))
+{
+    other.sampler_ID = 0;
+}
+
+Sampler &Sampler::operator=(Sampler &&other) noexcept
+{
+    if (this != &other)
+    {
+        // delete the current sampler as we are being assigned a new one
+        GLStateCache::forgetSampler(sampler_ID);
+        glDeleteSamplers(1, &sampler_ID);
+        this->sampler_ID = other.sampler_ID;
+        this->params = std::move(other.params);
+        other.sampler_ID = 0;
+    }
+    return *this;
+}
+
+Sampler::~Sampler()
+{
+    GLStateCache::forgetSampler(sampler_ID);
+    glDeleteSamplers(1, &sampler_ID);
+}
+
+void Sampler::bind(unsigned int texture_unit) const
+{
+    GLStateCache::bindSampler(texture_unit, sampler_ID);
+}
+
+void Sampler::applyParams(float anisotropy, bool trilinear)
+{
+    for (const auto &param : params)
+    {
+        GLenum value = param.value;
+        // when trilinear filtering is disabled, only sample the nearest mip level
+        if (!trilinear && param.paramName == GL_TEXTURE_MIN_FILTER)
+        {
+            if (value == GL_LINEAR_MIPMAP_LINEAR)
+                value = GL_LINEAR_MIPMAP_NEAREST;
+            else if (value == GL_NEAREST_MIPMAP_LINEAR)
+                value = GL_NEAREST_MIPMAP_NEAREST;
+        }
+        glSamplerParameteri(sampler_ID, param.paramName, value);
+    }
+    if (GLCapabilities::getMaxAnisotropy() > 1.0f)
+        glSamplerParameterf(sampler_ID, GL_TEXTURE_MAX_ANISOTROPY, anisotropy);
+}
+
+const std::vector<TextureParam> &Sampler::getParams() const
+{
+    return params;
+}
+
+unsigned int Sampler::getID() const
+{
+    return sampler_ID;
+}
+
+std::shared_ptr<Sampler> SamplerCache::getSampler(const std::vector<TextureParam> &params)
+{
+    SamplerCache &instance = getInstance();
+    std::vector<std::shared_ptr<Sampler>> &samplers = instance.paramsToSampler[hashParams(params)];
+
+    // check the samplers with this hash actually have the same params (in any order)
+    for (const auto &sampler : samplers)
+    {
+        const std::vector<TextureParam> &existing = sampler->getParams();
+        bool matches = existing.size() == params.size() &&
+                       std::all_of(params.begin(), params.end(), [&existing](const TextureParam &param)
+                                   { return std::any_of(existing.begin(), existing.end(), [&param](const TextureParam &other)
+                                                        { return other.paramName == param.paramName && other.value == param.value; }); });
+        if (matches)
+            return sampler;
+    }
+
+    auto sampler = std::make_shared<Sampler>(params);
+    sampler->applyParams(instance.anisotropy, instance.trilinear);
+    samplers.push_back(sampler);
+    return sampler;
+}
+
+void SamplerCache::setAnisotropy(float anisotropy)
+{
+    SamplerCache &instance = getInstance();
+    instance.anisotropy = std::clamp(anisotropy, 1.0f, GLCapabilities::getMaxAnisotropy());
+    for (auto &pair : instance.paramsToSampler)
+        for (auto &sampler : pair.second)
+            sampler->applyParams(instance.anisotropy, instance.trilinear);
+}
+
+float SamplerCache::getAnisotropy()
+{
+    return getInstance().anisotropy;
+}
+
+void SamplerCache::setTrilinearFiltering(bool trilinear)
+{
+    SamplerCache &instance = getInstance();
+    instance.trilinear = trilinear;
+    for (auto &pair : instance.paramsToSampler)
+        for (auto &sampler : pair.second)
+            sampler->applyParams(instance.anisotropy, instance.trilinear);
+}
+
+bool SamplerCache::getTrilinearFiltering()
+{
+    return getInstance().trilinear;
+}
+
+size_t SamplerCache::getSamplerCount()
+{
+    size_t count = 0;
+    for (const auto &pair : getInstance().paramsToSampler)
+        count += pair.second.size();
+    return count;
+}
+
+SamplerCache &SamplerCache::getInstance()
+{
+    static SamplerCache instance;
+    return instance;
+}
+
+SamplerCache::SamplerCache()
+    : paramsToSampler(), anisotropy(1.0f), trilinear(true)
+{
+}
+
+uint64_t SamplerCache::hashParams(const std::vector<TextureParam> &params)
+{
+    // sort the params so the same set in a different order gives the same hash
+    std::vector<std::pair<GLenum, GLenum>> sorted;
+    for (const auto &param : params)
+        sorted.emplace_back(param.paramName, param.value);
+    std::sort(sorted.begin(), sorted.end());
+    return Hashing::hash64(sorted.data(), sorted.size() * sizeof(std::pair<GLenum, GLenum>));
+}
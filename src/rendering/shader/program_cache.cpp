@@ -0,0 +1,166 @@
+#include "rendering/shader/program_cache.h"
+#include "rendering/capabilities/gl_capabilities.h"
+#include "utils/hashing/hashing.h"
+#include "utils/logging/logging.h"
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <cstdio>
+
+namespace
+{
+    /// @brief identifies a program binary file written by this cache
+    const uint32_t PROGRAM_BINARY_MAGIC = 0x43425057; // "WPBC"
+
+    /// @brief the header written before the program binary
+    struct ProgramBinaryHeader
+    {
+        uint32_t magic;
+        uint32_t format;
+        uint64_t key;
+        uint64_t length;
+    };
+}
+
+bool ProgramCache::isSupported()
+{
+    return getInstance().supported;
+}
+
+uint64_t ProgramCache::makeKey(const std::string &vertex_source, const std::string &fragment_source, const std::string &defines)
+{
+    uint64_t key = getInstance().driverHash;
+    key = Hashing::combine(key, Hashing::hash64(vertex_source));
+    key = Hashing::combine(key, Hashing::hash64(fragment_source));
+    key = Hashing::combine(key, Hashing::hash64(defines));
+    return key;
+}
+
+unsigned int ProgramCache::loadProgram(uint64_t key)
+{
+    ProgramCache &instance = getInstance();
+    if (!instance.supported)
+        return 0;
+
+    std::string path = getBinaryPath(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return 0; // never cached
+
+    ProgramBinaryHeader header;
+    std::vector<char> binary;
+    if (file.read(reinterpret_cast<char *>(&header), sizeof(header)) && header.magic == PROGRAM_BINARY_MAGIC && header.key == key)
+    {
+        binary.resize(header.length);
+        file.read(binary.data(), binary.size());
+    }
+    file.close();
+    if (binary.empty() || !file)
+    {
+        LOG("Ignoring corrupt program binary: " + path, Logging::LOG_TYPE::WARNING);
+        std::remove(path.c_str());
+        return 0;
+    }
+
+    unsigned int program_id = glCreateProgram();
+    glProgramBinary(program_id, header.format, binary.data(), (GLsizei)binary.size());
+    int success;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        // the driver may reject binaries from an older build of itself - fall back to compiling
+        LOG("Driver rejected program binary: " + path + ", recompiling", Logging::LOG_TYPE::WARNING);
+        glDeleteProgram(program_id);
+        std::remove(path.c_str());
+        instance.stats.binariesRejected++;
+        return 0;
+    }
+    return program_id;
+}
+
+void ProgramCache::storeProgram(uint64_t key, unsigned int program_id)
+{
+    ProgramCache &instance = getInstance();
+    if (!instance.supported)
+        return;
+
+    int success;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &success);
+    if (!success)
+        return; // never cache a broken program
+
+    GLint length = 0;
+    glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program_id, length, &length, &format, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(instance.cacheDirectory, error);
+    std::string path = getBinaryPath(key);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    ProgramBinaryHeader header = {PROGRAM_BINARY_MAGIC, format, key, (uint64_t)length};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(binary.data(), length);
+    if (!file)
+        LOG("Failed to write program binary: " + path, Logging::LOG_TYPE::WARNING);
+}
+
+void ProgramCache::recordCompile(double milliseconds)
+{
+    getInstance().stats.programsCompiled++;
+    getInstance().stats.compileMilliseconds += milliseconds;
+}
+
+void ProgramCache::recordCacheHit(double milliseconds)
+{
+    getInstance().stats.programsLoadedFromCache++;
+    getInstance().stats.cacheLoadMilliseconds += milliseconds;
+}
+
+void ProgramCache::setCacheDirectory(const std::string &directory)
+{
+    getInstance().cacheDirectory = directory;
+}
+
+ShaderStartupStats ProgramCache::getStartupStats()
+{
+    return getInstance().stats;
+}
+
+ProgramCache &ProgramCache::getInstance()
+{
+    static ProgramCache instance;
+    return instance;
+}
+
+std::string ProgramCache::getBinaryPath(uint64_t key)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return getInstance().cacheDirectory + "/" + name;
+}
+
+ProgramCache::ProgramCache()
+    : driverHash(0), supported(false), cacheDirectory(DEFAULT_PROGRAM_CACHE_DIRECTORY), stats()
+{
+    // binaries are only valid for the driver that produced them
+    const GLenum driverStrings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+    for (GLenum name : driverStrings)
+    {
+        const char *value = reinterpret_cast<const char *>(glGetString(name));
+        driverHash = Hashing::combine(driverHash, Hashing::hash64(std::string(value ? value : "")));
+    }
+
+    if (GLCapabilities::isVersionAtLeast(4, 1) || GLCapabilities::hasExtension("GL_ARB_get_program_binary"))
+    {
+        int formatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        supported = formatCount > 0;
+    }
+    if (!supported)
+        LOG("Program binaries are not supported, shaders will be compiled on every launch", Logging::LOG_TYPE::INFO);
+}
@@ -1,34 +1,90 @@
 #include "rendering/shader/shader.h"
 #include <glm/gtc/type_ptr.hpp>
 #include "utils/logging/logging.h"
+#include "rendering/uniform_blocks/uniform_blocks.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include "rendering/shader/program_cache.h"
+#include "rendering/shader/shader_source_cache.h"
+#include "rendering/capabilities/gl_capabilities.h"
+#include "rendering/state_cache/gl_state_cache.h"
+#include <initializer_list>
+
+// parallel shader compilation is an extension (KHR_parallel_shader_compile) that may be missing from older loaders
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+unsigned int Shader::nextRevision = 1;
+
+UniformUploadStats Shader::uploadStats = UniformUploadStats();
 
 Shader::Shader(const char *vertex_shader_path, const char *fragment_shader_path)
+    : Shader(vertex_shader_path, fragment_shader_path, ShaderPermutation())
 {
-    // load shader code
-    std::string vertexShaderCode = loadShaderFile(vertex_shader_path);
-    const char *vertexShaderCode_cstr = vertexShaderCode.c_str();
+}
 
-    std::string fragmentShaderCode = loadShaderFile(fragment_shader_path);
-    const char *fragmentShaderCode_cstr = fragmentShaderCode.c_str();
+Shader::Shader(const char *vertex_shader_path, const char *fragment_shader_path, const ShaderPermutation &permutation)
+    : Shader(vertex_shader_path, fragment_shader_path, permutation, SHADER_BUILD::IMMEDIATE)
+{
+}
 
-    // compile shaders
-    unsigned int vertexShader_id = Shader::compileShader(vertexShaderCode_cstr, GL_VERTEX_SHADER);
-    unsigned int fragmentShader_id = Shader::compileShader(fragmentShaderCode_cstr, GL_FRAGMENT_SHADER);
+Shader::Shader(const char *vertex_shader_path, const char *fragment_shader_path, const ShaderPermutation &permutation, SHADER_BUILD build)
+    : revision(nextRevision++), buildPending(false), pendingVertexShader_ID(0), pendingFragmentShader_ID(0), cacheKey(0), buildMilliseconds(0.0),
+      attributes(), validatedDescription(nullptr), validatedResult(false)
+{
+    auto start = std::chrono::steady_clock::now();
 
-    // create shader program
-    program_ID = Shader::buildShaderProgram(vertexShader_id, fragmentShader_id);
+    // load shader code and select this variant
+    std::string defineBlock = permutation.getDefineBlock();
+    std::string vertexShaderCode = injectDefines(loadShaderFile(vertex_shader_path), defineBlock);
+    std::string fragmentShaderCode = injectDefines(loadShaderFile(fragment_shader_path), defineBlock);
 
-    // delete the independent shaders (they are now integrated)
-    glDeleteShader(vertexShader_id);
-    glDeleteShader(fragmentShader_id);
+    // try the program binary cache before compiling from source
+    cacheKey = ProgramCache::makeKey(vertexShaderCode, fragmentShaderCode, defineBlock);
+    program_ID = ProgramCache::loadProgram(cacheKey);
+    if (program_ID != 0)
+    {
+        ProgramCache::recordCacheHit(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        introspectUniforms();
+        introspectAttributes();
+        bindUniformBlocks();
+        return;
+    }
+
+    // submit the compile and link without asking for their status, so the driver is free to build them in the background
+    hasParallelCompile();
+    pendingVertexShader_ID = Shader::compileShader(vertexShaderCode.c_str(), GL_VERTEX_SHADER);
+    pendingFragmentShader_ID = Shader::compileShader(fragmentShaderCode.c_str(), GL_FRAGMENT_SHADER);
+    program_ID = Shader::buildShaderProgram(pendingVertexShader_ID, pendingFragmentShader_ID);
+    buildPending = true;
+    buildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (build == SHADER_BUILD::IMMEDIATE)
+        finishBuild();
 }
 
 Shader::Shader(Shader &&other)
 {
     // obtain ownership of shader program
     this->program_ID = other.program_ID;
+    this->revision = other.revision;
+    this->uniformLocations = std::move(other.uniformLocations);
+    this->uniformShadows = std::move(other.uniformShadows);
+    this->buildPending = other.buildPending;
+    this->pendingVertexShader_ID = other.pendingVertexShader_ID;
+    this->pendingFragmentShader_ID = other.pendingFragmentShader_ID;
+    this->cacheKey = other.cacheKey;
+    this->buildMilliseconds = other.buildMilliseconds;
+    this->attributes = std::move(other.attributes);
+    this->validatedDescription = other.validatedDescription;
+    this->validatedResult = other.validatedResult;
     // remove ownership of shader program from other
     other.program_ID = 0;
+    other.buildPending = false;
+    other.pendingVertexShader_ID = 0;
+    other.pendingFragmentShader_ID = 0;
 }
 
 Shader &Shader::operator=(Shader &&other) noexcept
@@ -36,79 +92,396 @@ Shader &Shader::operator=(Shader &&other) noexcept
     if (this != &other)
     {
         // delete the current shader program (as we are being assigned to a new one and therefore the current must be binned)
+        glDeleteShader(pendingVertexShader_ID);
+        glDeleteShader(pendingFragmentShader_ID);
+        GLStateCache::forgetProgram(program_ID);
         glDeleteProgram(program_ID);
         // obtain ownership of shader program
         this->program_ID = other.program_ID;
+        this->revision = other.revision;
+        this->uniformLocations = std::move(other.uniformLocations);
+        this->uniformShadows = std::move(other.uniformShadows);
+        this->buildPending = other.buildPending;
+        this->pendingVertexShader_ID = other.pendingVertexShader_ID;
+        this->pendingFragmentShader_ID = other.pendingFragmentShader_ID;
+        this->cacheKey = other.cacheKey;
+        this->buildMilliseconds = other.buildMilliseconds;
+        this->attributes = std::move(other.attributes);
+        this->validatedDescription = other.validatedDescription;
+        this->validatedResult = other.validatedResult;
         // remove ownership of shader program from other
         other.program_ID = 0;
+        other.buildPending = false;
+        other.pendingVertexShader_ID = 0;
+        other.pendingFragmentShader_ID = 0;
     }
     return *this;
 }
 
 Shader::~Shader()
 {
+    glDeleteShader(pendingVertexShader_ID);
+    glDeleteShader(pendingFragmentShader_ID);
+    GLStateCache::forgetProgram(program_ID);
     glDeleteProgram(program_ID);
 }
 
 void Shader::use()
 {
-    glUseProgram(program_ID);
+    if (buildPending)
+        finishBuild();
+    GLStateCache::useProgram(program_ID);
+}
+
+bool Shader::isLinked() const
+{
+    if (buildPending)
+        return false;
+    int success;
+    glGetProgramiv(program_ID, GL_LINK_STATUS, &success);
+    return success;
+}
+
+bool Shader::isBuildComplete() const
+{
+    if (!buildPending)
+        return true;
+    if (!hasParallelCompile())
+        return true; // we can't ask without blocking, so finishing the build is as good as it gets
+    GLint complete = GL_FALSE;
+    glGetProgramiv(program_ID, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete == GL_TRUE;
+}
+
+void Shader::finishBuild()
+{
+    if (!buildPending)
+        return;
+    auto start = std::chrono::steady_clock::now();
+
+    // this is the first status query, so it waits for the driver to finish
+    bool success = checkBuildStatus(program_ID, pendingVertexShader_ID, pendingFragmentShader_ID);
+
+    // delete the independent shaders (they are now integrated)
+    glDeleteShader(pendingVertexShader_ID);
+    glDeleteShader(pendingFragmentShader_ID);
+    pendingVertexShader_ID = 0;
+    pendingFragmentShader_ID = 0;
+    buildPending = false;
+
+    if (success)
+    {
+        ProgramCache::storeProgram(cacheKey, program_ID);
+        // cache the location of every uniform so we never need to query OpenGL for them again
+        introspectUniforms();
+        // read the vertex attributes so vertex layouts can be validated against them
+        introspectAttributes();
+        // point the uniform blocks at the engine's fixed binding points
+        bindUniformBlocks();
+    }
+
+    // only count the time spent submitting and waiting, not the time the build ran in the background
+    buildMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    ProgramCache::recordCompile(buildMilliseconds);
 }
 
 void Shader::setUniform(const std::string &uniform_name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(program_ID, uniform_name.c_str()), (int)value);
+    setUniform(UniformHandle{getUniformLocation(uniform_name)}, value);
 }
 
 void Shader::setUniform(const std::string &uniform_name, int value) const
 {
-    glUniform1i(glGetUniformLocation(program_ID, uniform_name.c_str()), value);
+    setUniform(UniformHandle{getUniformLocation(uniform_name)}, value);
 }
 
 void Shader::setUniform(const std::string &uniform_name, float value) const
 {
-    glUniform1f(glGetUniformLocation(program_ID, uniform_name.c_str()), value);
+    setUniform(UniformHandle{getUniformLocation(uniform_name)}, value);
 }
 
 void Shader::setUniform(const std::string &uniform_name, unsigned int count, bool transpose, const glm::mat4 value) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(program_ID, uniform_name.c_str()), count, transpose, glm::value_ptr(value));
+    setUniform(UniformHandle{getUniformLocation(uniform_name)}, count, transpose, value);
 }
 
 void Shader::setUniform(const std::string &uniform_name, unsigned int count, bool transpose, const glm::mat3 value) const
 {
-    glUniformMatrix3fv(glGetUniformLocation(program_ID, uniform_name.c_str()), count, transpose, glm::value_ptr(value));
+    setUniform(UniformHandle{getUniformLocation(uniform_name)}, count, transpose, value);
 }
 
 void Shader::setUniform(const std::string &uniform_name, const glm::vec3 value) const
 {
-    glUniform3f(glGetUniformLocation(program_ID, uniform_name.c_str()), value.x, value.y, value.z);
+    setUniform(UniformHandle{getUniformLocation(uniform_name)}, value);
 }
 
-std::string Shader::loadShaderFile(const char *shader_path)
+unsigned int Shader::getRevision() const
 {
-    std::string shaderCode;
-    std::ifstream shaderFile;
-    // ensure that if the fail/bad bits are set, we throw an exception of type ifstream::failure
-    shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    // read from the file
-    try
+    return revision;
+}
+
+UniformHandle Shader::getUniformHandle(const std::string &uniform_name) const
+{
+    UniformHandle handle;
+    handle.location = getUniformLocation(uniform_name);
+    return handle;
+}
+
+void Shader::setUniform(UniformHandle handle, bool value) const
+{
+    setUniform(handle, (int)value);
+}
+
+void Shader::setUniform(UniformHandle handle, int value) const
+{
+    if (updateShadow(handle.location, &value, sizeof(value)))
+        glUniform1i(handle.location, value);
+}
+
+void Shader::setUniform(UniformHandle handle, float value) const
+{
+    if (updateShadow(handle.location, &value, sizeof(value)))
+        glUniform1f(handle.location, value);
+}
+
+void Shader::setUniform(UniformHandle handle, unsigned int count, bool transpose, const glm::mat4 &value) const
+{
+    // the shadow only holds one matrix, so transposed uploads and arrays always go through
+    if (count != 1 || transpose)
     {
-        // open files
-        shaderFile.open(shader_path);
-        std::stringstream shaderStream;
-        // read file's buffer contents into streams
-        shaderStream << shaderFile.rdbuf();
-        // close file handlers
-        shaderFile.close();
-        // convert string stream into a string
-        shaderCode = shaderStream.str();
+        forgetShadow(handle.location);
+        glUniformMatrix4fv(handle.location, count, transpose, glm::value_ptr(value));
     }
-    catch (std::ifstream::failure e)
+    else if (updateShadow(handle.location, glm::value_ptr(value), sizeof(value)))
+        glUniformMatrix4fv(handle.location, count, transpose, glm::value_ptr(value));
+}
+
+void Shader::setUniform(UniformHandle handle, unsigned int count, bool transpose, const glm::mat3 &value) const
+{
+    // the shadow only holds one matrix, so transposed uploads and arrays always go through
+    if (count != 1 || transpose)
     {
-        LOG(std::string("Failed to read shader file: ") + shader_path, Logging::LOG_TYPE::ERROR);
+        forgetShadow(handle.location);
+        glUniformMatrix3fv(handle.location, count, transpose, glm::value_ptr(value));
     }
-    return shaderCode;
+    else if (updateShadow(handle.location, glm::value_ptr(value), sizeof(value)))
+        glUniformMatrix3fv(handle.location, count, transpose, glm::value_ptr(value));
+}
+
+void Shader::setUniform(UniformHandle handle, const glm::vec3 &value) const
+{
+    if (updateShadow(handle.location, glm::value_ptr(value), sizeof(value)))
+        glUniform3f(handle.location, value.x, value.y, value.z);
+}
+
+UniformUploadStats Shader::getUploadStats()
+{
+    return uploadStats;
+}
+
+void Shader::resetUploadStats()
+{
+    uploadStats = UniformUploadStats();
+}
+
+bool Shader::updateShadow(GLint location, const void *value, size_t size) const
+{
+    if (location == -1)
+        return false; // like OpenGL, setting a uniform that does not exist is silently ignored
+
+    UniformShadow &shadow = uniformShadows[location];
+    if (shadow.size == size && std::memcmp(shadow.data, value, size) == 0)
+    {
+        uploadStats.skipped++;
+        return false;
+    }
+    std::memcpy(shadow.data, value, size);
+    shadow.size = (unsigned char)size;
+    uploadStats.issued++;
+    return true;
+}
+
+void Shader::forgetShadow(GLint location) const
+{
+    if (location == -1)
+        return;
+    uniformShadows.erase(location);
+    uploadStats.issued++;
+}
+
+void Shader::introspectUniforms()
+{
+    uniformLocations.clear();
+    int uniformCount = 0, maxNameLength = 0;
+    glGetProgramiv(program_ID, GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(program_ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    std::string nameBuffer(std::max(maxNameLength, 1), '\0');
+
+    for (int i = 0; i < uniformCount; i++)
+    {
+        GLsizei nameLength = 0;
+        GLint size = 0;
+        GLenum type;
+        glGetActiveUniform(program_ID, i, (GLsizei)nameBuffer.size(), &nameLength, &size, &type, &nameBuffer[0]);
+        std::string name(nameBuffer.data(), nameLength);
+
+        GLint location = glGetUniformLocation(program_ID, name.c_str());
+        if (location == -1) // uniforms inside uniform blocks have no location
+            continue;
+        uniformLocations[name] = location;
+
+        // arrays of basic types are reported once as name[0] - register the bare name and every element too
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+        {
+            std::string baseName = name.substr(0, name.size() - 3);
+            uniformLocations[baseName] = location;
+            for (GLint element = 1; element < size; element++)
+            {
+                std::string elementName = baseName + "[" + std::to_string(element) + "]";
+                uniformLocations[elementName] = glGetUniformLocation(program_ID, elementName.c_str());
+            }
+        }
+    }
+    LOG("Cached " + std::to_string(uniformLocations.size()) + " uniform locations for shader program: " + std::to_string(program_ID), Logging::LOG_TYPE::INFO);
+}
+
+void Shader::introspectAttributes()
+{
+    attributes.clear();
+    int attributeCount = 0, maxNameLength = 0;
+    glGetProgramiv(program_ID, GL_ACTIVE_ATTRIBUTES, &attributeCount);
+    glGetProgramiv(program_ID, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxNameLength);
+    std::string nameBuffer(std::max(maxNameLength, 1), '\0');
+
+    for (int i = 0; i < attributeCount; i++)
+    {
+        GLsizei nameLength = 0;
+        ShaderAttribute attribute;
+        glGetActiveAttrib(program_ID, i, (GLsizei)nameBuffer.size(), &nameLength, &attribute.size, &attribute.type, &nameBuffer[0]);
+        attribute.name = std::string(nameBuffer.data(), nameLength);
+        if (attribute.name.compare(0, 3, "gl_") == 0) // built-ins (i.e. gl_VertexID) are not fed by vertex buffers
+            continue;
+        attribute.location = glGetAttribLocation(program_ID, attribute.name.c_str());
+        attributes.push_back(attribute);
+    }
+}
+
+const std::vector<ShaderAttribute> &Shader::getAttributes() const
+{
+    return attributes;
+}
+
+/// @brief split a GLSL attribute type into its component type and count
+/// @param type the GLSL type (i.e. GL_FLOAT_VEC3)
+/// @param component_type set to the type of each component (i.e. GL_FLOAT)
+/// @param count set to the number of components
+/// @return false if the type is not a scalar or vector type (i.e. a matrix)
+static bool getAttributeComponents(GLenum type, GLenum &component_type, unsigned int &count)
+{
+    switch (type)
+    {
+    case GL_FLOAT: component_type = GL_FLOAT; count = 1; return true;
+    case GL_FLOAT_VEC2: component_type = GL_FLOAT; count = 2; return true;
+    case GL_FLOAT_VEC3: component_type = GL_FLOAT; count = 3; return true;
+    case GL_FLOAT_VEC4: component_type = GL_FLOAT; count = 4; return true;
+    case GL_INT: component_type = GL_INT; count = 1; return true;
+    case GL_INT_VEC2: component_type = GL_INT; count = 2; return true;
+    case GL_INT_VEC3: component_type = GL_INT; count = 3; return true;
+    case GL_INT_VEC4: component_type = GL_INT; count = 4; return true;
+    case GL_UNSIGNED_INT: component_type = GL_UNSIGNED_INT; count = 1; return true;
+    case GL_UNSIGNED_INT_VEC2: component_type = GL_UNSIGNED_INT; count = 2; return true;
+    case GL_UNSIGNED_INT_VEC3: component_type = GL_UNSIGNED_INT; count = 3; return true;
+    case GL_UNSIGNED_INT_VEC4: component_type = GL_UNSIGNED_INT; count = 4; return true;
+    default: return false;
+    }
+}
+
+bool Shader::validateVertexLayout(const VertexDescription &description) const
+{
+    if (validatedDescription == &description)
+        return validatedResult;
+
+    bool valid = true;
+    for (const ShaderAttribute &attribute : attributes)
+    {
+        auto match = std::find_if(description.attributes.begin(), description.attributes.end(),
+                                  [&attribute](const VertexAttributeDescription &vertexAttribute)
+                                  { return vertexAttribute.name == attribute.name; });
+        if (match == description.attributes.end())
+        {
+            LOG("Shader program " + std::to_string(program_ID) + " reads attribute " + attribute.name + " which the vertex does not provide", Logging::LOG_TYPE::ERROR);
+            valid = false;
+            continue;
+        }
+        if ((GLint)match->location != attribute.location)
+        {
+            LOG("Attribute " + attribute.name + " is at location " + std::to_string(attribute.location) + " in shader program " + std::to_string(program_ID) +
+                    " but the vertex feeds location " + std::to_string(match->location),
+                Logging::LOG_TYPE::ERROR);
+            valid = false;
+        }
+
+        GLenum componentType;
+        unsigned int componentCount;
+        if (!getAttributeComponents(attribute.type, componentType, componentCount))
+            continue; // matrix attributes span several locations - leave them to the caller
+        bool vertexIsFloat = match->type == GL_FLOAT || match->type == GL_HALF_FLOAT || match->type == GL_DOUBLE || match->normalised;
+        if ((componentType == GL_FLOAT) != vertexIsFloat)
+        {
+            LOG("Attribute " + attribute.name + " has a different component type in shader program " + std::to_string(program_ID) + " than in the vertex",
+                Logging::LOG_TYPE::ERROR);
+            valid = false;
+        }
+        else if (componentCount > match->count)
+            LOG("Attribute " + attribute.name + " has " + std::to_string(componentCount) + " components in shader program " + std::to_string(program_ID) +
+                    " but the vertex provides " + std::to_string(match->count) + " (the rest are filled with defaults)",
+                Logging::LOG_TYPE::WARNING);
+    }
+
+    validatedDescription = &description;
+    validatedResult = valid;
+    return valid;
+}
+
+void Shader::bindUniformBlocks()
+{
+    for (const UniformBlockDescription &block : UNIFORM_BLOCKS)
+    {
+        GLuint blockIndex = glGetUniformBlockIndex(program_ID, block.blockName);
+        if (blockIndex == GL_INVALID_INDEX) // this program does not use the block
+            continue;
+        glUniformBlockBinding(program_ID, blockIndex, static_cast<GLuint>(block.binding));
+    }
+}
+
+GLint Shader::getUniformLocation(const std::string &uniform_name) const
+{
+    auto search = uniformLocations.find(uniform_name);
+    if (search == uniformLocations.end())
+        return -1; // like OpenGL, setting a uniform that does not exist is silently ignored
+    return search->second;
+}
+
+std::string Shader::loadShaderFile(const char *shader_path)
+{
+    // shared files are parsed once per process and #includes are expanded from the parsed copies
+    return ShaderSourceCache::getSource(shader_path);
+}
+
+std::string Shader::injectDefines(const std::string &shader_code, const std::string &define_block)
+{
+    if (define_block.empty())
+        return shader_code;
+    // #version must stay the first line, so the defines go straight after it
+    size_t versionPos = shader_code.find("#version");
+    if (versionPos == std::string::npos)
+        return define_block + shader_code;
+    size_t lineEnd = shader_code.find('\n', versionPos);
+    if (lineEnd == std::string::npos)
+        return shader_code + "\n" + define_block;
+    // reset the line number so compile errors still point at the right line of the file
+    size_t versionLine = std::count(shader_code.begin(), shader_code.begin() + lineEnd, '\n') + 1;
+    return shader_code.substr(0, lineEnd + 1) + define_block + "#line " + std::to_string(versionLine + 1) + "\n" + shader_code.substr(lineEnd + 1);
 }
 
 unsigned int Shader::compileShader(const char *shader_code, GLenum shader_type)
@@ -118,15 +491,7 @@ unsigned int Shader::compileShader(const char *shader_code, GLenum shader_type)
     shader_id = glCreateShader(shader_type); // init shader object in OpenGL
     glShaderSource(shader_id, 1, &shader_code, NULL); // provide object with source code
     glCompileShader(shader_id);
-    // check success
-    int success;
-    char infoLog[512];
-    glGetShaderiv(shader_id, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(shader_id, 512, NULL, infoLog);
-        LOG(std::string("Failed to compile shader file: \n") + infoLog, Logging::LOG_TYPE::ERROR);
-    }
+    // the status is checked in checkBuildStatus - asking now would wait for the compile to finish
     return shader_id;
 }
 
@@ -134,18 +499,50 @@ unsigned int Shader::buildShaderProgram(unsigned int vertexShader_id, unsigned i
 {
     // create shader program
     unsigned int shaderProgram_id = glCreateProgram();
+    // ask the driver to keep the binary around so it can be cached
+    if (ProgramCache::isSupported())
+        glProgramParameteri(shaderProgram_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glAttachShader(shaderProgram_id, vertexShader_id);
     glAttachShader(shaderProgram_id, fragmentShader_id);
     glLinkProgram(shaderProgram_id);
+    return shaderProgram_id;
+}
 
-    // chack for errors
+bool Shader::checkBuildStatus(unsigned int shaderProgram_id, unsigned int vertexShader_id, unsigned int fragmentShader_id)
+{
+    // check the link first - if it succeeded the shaders must have compiled
     int success;
     char infoLog[512];
     glGetProgramiv(shaderProgram_id, GL_LINK_STATUS, &success);
-    if (!success)
+    if (success)
+        return true;
+
+    for (unsigned int shader_id : {vertexShader_id, fragmentShader_id})
     {
-        glGetProgramInfoLog(shaderProgram_id, 512, NULL, infoLog);
-        LOG(std::string("Failed to link shader program: \n") + infoLog, Logging::LOG_TYPE::ERROR);
+        int compiled;
+        glGetShaderiv(shader_id, GL_COMPILE_STATUS, &compiled);
+        if (!compiled)
+        {
+            glGetShaderInfoLog(shader_id, 512, NULL, infoLog);
+            LOG(std::string("Failed to compile shader file: \n") + infoLog, Logging::LOG_TYPE::ERROR);
+        }
     }
-    return shaderProgram_id;
+    glGetProgramInfoLog(shaderProgram_id, 512, NULL, infoLog);
+    LOG(std::string("Failed to link shader program: \n") + infoLog, Logging::LOG_TYPE::ERROR);
+    return false;
+}
+
+bool Shader::hasParallelCompile()
+{
+    static bool supported = []()
+    {
+        bool hasExtension = GLCapabilities::hasExtension("GL_KHR_parallel_shader_compile");
+#ifdef GL_KHR_parallel_shader_compile
+        // let the driver pick how many compiler threads to use
+        if (hasExtension)
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+#endif
+        return hasExtension;
+    }();
+    return supported;
 }
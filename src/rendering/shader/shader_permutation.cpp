@@ -0,0 +1,54 @@
+#include "rendering/shader/shader_permutation.h"
+#include "utils/hashing/hashing.h"
+
+ShaderPermutation::ShaderPermutation()
+    : features(), defines()
+{
+}
+
+ShaderPermutation &ShaderPermutation::addFeature(const std::string &feature)
+{
+    features.insert(feature);
+    return *this;
+}
+
+ShaderPermutation &ShaderPermutation::setDefine(const std::string &name, const std::string &value)
+{
+    defines[name] = value;
+    return *this;
+}
+
+bool ShaderPermutation::hasFeature(const std::string &feature) const
+{
+    return features.count(feature) > 0;
+}
+
+ShaderPermutation ShaderPermutation::combine(const ShaderPermutation &other) const
+{
+    ShaderPermutation combined = *this;
+    combined.features.insert(other.features.begin(), other.features.end());
+    for (const auto &define : other.defines)
+        combined.defines[define.first] = define.second;
+    return combined;
+}
+
+std::string ShaderPermutation::getDefineBlock() const
+{
+    // sets and maps are ordered, so equal permutations always produce the same block
+    std::string block;
+    for (const std::string &feature : features)
+        block += "#define " + feature + "\n";
+    for (const auto &define : defines)
+        block += "#define " + define.first + " " + define.second + "\n";
+    return block;
+}
+
+uint64_t ShaderPermutation::getKey() const
+{
+    return Hashing::hash64(getDefineBlock());
+}
+
+bool ShaderPermutation::operator==(const ShaderPermutation &other) const
+{
+    return features == other.features && defines == other.defines;
+}
@@ -0,0 +1,159 @@
+#include "rendering/shader/shader_source_cache.h"
+#include "utils/logging/logging.h"
+#include <algorithm>
+#include <fstream>
+#include <regex>
+
+std::string ShaderSourceCache::getSource(const std::string &shader_path)
+{
+    std::vector<std::string> included;
+    std::string source;
+    getInstance().expand(normalisePath(shader_path), included, source);
+    return source;
+}
+
+std::set<std::string> ShaderSourceCache::pollChanges()
+{
+    ShaderSourceCache &instance = getInstance();
+    std::vector<std::string> changed;
+    for (const auto &pair : instance.pathToSource)
+    {
+        std::error_code error;
+        std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(pair.first, error);
+        if (!error && writeTime != pair.second.writeTime)
+            changed.push_back(pair.first);
+    }
+
+    std::set<std::string> affected;
+    for (const std::string &path : changed)
+    {
+        LOG("Shader file changed: " + path, Logging::LOG_TYPE::INFO);
+        instance.parseFile(path);
+        affected.insert(path);
+        std::set<std::string> dependents = getDependents(path);
+        affected.insert(dependents.begin(), dependents.end());
+    }
+    return affected;
+}
+
+std::set<std::string> ShaderSourceCache::getDependents(const std::string &shader_path)
+{
+    ShaderSourceCache &instance = getInstance();
+    std::set<std::string> dependents;
+    std::vector<std::string> toVisit = {normalisePath(shader_path)};
+    while (!toVisit.empty())
+    {
+        std::string path = toVisit.back();
+        toVisit.pop_back();
+        auto search = instance.includedBy.find(path);
+        if (search == instance.includedBy.end())
+            continue;
+        for (const std::string &includer : search->second)
+            if (dependents.insert(includer).second)
+                toVisit.push_back(includer);
+    }
+    return dependents;
+}
+
+std::string ShaderSourceCache::normalisePath(const std::string &shader_path)
+{
+    return std::filesystem::path(shader_path).lexically_normal().generic_string();
+}
+
+size_t ShaderSourceCache::getParsedFileCount()
+{
+    return getInstance().pathToSource.size();
+}
+
+ShaderSourceCache::ShaderSourceCache()
+    : pathToSource(), includedBy()
+{
+}
+
+ShaderSourceCache &ShaderSourceCache::getInstance()
+{
+    static ShaderSourceCache instance;
+    return instance;
+}
+
+const ParsedShaderSource &ShaderSourceCache::getParsed(const std::string &path)
+{
+    auto search = pathToSource.find(path);
+    if (search == pathToSource.end())
+    {
+        parseFile(path);
+        search = pathToSource.find(path);
+    }
+    return search->second;
+}
+
+void ShaderSourceCache::parseFile(const std::string &path)
+{
+    // forget the includes of the old version of this file
+    auto old = pathToSource.find(path);
+    if (old != pathToSource.end())
+        for (const ShaderSourceChunk &chunk : old->second.chunks)
+            if (!chunk.includePath.empty())
+                includedBy[chunk.includePath].erase(path);
+
+    ParsedShaderSource parsed;
+    std::error_code error;
+    parsed.writeTime = std::filesystem::last_write_time(path, error);
+
+    std::ifstream shaderFile(path);
+    if (!shaderFile)
+        LOG("Failed to read shader file: " + path, Logging::LOG_TYPE::ERROR);
+
+    // split the file into runs of text separated by include directives
+    static const std::regex includePattern("^\\s*#\\s*include\\s+\"([^\"]+)\"");
+    std::string directory = std::filesystem::path(path).parent_path().generic_string();
+    ShaderSourceChunk text;
+    std::string line;
+    unsigned int lineNumber = 0;
+    std::smatch match;
+    while (std::getline(shaderFile, line))
+    {
+        lineNumber++;
+        if (!std::regex_search(line, match, includePattern))
+        {
+            text.text += line + "\n";
+            continue;
+        }
+        if (!text.text.empty())
+            parsed.chunks.push_back(text);
+        text = ShaderSourceChunk();
+
+        // include paths are relative to the including file
+        ShaderSourceChunk include;
+        include.includePath = normalisePath(directory.empty() ? match[1].str() : directory + "/" + match[1].str());
+        include.lineAfterInclude = lineNumber + 1;
+        includedBy[include.includePath].insert(path);
+        parsed.chunks.push_back(include);
+    }
+    if (!text.text.empty())
+        parsed.chunks.push_back(text);
+
+    pathToSource[path] = std::move(parsed);
+}
+
+void ShaderSourceCache::expand(const std::string &path, std::vector<std::string> &included, std::string &output)
+{
+    included.push_back(path);
+    // the source string number in #line lets compile errors be traced back to a file (0 is the file being compiled, then in include order)
+    size_t sourceNumber = included.size() - 1;
+
+    for (const ShaderSourceChunk &chunk : getParsed(path).chunks)
+    {
+        if (chunk.includePath.empty())
+        {
+            output += chunk.text;
+            continue;
+        }
+        // each file is only expanded once, which also stops include cycles
+        if (std::find(included.begin(), included.end(), chunk.includePath) != included.end())
+            continue;
+        output += "#line 1 " + std::to_string(included.size()) + "\n";
+        expand(chunk.includePath, included, output);
+        output += "#line " + std::to_string(chunk.lineAfterInclude) + " " + std::to_string(sourceNumber) + "\n";
+    }
+}
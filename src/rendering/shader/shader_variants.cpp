@@ -0,0 +1,94 @@
+#include "rendering/shader/shader_variants.h"
+#include "utils/logging/logging.h"
+#include "rendering/shader/shader_source_cache.h"
+
+ShaderVariants::ShaderVariants(const std::string &vertex_shader_path, const std::string &fragment_shader_path, const ShaderPermutation &base_permutation)
+    : vertexShaderPath(vertex_shader_path), fragmentShaderPath(fragment_shader_path), basePermutation(base_permutation), variants(), permutations()
+{
+}
+
+Shader &ShaderVariants::getVariant(const ShaderPermutation &permutation)
+{
+    ShaderPermutation fullPermutation = basePermutation.combine(permutation);
+    uint64_t key = fullPermutation.getKey();
+    auto search = variants.find(key);
+    if (search != variants.end())
+    {
+        search->second->finishBuild();
+        return *search->second;
+    }
+    return createVariant(fullPermutation, SHADER_BUILD::IMMEDIATE);
+}
+
+void ShaderVariants::submit(const std::vector<ShaderPermutation> &permutations)
+{
+    for (const ShaderPermutation &permutation : permutations)
+    {
+        ShaderPermutation fullPermutation = basePermutation.combine(permutation);
+        if (variants.count(fullPermutation.getKey()) == 0)
+            createVariant(fullPermutation, SHADER_BUILD::DEFERRED);
+    }
+}
+
+bool ShaderVariants::isBuildComplete() const
+{
+    for (const auto &variant : variants)
+        if (!variant.second->isBuildComplete())
+            return false;
+    return true;
+}
+
+void ShaderVariants::finishBuilds()
+{
+    for (auto &variant : variants)
+        variant.second->finishBuild();
+}
+
+void ShaderVariants::precompile(const std::vector<ShaderPermutation> &permutations)
+{
+    submit(permutations);
+    finishBuilds();
+}
+
+Shader &ShaderVariants::createVariant(const ShaderPermutation &full_permutation, SHADER_BUILD build)
+{
+    LOG("Building shader variant of " + fragmentShaderPath + ":\n" + full_permutation.getDefineBlock(), Logging::LOG_TYPE::INFO);
+    std::unique_ptr<Shader> variant = std::make_unique<Shader>(vertexShaderPath.c_str(), fragmentShaderPath.c_str(), full_permutation, build);
+    Shader &variantRef = *variant;
+    variants.emplace(full_permutation.getKey(), std::move(variant));
+    permutations.emplace(full_permutation.getKey(), full_permutation);
+    return variantRef;
+}
+
+unsigned int ShaderVariants::reload(const std::set<std::string> &affected_files)
+{
+    if (affected_files.count(ShaderSourceCache::normalisePath(vertexShaderPath)) == 0 &&
+        affected_files.count(ShaderSourceCache::normalisePath(fragmentShaderPath)) == 0)
+        return 0;
+
+    // submit every rebuild before waiting on any of them
+    std::vector<std::pair<uint64_t, std::unique_ptr<Shader>>> rebuilds;
+    for (const auto &pair : permutations)
+        rebuilds.emplace_back(pair.first, std::make_unique<Shader>(vertexShaderPath.c_str(), fragmentShaderPath.c_str(), pair.second, SHADER_BUILD::DEFERRED));
+
+    unsigned int rebuilt = 0;
+    for (auto &rebuild : rebuilds)
+    {
+        rebuild.second->finishBuild();
+        if (!rebuild.second->isLinked())
+        {
+            LOG("Keeping the previous build of " + fragmentShaderPath + " as the new one failed", Logging::LOG_TYPE::WARNING);
+            continue;
+        }
+        // move into the existing shader so references to it stay valid (it gets a new revision, so handles are re-fetched)
+        *variants[rebuild.first] = std::move(*rebuild.second);
+        rebuilt++;
+    }
+    LOG("Hot reloaded " + std::to_string(rebuilt) + " variants of " + fragmentShaderPath, Logging::LOG_TYPE::INFO, Logging::LOG_PRIORITY::HIGH);
+    return rebuilt;
+}
+
+size_t ShaderVariants::getVariantCount() const
+{
+    return variants.size();
+}
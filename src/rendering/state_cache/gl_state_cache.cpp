@@ -0,0 +1,185 @@
+#include "rendering/state_cache/gl_state_cache.h"
+
+// a value no binding can hold, so the first bind of anything is always issued
+static const GLuint UNKNOWN_BINDING = 0xFFFFFFFF;
+
+void GLStateCache::useProgram(GLuint program_id)
+{
+    GLStateCache &instance = getInstance();
+    if (instance.update(instance.program, program_id))
+        glUseProgram(program_id);
+}
+
+void GLStateCache::bindVertexArray(GLuint vao_id)
+{
+    GLStateCache &instance = getInstance();
+    if (instance.update(instance.vertexArray, vao_id))
+        glBindVertexArray(vao_id);
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer_id)
+{
+    GLStateCache &instance = getInstance();
+    if (target == GL_ELEMENT_ARRAY_BUFFER && instance.vertexArray == UNKNOWN_BINDING)
+    {
+        // the element array binding belongs to the bound VAO, so we cannot know it without knowing the VAO
+        instance.stats.issued++;
+        glBindBuffer(target, buffer_id);
+        return;
+    }
+    std::unordered_map<GLuint, GLuint> &bindings = target == GL_ELEMENT_ARRAY_BUFFER ? instance.elementBuffers : instance.buffers;
+    GLuint &cached = bindings.try_emplace(target == GL_ELEMENT_ARRAY_BUFFER ? instance.vertexArray : target, UNKNOWN_BINDING).first->second;
+    if (instance.update(cached, buffer_id))
+        glBindBuffer(target, buffer_id);
+}
+
+void GLStateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer_id)
+{
+    GLStateCache &instance = getInstance();
+    GLuint &cached = instance.indexedBuffers.try_emplace(((uint64_t)target << 32) | index, UNKNOWN_BINDING).first->second;
+    if (instance.update(cached, buffer_id))
+    {
+        glBindBufferBase(target, index, buffer_id);
+        instance.buffers[target] = buffer_id; // glBindBufferBase binds the generic target as well
+    }
+}
+
+void GLStateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer_id, GLintptr offset, GLsizeiptr size)
+{
+    GLStateCache &instance = getInstance();
+    glBindBufferRange(target, index, buffer_id, offset, size);
+    instance.stats.issued++;
+    // the binding point no longer holds the whole buffer, so the next bindBufferBase must be issued
+    instance.indexedBuffers[((uint64_t)target << 32) | index] = UNKNOWN_BINDING;
+    instance.buffers[target] = buffer_id; // glBindBufferRange binds the generic target as well
+}
+
+void GLStateCache::activeTexture(GLenum unit)
+{
+    GLStateCache &instance = getInstance();
+    if (instance.update(instance.activeTextureUnit, unit))
+        glActiveTexture(unit);
+}
+
+void GLStateCache::bindTexture(GLenum unit, GLenum target, GLuint texture_id)
+{
+    GLStateCache &instance = getInstance();
+    GLuint &cached = instance.textures.try_emplace(((uint64_t)unit << 32) | target, UNKNOWN_BINDING).first->second;
+    if (!instance.update(cached, texture_id))
+        return;
+    activeTexture(unit);
+    glBindTexture(target, texture_id);
+}
+
+void GLStateCache::bindSampler(GLuint unit, GLuint sampler_id)
+{
+    GLStateCache &instance = getInstance();
+    GLuint &cached = instance.samplers.try_emplace(unit, UNKNOWN_BINDING).first->second;
+    if (instance.update(cached, sampler_id))
+        glBindSampler(unit, sampler_id);
+}
+
+void GLStateCache::forgetProgram(GLuint program_id)
+{
+    // deleting the current program leaves it in use until another is made current, so unknown is the only safe answer
+    GLStateCache &instance = getInstance();
+    if (program_id != 0 && instance.program == program_id)
+        instance.program = UNKNOWN_BINDING;
+}
+
+void GLStateCache::forgetVertexArray(GLuint vao_id)
+{
+    // OpenGL reverts to VAO 0 when the bound VAO is deleted
+    GLStateCache &instance = getInstance();
+    if (vao_id == 0)
+        return;
+    if (instance.vertexArray == vao_id)
+        instance.vertexArray = 0;
+    instance.elementBuffers.erase(vao_id);
+}
+
+void GLStateCache::forgetBuffer(GLuint buffer_id)
+{
+    // OpenGL unbinds a deleted buffer from every target it is bound to (in the current VAO)
+    GLStateCache &instance = getInstance();
+    if (buffer_id == 0)
+        return;
+    for (auto &binding : instance.buffers)
+        if (binding.second == buffer_id)
+            binding.second = 0;
+    for (auto &binding : instance.indexedBuffers)
+        if (binding.second == buffer_id)
+            binding.second = 0;
+    for (auto &binding : instance.elementBuffers)
+        if (binding.second == buffer_id)
+            binding.second = binding.first == instance.vertexArray ? 0 : UNKNOWN_BINDING;
+}
+
+void GLStateCache::forgetTexture(GLuint texture_id)
+{
+    // OpenGL unbinds a deleted texture from every unit
+    GLStateCache &instance = getInstance();
+    if (texture_id == 0)
+        return;
+    for (auto &binding : instance.textures)
+        if (binding.second == texture_id)
+            binding.second = 0;
+}
+
+void GLStateCache::forgetSampler(GLuint sampler_id)
+{
+    // OpenGL unbinds a deleted sampler from every unit
+    GLStateCache &instance = getInstance();
+    if (sampler_id == 0)
+        return;
+    for (auto &binding : instance.samplers)
+        if (binding.second == sampler_id)
+            binding.second = 0;
+}
+
+void GLStateCache::invalidate()
+{
+    GLStateCache &instance = getInstance();
+    instance.program = UNKNOWN_BINDING;
+    instance.vertexArray = UNKNOWN_BINDING;
+    instance.activeTextureUnit = UNKNOWN_BINDING;
+    instance.buffers.clear();
+    instance.elementBuffers.clear();
+    instance.indexedBuffers.clear();
+    instance.textures.clear();
+    instance.samplers.clear();
+}
+
+GLStateStats GLStateCache::getStats()
+{
+    return getInstance().stats;
+}
+
+void GLStateCache::resetStats()
+{
+    getInstance().stats = GLStateStats();
+}
+
+GLStateCache &GLStateCache::getInstance()
+{
+    static GLStateCache instance;
+    return instance;
+}
+
+GLStateCache::GLStateCache()
+    : program(UNKNOWN_BINDING), vertexArray(UNKNOWN_BINDING), activeTextureUnit(UNKNOWN_BINDING), buffers(), elementBuffers(), indexedBuffers(),
+      textures(), samplers(), stats()
+{
+}
+
+bool GLStateCache::update(GLuint &cached, GLuint value)
+{
+    if (cached == value)
+    {
+        stats.skipped++;
+        return false;
+    }
+    cached = value;
+    stats.issued++;
+    return true;
+}
@@ -1,5 +1,10 @@
 #include "rendering/texture/texture.h"
 #include "utils/logging/logging.h"
+#include "rendering/sampler/sampler.h"
+#include "rendering/state_cache/gl_state_cache.h"
+#include "utils/thread_pool/thread_pool.h"
+#include <algorithm>
+#include <chrono>
 
 TextureParam::TextureParam(GLenum paramName, GLenum value)
 {
@@ -13,30 +18,21 @@ TextureParam::TextureParam(std::tuple<GLenum, GLenum> pair)
     this->value = std::get<1>(pair);
 }
 
-Texture::Texture(GLenum texture_target_type, const std::vector<TextureParam> &params, const std::string &texture_path, TEXTURE_USECASE usecase, GLenum texture_unit)
-{
-    // generate a texture object in OpenGL
-    unsigned int id;
-    glGenTextures(1, &id);
-    this->texture_ID = id;
-
-    // bind it (using the explicit texture type)
-    this->textureTargetType = texture_target_type;
-    glBindTexture(this->textureTargetType, this->texture_ID);
-
-    this->usecase = usecase;
+unsigned long long Texture::bindTick = 0;
 
-    this->textureUnit = texture_unit;
-
-    // set the parameters (if any)
-    for (const auto &param : params)
-        glTexParameteri(this->textureTargetType, param.paramName, param.value);
-
-    // load and apply the texture
-    assignTexture(texture_path);
+Texture::Texture(GLenum texture_target_type, const std::vector<TextureParam> &params, const std::string &texture_path, TEXTURE_USECASE usecase, GLenum texture_unit, bool stream_mips)
+    : Texture::Texture(texture_target_type, params, texture_path, usecase, texture_unit, stream_mips, std::vector<unsigned char>())
+{
+}
 
-    // unbind the texture after set up to maintain a clean state
-    unbind();
+Texture::Texture(GLenum texture_target_type, const std::vector<TextureParam> &params, const std::string &texture_path, TEXTURE_USECASE usecase, GLenum texture_unit, bool stream_mips,
+                 const std::vector<unsigned char> &file_data)
+    : texture_ID(0), textureTargetType(texture_target_type), usecase(usecase), textureUnit(texture_unit),
+      dimensions(0.0f, 0.0f), texturePath(texture_path), sampler(SamplerCache::getSampler(params)), memorySize(0), lastBoundTick(0),
+      format(GL_RGBA), channels(0), streamed(stream_mips), mipLevelCount(1), mipTailLevel(0), residentMipLevel(0), requestedMipLevel(0),
+      streamedMipLevels(), streamingMipLevel(0)
+{
+    create(file_data);
 }
 
 Texture::Texture(GLenum texture_target_type, const std::vector<TextureParam> &params, const std::string &texture_path)
@@ -52,8 +48,22 @@ Texture::Texture(Texture &&other)
     this->usecase = other.usecase;
     this->textureUnit = other.textureUnit;
     this->dimensions = other.dimensions;
+    this->texturePath = std::move(other.texturePath);
+    this->sampler = std::move(other.sampler);
+    this->memorySize = other.memorySize;
+    this->lastBoundTick = other.lastBoundTick;
+    this->format = other.format;
+    this->channels = other.channels;
+    this->streamed = other.streamed;
+    this->mipLevelCount = other.mipLevelCount;
+    this->mipTailLevel = other.mipTailLevel;
+    this->residentMipLevel = other.residentMipLevel;
+    this->requestedMipLevel = other.requestedMipLevel;
+    this->streamedMipLevels = std::move(other.streamedMipLevels);
+    this->streamingMipLevel = other.streamingMipLevel;
     // remove ownership of the texture object from other
     other.texture_ID = 0;
+    other.memorySize = 0;
 }
 
 Texture &Texture::operator=(Texture &&other) noexcept
@@ -61,6 +71,7 @@ Texture &Texture::operator=(Texture &&other) noexcept
     if (this != &other)
     {
         // delete current texture
+        GLStateCache::forgetTexture(texture_ID);
         glDeleteTextures(1, &texture_ID);
         // copy over important params
         this->texture_ID = other.texture_ID; // obtain ownership of texture object
@@ -68,48 +79,108 @@ Texture &Texture::operator=(Texture &&other) noexcept
         this->textureUnit = other.textureUnit;
         this->dimensions = other.dimensions;
         this->usecase = other.usecase;
+        this->texturePath = std::move(other.texturePath);
+        this->sampler = std::move(other.sampler);
+        this->memorySize = other.memorySize;
+        this->lastBoundTick = other.lastBoundTick;
+        this->format = other.format;
+        this->channels = other.channels;
+        this->streamed = other.streamed;
+        this->mipLevelCount = other.mipLevelCount;
+        this->mipTailLevel = other.mipTailLevel;
+        this->residentMipLevel = other.residentMipLevel;
+        this->requestedMipLevel = other.requestedMipLevel;
+        this->streamedMipLevels = std::move(other.streamedMipLevels);
+        this->streamingMipLevel = other.streamingMipLevel;
         // remove ownership of the texture object from other
         other.texture_ID = 0;
+        other.memorySize = 0;
     }
     return *this;
 }
 
 Texture::~Texture()
 {
+    GLStateCache::forgetTexture(texture_ID);
     glDeleteTextures(1, &texture_ID); // delete the associated texture object from OpenGL
 }
 
 void Texture::bind()
 {
-    glActiveTexture(this->textureUnit);                       // activate the associated texture unit
-    glBindTexture(this->textureTargetType, this->texture_ID); // bind this texture to the unit
+    GLStateCache::bindTexture(this->textureUnit, this->textureTargetType, this->texture_ID); // bind this texture to its unit
+    sampler->bind(getTextureUnit());                                                        // sample it using the shared sampler
+    lastBoundTick = ++bindTick;
 }
 
-void Texture::assignTexture(const std::string &texture_path)
+void Texture::create(const std::vector<unsigned char> &file_data)
+{
+    // generate a texture object in OpenGL
+    unsigned int id;
+    glGenTextures(1, &id);
+    this->texture_ID = id;
+
+    // bind it (using the explicit texture type)
+    bindForEditing();
+
+    // load and apply the texture
+    assignTexture(texturePath, file_data);
+}
+
+void Texture::assignTexture(const std::string &texture_path, const std::vector<unsigned char> &file_data)
 {
     LOG("Attempting to load texture from: " + texture_path, Logging::LOG_TYPE::INFO, Logging::LOG_PRIORITY::MEDIUM);
     // load texture
     int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char *texture_data = stbi_load(texture_path.c_str(), &width, &height, &nrChannels, 0);
+    stbi_set_flip_vertically_on_load_thread(true);
+    unsigned char *texture_data = file_data.empty()
+                                      ? stbi_load(texture_path.c_str(), &width, &height, &nrChannels, 0)
+                                      : stbi_load_from_memory(file_data.data(), (int)file_data.size(), &width, &height, &nrChannels, 0);
     if (texture_data)
     {
         // determine underlying format of texture file
-        GLenum format;
         if (nrChannels == 1)
             format = GL_RED;
+        if (nrChannels == 2)
+            format = GL_RG;
         if (nrChannels == 3)
             format = GL_RGB;
         if (nrChannels == 4)
             format = GL_RGBA;
+        channels = nrChannels;
+        // set dimensions
+        this->dimensions = glm::vec2(width, height);
+        // work out the size of the mip chain and where its coarse tail starts
+        mipLevelCount = 1;
+        while ((width >> mipLevelCount) > 0 || (height >> mipLevelCount) > 0)
+            mipLevelCount++;
+        mipTailLevel = 0;
+        while (mipTailLevel < mipLevelCount - 1 && std::max(width >> mipTailLevel, height >> mipTailLevel) > MIP_TAIL_SIZE)
+            mipTailLevel++;
+        // streamed textures start with only the mip tail loaded, finer levels are streamed in on demand
+        residentMipLevel = streamed ? mipTailLevel : 0;
+        requestedMipLevel = mipTailLevel;
+
         // bind the texture (should already be bound but just in case)
-        glBindTexture(this->textureTargetType, this->texture_ID);
+        bindForEditing();
+        // rows of 3 channel textures and small mip levels are not necessarily 4 byte aligned
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
         // bind texture data to the currently bound texture object
-        glTexImage2D(this->textureTargetType, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, texture_data);
+        if (residentMipLevel == 0)
+            glTexImage2D(this->textureTargetType, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, texture_data);
+        else
+        {
+            std::vector<unsigned char> levelData(texture_data, texture_data + (size_t)width * height * channels);
+            int levelWidth = width, levelHeight = height;
+            for (int level = 0; level < residentMipLevel; level++)
+                levelData = downsample(levelData, levelWidth, levelHeight, channels);
+            glTexImage2D(this->textureTargetType, residentMipLevel, format, levelWidth, levelHeight, 0, format, GL_UNSIGNED_BYTE, levelData.data());
+        }
+        // only sample from the levels we have loaded
+        glTexParameteri(this->textureTargetType, GL_TEXTURE_BASE_LEVEL, residentMipLevel);
+        glTexParameteri(this->textureTargetType, GL_TEXTURE_MAX_LEVEL, mipLevelCount - 1);
         // generate mip maps for the texture (smaller textures for distant renders)
         glGenerateMipmap(this->textureTargetType);
-        // set dimensions
-        this->dimensions = glm::vec2(width, height);
+        memorySize = calculateMemorySize(residentMipLevel);
         LOG("Successfuly loaded texture from: " + texture_path, Logging::LOG_TYPE::INFO, Logging::LOG_PRIORITY::MEDIUM);
     }
     else
@@ -120,9 +191,38 @@ void Texture::assignTexture(const std::string &texture_path)
     stbi_image_free(texture_data);
 }
 
+std::vector<unsigned char> Texture::downsample(const std::vector<unsigned char> &data, int &width, int &height, int channels)
+{
+    int newWidth = std::max(1, width / 2), newHeight = std::max(1, height / 2);
+    std::vector<unsigned char> result((size_t)newWidth * newHeight * channels);
+    for (int y = 0; y < newHeight; y++)
+        for (int x = 0; x < newWidth; x++)
+        {
+            // the 2x2 block of source texels (clamped for odd or 1 texel wide images)
+            int x0 = std::min(2 * x, width - 1), x1 = std::min(2 * x + 1, width - 1);
+            int y0 = std::min(2 * y, height - 1), y1 = std::min(2 * y + 1, height - 1);
+            for (int c = 0; c < channels; c++)
+            {
+                unsigned int sum = data[((size_t)y0 * width + x0) * channels + c] + data[((size_t)y0 * width + x1) * channels + c] +
+                                   data[((size_t)y1 * width + x0) * channels + c] + data[((size_t)y1 * width + x1) * channels + c];
+                result[((size_t)y * newWidth + x) * channels + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    width = newWidth;
+    height = newHeight;
+    return result;
+}
+
 void Texture::unbind()
 {
-    glBindTexture(this->textureTargetType, 0);
+    GLStateCache::bindTexture(this->textureUnit, this->textureTargetType, 0);
+}
+
+void Texture::bindForEditing()
+{
+    // texture edits apply to the texture bound to the active unit, so unlike bind() the unit must be active even if the texture is already bound
+    GLStateCache::activeTexture(this->textureUnit);
+    GLStateCache::bindTexture(this->textureUnit, this->textureTargetType, this->texture_ID);
 }
 
 Texture::TEXTURE_USECASE Texture::getUseCase() const
@@ -133,4 +233,216 @@ Texture::TEXTURE_USECASE Texture::getUseCase() const
 unsigned int Texture::getTextureUnit() const
 {
     return textureUnit - GL_TEXTURE0;
+}
+
+std::shared_ptr<Sampler> Texture::getSampler() const
+{
+    return sampler;
+}
+
+const std::string &Texture::getPath() const
+{
+    return texturePath;
+}
+
+bool Texture::isResident() const
+{
+    return texture_ID != 0;
+}
+
+void Texture::evict()
+{
+    if (!isResident())
+        return;
+    GLStateCache::forgetTexture(texture_ID);
+    glDeleteTextures(1, &texture_ID);
+    texture_ID = 0;
+    memorySize = 0;
+    // levels still being decoded are thrown away (the decode holds no reference to this texture)
+    streamedMipLevels = std::future<DecodedMipLevels>();
+    LOG("Evicted texture: " + texturePath, Logging::LOG_TYPE::INFO, Logging::LOG_PRIORITY::MEDIUM);
+}
+
+void Texture::reload()
+{
+    if (isResident())
+        return;
+    create();
+}
+
+size_t Texture::getMemorySize() const
+{
+    return memorySize;
+}
+
+unsigned long long Texture::getLastBoundTick() const
+{
+    return lastBoundTick;
+}
+
+glm::vec2 Texture::getDimensions() const
+{
+    return dimensions;
+}
+
+bool Texture::isStreamed() const
+{
+    return streamed;
+}
+
+int Texture::getMipLevelCount() const
+{
+    return mipLevelCount;
+}
+
+int Texture::getResidentMipLevel() const
+{
+    return residentMipLevel;
+}
+
+int Texture::getMipTailLevel() const
+{
+    return mipTailLevel;
+}
+
+void Texture::streamInMipLevels(int level, ThreadPool *thread_pool)
+{
+    if (!streamed || !isResident() || isStreamingMipLevels())
+        return;
+    level = std::clamp(level, 0, mipTailLevel);
+    if (level >= residentMipLevel)
+        return;
+
+    // the decode only captures copies, so it is safe if this texture is evicted or destroyed before it finishes
+    std::string path = texturePath;
+    int decodeChannels = channels, endLevel = residentMipLevel;
+    auto decode = [path, decodeChannels, level, endLevel]()
+    {
+        return decodeMipLevels(path, decodeChannels, level, endLevel);
+    };
+    if (thread_pool)
+        streamedMipLevels = thread_pool->submit(decode);
+    else
+    {
+        std::promise<DecodedMipLevels> decoded;
+        decoded.set_value(decode());
+        streamedMipLevels = decoded.get_future();
+    }
+    streamingMipLevel = level;
+}
+
+bool Texture::isStreamingMipLevels() const
+{
+    return streamedMipLevels.valid();
+}
+
+bool Texture::areStreamedMipLevelsReady() const
+{
+    return streamedMipLevels.valid() && streamedMipLevels.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+int Texture::getStreamingMipLevel() const
+{
+    return isStreamingMipLevels() ? streamingMipLevel : residentMipLevel;
+}
+
+int Texture::uploadStreamedMipLevels()
+{
+    if (!isStreamingMipLevels())
+        return 0;
+    DecodedMipLevels decoded = streamedMipLevels.get();
+    // the texture was reloaded or had levels dropped while decoding, so these levels no longer join up with the resident ones
+    if (!isResident() || decoded.endLevel != residentMipLevel)
+        return 0;
+    if (decoded.levels.empty())
+    {
+        LOG("Failed to stream mip levels from texture file: " + texturePath, Logging::LOG_TYPE::ERROR);
+        return 0;
+    }
+
+    bindForEditing();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t i = 0; i < decoded.levels.size(); i++)
+        glTexImage2D(this->textureTargetType, decoded.firstLevel + (int)i, format, decoded.widths[i], decoded.heights[i], 0, format, GL_UNSIGNED_BYTE,
+                     decoded.levels[i].data());
+    // the new levels are complete so we can start sampling from them
+    glTexParameteri(this->textureTargetType, GL_TEXTURE_BASE_LEVEL, decoded.firstLevel);
+    unbind();
+
+    int uploaded = residentMipLevel - decoded.firstLevel;
+    residentMipLevel = decoded.firstLevel;
+    memorySize = calculateMemorySize(residentMipLevel);
+    return uploaded;
+}
+
+void Texture::dropMipLevels(int level)
+{
+    if (!streamed || !isResident())
+        return;
+    // we never drop the mip tail
+    level = std::clamp(level, residentMipLevel, mipTailLevel);
+    if (level == residentMipLevel)
+        return;
+
+    bindForEditing();
+    // stop sampling from the finer levels before freeing them so the texture stays complete
+    glTexParameteri(this->textureTargetType, GL_TEXTURE_BASE_LEVEL, level);
+    for (int currentLevel = residentMipLevel; currentLevel < level; currentLevel++)
+        glTexImage2D(this->textureTargetType, currentLevel, format, 0, 0, 0, format, GL_UNSIGNED_BYTE, nullptr);
+    unbind();
+
+    residentMipLevel = level;
+    memorySize = calculateMemorySize(residentMipLevel);
+}
+
+DecodedMipLevels Texture::decodeMipLevels(const std::string &texture_path, int channels, int first_level, int end_level)
+{
+    DecodedMipLevels decoded = {first_level, end_level, {}, {}, {}};
+    int width, height, nrChannels;
+    // this runs on thread pool workers, so set the flip for this thread only (the global flag would race with loads on other threads)
+    stbi_set_flip_vertically_on_load_thread(true);
+    unsigned char *texture_data = stbi_load(texture_path.c_str(), &width, &height, &nrChannels, channels);
+    if (!texture_data)
+        return decoded;
+    std::vector<unsigned char> levelData(texture_data, texture_data + (size_t)width * height * channels);
+    stbi_image_free(texture_data);
+
+    for (int level = 0; level < end_level; level++)
+    {
+        if (level >= first_level)
+        {
+            decoded.widths.push_back(width);
+            decoded.heights.push_back(height);
+            decoded.levels.push_back(levelData);
+        }
+        if (level + 1 < end_level)
+            levelData = downsample(levelData, width, height, channels);
+    }
+    return decoded;
+}
+
+size_t Texture::calculateMemorySize(int first_level) const
+{
+    // drivers pad 3 channel textures to 4 bytes per texel
+    size_t bytesPerTexel = channels == 3 ? 4 : channels;
+    int width = (int)dimensions.x, height = (int)dimensions.y;
+    size_t size = 0;
+    for (int level = first_level; level < mipLevelCount; level++)
+        size += (size_t)std::max(1, width >> level) * std::max(1, height >> level) * bytesPerTexel;
+    return size;
+}
+
+void Texture::requestMipLevel(int level)
+{
+    requestedMipLevel = std::min(requestedMipLevel, std::max(level, 0));
+}
+
+int Texture::getRequestedMipLevel() const
+{
+    return requestedMipLevel;
+}
+
+void Texture::clearMipLevelRequest()
+{
+    requestedMipLevel = mipTailLevel;
 }
\ No newline at end of file
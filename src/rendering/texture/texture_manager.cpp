@@ -1,4 +1,9 @@
 #include "rendering/texture/texture_manager.h"
+#include "utils/logging/logging.h"
+#include "utils/hashing/hashing.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
 
 TextureInfo::TextureInfo(std::string file_path, std::weak_ptr<Texture> texture)
     : file_path(file_path), texture(texture)
@@ -11,6 +16,30 @@ const TextureInfo TextureManager::loadNewTexture(std::string file_path, Texture:
     if (auto queried_info = getInstance().getTexture(file_path); queried_info.has_value())
         return queried_info.value();
 
+    // read the file once, both to hash it and to decode it from
+    std::optional<std::vector<unsigned char>> fileData = Hashing::readFile(file_path);
+
+    // if identical image data has already been loaded (i.e. under a different path or model directory), share its texture
+    uint64_t contentKey = 0;
+    if (fileData.has_value())
+    {
+        // textures are bound to a fixed unit, so only share textures that use the same unit
+        contentKey = Hashing::combine(Hashing::hash64(fileData->data(), fileData->size()), texture_unit);
+        auto search = getInstance().contentToTexture.find(contentKey);
+        if (search != getInstance().contentToTexture.end())
+            if (auto duplicate = search->second.lock(); duplicate && haveSameContent(*fileData, duplicate->getPath()))
+            {
+                getInstance().locationToTexture[file_path] = duplicate;
+                getInstance().duplicateTextures++;
+                getInstance().duplicateBytesSaved += duplicate->calculateMemorySize(0);
+                LOG("Texture " + file_path + " has the same content as " + duplicate->getPath() + ", sharing it", Logging::LOG_TYPE::INFO, Logging::LOG_PRIORITY::MEDIUM);
+
+                TextureInfo textureInfo(file_path, std::weak_ptr(duplicate));
+                getInstance().onTextureLoaded.emit(textureInfo);
+                return textureInfo;
+            }
+    }
+
     // load and manage texture
     getInstance().locationToTexture[file_path] = std::make_shared<Texture>(
         GL_TEXTURE_2D,
@@ -21,7 +50,14 @@ const TextureInfo TextureManager::loadNewTexture(std::string file_path, Texture:
             TextureParam(GL_TEXTURE_MAG_FILTER, GL_LINEAR)},
         file_path,
         usecase,
-        GL_TEXTURE0 + texture_unit);
+        GL_TEXTURE0 + texture_unit,
+        true, // stream mip levels in on demand
+        fileData.value_or(std::vector<unsigned char>()));
+    if (fileData.has_value())
+        getInstance().contentToTexture[contentKey] = getInstance().locationToTexture[file_path];
+
+    // keep within our memory budget now that a new texture is resident
+    getInstance().enforceBudget(getInstance().locationToTexture[file_path].get());
 
     // build and output info struct
     TextureInfo textureInfo(file_path, std::weak_ptr(getInstance().locationToTexture[file_path]));
@@ -57,6 +93,178 @@ Signal<const TextureInfo> TextureManager::getOnTextureLoadedSignal()
     return getInstance().onTextureLoaded;
 }
 
+void TextureManager::bindTexture(Texture &texture)
+{
+    // reload evicted textures on demand
+    if (!texture.isResident())
+    {
+        texture.reload();
+        getInstance().reloads++;
+        getInstance().enforceBudget(&texture);
+    }
+    texture.bind();
+}
+
+void TextureManager::addMeshReference(const TextureInfo &texture_info)
+{
+    getInstance().meshReferences[texture_info.file_path]++;
+}
+
+void TextureManager::removeMeshReference(const TextureInfo &texture_info)
+{
+    auto search = getInstance().meshReferences.find(texture_info.file_path);
+    if (search == getInstance().meshReferences.end())
+        return;
+    if (--search->second == 0)
+        getInstance().meshReferences.erase(search);
+}
+
+void TextureManager::setMemoryBudget(size_t budget_bytes)
+{
+    getInstance().memoryBudget = budget_bytes;
+    getInstance().enforceBudget(nullptr);
+}
+
+TextureMemoryStats TextureManager::getMemoryStats()
+{
+    TextureMemoryStats stats;
+    stats.residentBytes = getInstance().calculateResidentBytes();
+    stats.budgetBytes = getInstance().memoryBudget;
+    stats.evictions = getInstance().evictions;
+    stats.reloads = getInstance().reloads;
+    stats.mipLevelsStreamedIn = getInstance().mipLevelsStreamedIn;
+    stats.mipLevelsDropped = getInstance().mipLevelsDropped;
+    stats.duplicateTextures = getInstance().duplicateTextures;
+    stats.duplicateBytesSaved = getInstance().duplicateBytesSaved;
+    return stats;
+}
+
+void TextureManager::setStreamingBudget(size_t budget_bytes)
+{
+    getInstance().streamingBudget = budget_bytes;
+}
+
+bool TextureManager::haveSameContent(const std::vector<unsigned char> &file_data, const std::string &file_path)
+{
+    // only files whose hashes match are compared, so reading the other file again here is rare
+    std::optional<std::vector<unsigned char>> otherData = Hashing::readFile(file_path);
+    return otherData.has_value() && otherData->size() == file_data.size() && std::memcmp(otherData->data(), file_data.data(), file_data.size()) == 0;
+}
+
+void TextureManager::setThreadPool(ThreadPool *thread_pool)
+{
+    getInstance().threadPool = thread_pool;
+}
+
+void TextureManager::updateStreaming()
+{
+    TextureManager &instance = getInstance();
+
+    // gather each resident streamed texture once (several paths may share a texture)
+    std::vector<Texture *> textures;
+    std::unordered_set<const Texture *> seen;
+    for (const auto &pair : instance.locationToTexture)
+        if (pair.second->isStreamed() && pair.second->isResident() && seen.insert(pair.second.get()).second)
+            textures.push_back(pair.second.get());
+
+    // serve the textures missing the most detail first
+    std::sort(textures.begin(), textures.end(), [](const Texture *a, const Texture *b)
+              { return a->getRequestedMipLevel() - a->getResidentMipLevel() < b->getRequestedMipLevel() - b->getResidentMipLevel(); });
+
+    // upload the levels decoded since the last update - only the upload counts against this frame's streaming budget, as the decode
+    // happened off this thread (always allow one texture so large levels still load)
+    size_t streamedBytes = 0;
+    for (Texture *texture : textures)
+    {
+        if (!texture->areStreamedMipLevelsReady())
+            continue;
+        size_t cost = texture->calculateMemorySize(texture->getStreamingMipLevel()) - texture->getMemorySize();
+        if (streamedBytes > 0 && streamedBytes + cost > instance.streamingBudget)
+            continue;
+        streamedBytes += cost;
+        instance.mipLevelsStreamedIn += texture->uploadStreamedMipLevels();
+    }
+
+    for (Texture *texture : textures)
+    {
+        int requested = texture->getRequestedMipLevel();
+        int resident = texture->getResidentMipLevel();
+        texture->clearMipLevelRequest();
+        // the texture may have been evicted to make room for another, and a texture still decoding waits for its levels to land
+        if (!texture->isResident() || texture->isStreamingMipLevels())
+            continue;
+
+        if (requested < resident)
+        {
+            // make room for the finer levels now so they can be uploaded as soon as they are decoded
+            size_t cost = texture->calculateMemorySize(requested) - texture->getMemorySize();
+            if (!instance.enforceBudget(texture, cost))
+                continue;
+            texture->streamInMipLevels(requested, instance.threadPool);
+        }
+        else if (requested > resident + MIP_DROP_HYSTERESIS)
+        {
+            texture->dropMipLevels(requested);
+            instance.mipLevelsDropped += requested - resident;
+        }
+    }
+}
+
+size_t TextureManager::calculateResidentBytes() const
+{
+    // several paths may share one texture so make sure each is only counted once
+    std::unordered_set<const Texture *> counted;
+    size_t residentBytes = 0;
+    for (const auto &pair : locationToTexture)
+        if (counted.insert(pair.second.get()).second)
+            residentBytes += pair.second->getMemorySize();
+    return residentBytes;
+}
+
+bool TextureManager::enforceBudget(const Texture *keep, size_t additional_bytes)
+{
+    size_t residentBytes = calculateResidentBytes() + additional_bytes;
+    if (residentBytes <= memoryBudget)
+        return true;
+
+    // find the textures used by live meshes (a texture may be referenced through any of the paths sharing it)
+    std::unordered_set<const Texture *> inUse;
+    for (const auto &pair : meshReferences)
+        if (auto search = locationToTexture.find(pair.first); search != locationToTexture.end())
+            inUse.insert(search->second.get());
+
+    // gather the resident textures no live mesh is using, these are safe to evict
+    std::vector<Texture *> candidates;
+    for (const auto &pair : locationToTexture)
+    {
+        Texture *texture = pair.second.get();
+        if (texture == keep || !texture->isResident() || inUse.count(texture) > 0)
+            continue;
+        if (std::find(candidates.begin(), candidates.end(), texture) == candidates.end())
+            candidates.push_back(texture);
+    }
+
+    // evict the least recently bound textures first
+    std::sort(candidates.begin(), candidates.end(), [](const Texture *a, const Texture *b)
+              { return a->getLastBoundTick() < b->getLastBoundTick(); });
+    for (Texture *texture : candidates)
+    {
+        if (residentBytes <= memoryBudget)
+            break;
+        residentBytes -= texture->getMemorySize();
+        texture->evict();
+        evictions++;
+    }
+
+    if (residentBytes <= memoryBudget)
+        return true;
+    // streaming requests fail quietly as they are retried every frame
+    if (additional_bytes == 0)
+        LOG("Texture memory (" + std::to_string(residentBytes) + " bytes) exceeds budget (" + std::to_string(memoryBudget) + " bytes) but all resident textures are in use",
+            Logging::LOG_TYPE::WARNING, Logging::LOG_PRIORITY::MEDIUM);
+    return false;
+}
+
 TextureManager &TextureManager::getInstance()
 {
     static TextureManager instance;
@@ -64,6 +272,9 @@ TextureManager &TextureManager::getInstance()
 }
 
 TextureManager::TextureManager()
-    : locationToTexture(), onTextureLoaded()
+    : onTextureLoaded(), locationToTexture(), meshReferences(),
+      memoryBudget(DEFAULT_TEXTURE_MEMORY_BUDGET), evictions(0), reloads(0),
+      streamingBudget(DEFAULT_TEXTURE_STREAMING_BUDGET), threadPool(nullptr), mipLevelsStreamedIn(0), mipLevelsDropped(0),
+      contentToTexture(), duplicateTextures(0), duplicateBytesSaved(0)
 {
 }
@@ -1,27 +1,69 @@
 #include "rendering/vao/vao.h"
+#include "rendering/state_cache/gl_state_cache.h"
 #include "glad/glad.h"
 #include <iostream>
 #include "rendering/buffer/ebo/ebo.h"
 #include "utils/logging/logging.h"
+#include "utils/hashing/hashing.h"
 
 VertexBufferElement::VertexBufferElement(GLenum type, unsigned int count, unsigned int totalSize, GLboolean normalised)
-    : type(type), count(count), totalSize(totalSize), normalised(normalised)
+    : VertexBufferElement(type, count, totalSize, normalised, 0)
+{
+}
+
+VertexBufferElement::VertexBufferElement(GLenum type, unsigned int count, unsigned int totalSize, GLboolean normalised, unsigned int offset)
+    : type(type), count(count), totalSize(totalSize), normalised(normalised), offset(offset)
 {
 }
 
 VertexBufferElement::VertexBufferElement()
+    : type(GL_FLOAT), count(0), totalSize(0), normalised(GL_FALSE), offset(0)
 {
 }
 
 VertexBufferLayout::VertexBufferLayout()
-    : attributeToElements(), stride()
+    : attributeToElements(), stride(), key(0)
 {
 }
 
+VertexBufferLayout::VertexBufferLayout(const VertexDescription &description)
+    : attributeToElements(), stride(description.stride), key(0)
+{
+    for (const VertexAttributeDescription &attribute : description.attributes)
+        attributeToElements[attribute.location] = VertexBufferElement(attribute.type, attribute.count, attribute.size, attribute.normalised, attribute.offset);
+}
+
 void VertexBufferLayout::addAttribute(unsigned int index, GLenum type, unsigned int count, unsigned int totalSize, GLboolean normalised)
 {
-    VertexBufferElement vertexBufferElement = VertexBufferElement(type, count, totalSize, normalised);
+    // pack the attribute straight after the previous one
+    addAttribute(index, type, count, totalSize, normalised, stride);
+    stride += totalSize;
+}
+
+void VertexBufferLayout::addAttribute(unsigned int index, GLenum type, unsigned int count, unsigned int totalSize, GLboolean normalised, unsigned int offset)
+{
+    VertexBufferElement vertexBufferElement = VertexBufferElement(type, count, totalSize, normalised, offset);
     attributeToElements[index] = vertexBufferElement;
+    key = 0;
+}
+
+void VertexBufferLayout::setStride(unsigned int stride)
+{
+    this->stride = stride;
+    key = 0;
+}
+
+uint64_t VertexBufferLayout::getKey() const
+{
+    if (key != 0)
+        return key;
+    key = Hashing::hash64(&stride, sizeof(stride));
+    for (const auto &pair : attributeToElements)
+    {
+        const unsigned int fields[] = {(unsigned int)pair.first, pair.second.type, pair.second.count, pair.second.normalised, pair.second.offset};
+        key = Hashing::combine(key, Hashing::hash64(fields, sizeof(fields)));
+    }
+    return key;
 }
 
 void VertexBufferLayout::addAttribute(GLenum type, unsigned int count, unsigned int totalSize, GLboolean normalised)
@@ -43,13 +85,6 @@ const std::vector<VertexBufferElement> VertexBufferLayout::getElements() const
 
 unsigned int VertexBufferLayout::getStride() const
 {
-    unsigned int stride = 0;
-
-    for (const auto &pair : attributeToElements)
-    {
-        stride += pair.second.totalSize;
-    }
-
     return stride;
 }
 
@@ -58,6 +93,39 @@ const std::map<int, VertexBufferElement> VertexBufferLayout::getMap() const
     return attributeToElements;
 }
 
+const VertexFormat &VertexFormatCache::getFormat(const VertexBufferLayout &layout)
+{
+    VertexFormatCache &instance = getInstance();
+    uint64_t key = layout.getKey();
+    auto search = instance.keyToFormat.find(key);
+    if (search != instance.keyToFormat.end())
+        return search->second;
+
+    // first time we have seen this layout - flatten it
+    VertexFormat format;
+    format.stride = layout.getStride();
+    for (const auto &pair : layout.getMap())
+        format.attributes.push_back({(unsigned int)pair.first, pair.second.count, pair.second.type, pair.second.normalised, pair.second.offset});
+    LOG("Cached vertex format with " + std::to_string(format.attributes.size()) + " attributes and stride " + std::to_string(format.stride), Logging::LOG_TYPE::INFO);
+    return instance.keyToFormat.emplace(key, std::move(format)).first->second;
+}
+
+size_t VertexFormatCache::getFormatCount()
+{
+    return getInstance().keyToFormat.size();
+}
+
+VertexFormatCache::VertexFormatCache()
+    : keyToFormat()
+{
+}
+
+VertexFormatCache &VertexFormatCache::getInstance()
+{
+    static VertexFormatCache instance;
+    return instance;
+}
+
 VAO::VAO()
 {
     glGenVertexArrays(1, &vao_ID);
@@ -81,6 +149,7 @@ VAO &VAO::operator=(VAO &&other) noexcept
     if (this != &other)
     {
         // delete the current VAO as we are being assigned a new one
+        GLStateCache::forgetVertexArray(vao_ID);
         glDeleteVertexArrays(1, &vao_ID);
         // transfer ownership of the Vertex Array Object to this VAO
         this->vao_ID = other.vao_ID;
@@ -96,6 +165,7 @@ VAO &VAO::operator=(VAO &&other) noexcept
 
 VAO::~VAO()
 {
+    GLStateCache::forgetVertexArray(vao_ID);
     glDeleteVertexArrays(1, &vao_ID);
     if (vao_ID != 0)
         LOG("Deleted VAO: " + std::to_string(vao_ID), Logging::LOG_TYPE::INFO);
@@ -106,20 +176,10 @@ void VAO::addBuffer(VBO &&vbo, const VertexBufferLayout &layout)
     bind();     // Bind the VAO
     vbo.bind(); // Bind the VBO
 
-    unsigned int stride = layout.getStride(); // Get the stride from the layout
-    unsigned int currentOffset = 0;           // Initialize the offset
-
-    // Iterate through the layout elements
-    for (const auto &pair : layout.getMap())
-    {
-        unsigned int attribute_id = pair.first;
-        const VertexBufferElement &bufferElement = pair.second;
-
-        addVertexAttrribSpec(attribute_id, bufferElement.count, bufferElement.type, bufferElement.normalised, stride, currentOffset);
-
-        // Increment the offset
-        currentOffset += bufferElement.totalSize;
-    }
+    // the flattened attribute formats are shared by every VAO with this layout
+    const VertexFormat &format = VertexFormatCache::getFormat(layout);
+    for (const VertexAttributeFormat &attribute : format.attributes)
+        addVertexAttrribSpec(attribute.location, attribute.count, attribute.type, attribute.normalised, format.stride, attribute.offset);
 
     vbo.unbind();                   // Unbind the VBO
     unsigned int vbo_id = vbo.getID();
@@ -129,9 +189,13 @@ void VAO::addBuffer(VBO &&vbo, const VertexBufferLayout &layout)
 }
 
 void VAO::addBuffer(EBO &&ebo)
-{   
+{
     unsigned int ebo_id = ebo.getID();
     this->ebo = std::move(ebo);
+    // the element buffer binding is stored in the VAO, so it only needs binding once rather than every time the VAO is bound
+    bind();
+    this->ebo->bind();
+    unbind();
     LOG(std::string("Assigned EBO: ") + std::to_string(ebo_id) + " to VAO: " + std::to_string(vao_ID), Logging::LOG_TYPE::INFO);
 }
 
@@ -143,14 +207,15 @@ void VAO::addVertexAttrribSpec(unsigned int attrib_ID, unsigned int count, GLenu
 
 void VAO::bind() const
 {
-    glBindVertexArray(vao_ID);
-    if (ebo.has_value())
-    {
-        ebo->bind();
-    }
+    GLStateCache::bindVertexArray(vao_ID);
 }
 
 void VAO::unbind() const
 {
-    glBindVertexArray(0);
-}
\ No newline at end of file
+    GLStateCache::bindVertexArray(0);
+}
+
+unsigned int VAO::getID() const
+{
+    return vao_ID;
+}
@@ -0,0 +1,11 @@
+#include "rendering/vertex/vertex.h"
+
+const VertexDescription &Vertex::describe()
+{
+    static const VertexDescription description = {
+        sizeof(Vertex),
+        {VERTEX_FLOAT_ATTRIBUTE(Vertex, position, "aPos", 0, 3),
+         VERTEX_FLOAT_ATTRIBUTE(Vertex, normal, "aNormal", 1, 3),
+         VERTEX_FLOAT_ATTRIBUTE(Vertex, texture_coords, "aTexCoord", 2, 2)}};
+    return description;
+}
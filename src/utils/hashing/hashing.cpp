@@ -0,0 +1,125 @@
+#include "utils/hashing/hashing.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+// the primes used by xxHash64
+static const uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+static const uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static uint64_t rotateLeft(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static uint64_t read64(const unsigned char *data)
+{
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static uint32_t read32(const unsigned char *data)
+{
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static uint64_t round64(uint64_t accumulator, uint64_t input)
+{
+    accumulator += input * PRIME64_2;
+    accumulator = rotateLeft(accumulator, 31);
+    return accumulator * PRIME64_1;
+}
+
+static uint64_t mergeRound64(uint64_t accumulator, uint64_t value)
+{
+    accumulator ^= round64(0, value);
+    return accumulator * PRIME64_1 + PRIME64_4;
+}
+
+uint64_t Hashing::hash64(const void *data, size_t size, uint64_t seed)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    const unsigned char *end = bytes + size;
+    uint64_t hash;
+
+    // consume the data in 32 byte stripes using 4 independent accumulators
+    if (size >= 32)
+    {
+        uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+        uint64_t v2 = seed + PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME64_1;
+        const unsigned char *limit = end - 32;
+        do
+        {
+            v1 = round64(v1, read64(bytes));
+            v2 = round64(v2, read64(bytes + 8));
+            v3 = round64(v3, read64(bytes + 16));
+            v4 = round64(v4, read64(bytes + 24));
+            bytes += 32;
+        } while (bytes <= limit);
+
+        hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+        hash = mergeRound64(hash, v1);
+        hash = mergeRound64(hash, v2);
+        hash = mergeRound64(hash, v3);
+        hash = mergeRound64(hash, v4);
+    }
+    else
+        hash = seed + PRIME64_5;
+
+    hash += (uint64_t)size;
+
+    // consume the remaining bytes
+    while (bytes + 8 <= end)
+    {
+        hash ^= round64(0, read64(bytes));
+        hash = rotateLeft(hash, 27) * PRIME64_1 + PRIME64_4;
+        bytes += 8;
+    }
+    if (bytes + 4 <= end)
+    {
+        hash ^= (uint64_t)read32(bytes) * PRIME64_1;
+        hash = rotateLeft(hash, 23) * PRIME64_2 + PRIME64_3;
+        bytes += 4;
+    }
+    while (bytes < end)
+    {
+        hash ^= (*bytes) * PRIME64_5;
+        hash = rotateLeft(hash, 11) * PRIME64_1;
+        bytes++;
+    }
+
+    // avalanche so every input bit affects every output bit
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64_t Hashing::hash64(const std::string &text, uint64_t seed)
+{
+    return hash64(text.data(), text.size(), seed);
+}
+
+std::optional<std::vector<unsigned char>> Hashing::readFile(const std::string &file_path)
+{
+    std::ifstream file(file_path, std::ios::binary);
+    if (!file)
+        return std::nullopt;
+    return std::vector<unsigned char>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+uint64_t Hashing::combine(uint64_t seed, uint64_t value)
+{
+    return seed ^ (value + 0x9E3779B97F4A7C15ULL + (seed << 6) + (seed >> 2));
+}
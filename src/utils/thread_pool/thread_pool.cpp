@@ -0,0 +1,97 @@
+#include "utils/thread_pool/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(unsigned int thread_count)
+    : workers(), tasks(), tasksMutex(), tasksAvailable(), stopping(false)
+{
+    // hardware_concurrency() may be 0 if it cannot be worked out
+    if (thread_count == 0)
+        thread_count = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1;
+    for (unsigned int i = 0; i < thread_count; i++)
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        stopping = true;
+    }
+    tasksAvailable.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::parallelFor(size_t count, size_t batch_size, const std::function<void(size_t, size_t)> &function)
+{
+    if (count == 0)
+        return;
+    batch_size = std::max<size_t>(batch_size, 1);
+    size_t batchCount = (count + batch_size - 1) / batch_size;
+
+    // batches are claimed from a shared counter, so a helper that starts late (or after we return) just finds nothing left to do
+    struct SharedState
+    {
+        std::atomic<size_t> nextBatch{0};
+        std::atomic<size_t> batchesDone{0};
+        std::mutex doneMutex;
+        std::condition_variable done;
+    };
+    auto state = std::make_shared<SharedState>();
+    auto runBatches = [state, count, batch_size, batchCount, &function]()
+    {
+        size_t batch;
+        while ((batch = state->nextBatch++) < batchCount)
+        {
+            function(batch * batch_size, std::min(count, (batch + 1) * batch_size));
+            if (++state->batchesDone == batchCount)
+            {
+                std::lock_guard<std::mutex> lock(state->doneMutex);
+                state->done.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min<size_t>(workers.size(), batchCount - 1);
+    for (size_t i = 0; i < helpers; i++)
+        enqueue(runBatches);
+    // the calling thread works too, so this never waits on workers that are busy with other tasks (or waiting on us)
+    runBatches();
+
+    std::unique_lock<std::mutex> lock(state->doneMutex);
+    state->done.wait(lock, [&state, batchCount]()
+                     { return state->batchesDone == batchCount; });
+}
+
+unsigned int ThreadPool::getThreadCount() const
+{
+    return (unsigned int)workers.size();
+}
+
+void ThreadPool::enqueue(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        tasks.push(std::move(task));
+    }
+    tasksAvailable.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(tasksMutex);
+            tasksAvailable.wait(lock, [this]()
+                                { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty())
+                return;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}